@@ -1797,6 +1797,8 @@ static int decode_video(InputStream *ist, AVPacket *pkt, int *got_output)
                        ist->resample_height  != decoded_frame->height ||
                        ist->resample_pix_fmt != decoded_frame->format;
     if (resample_changed) {
+        int format_changed = ist->resample_pix_fmt != decoded_frame->format;
+
         av_log(NULL, AV_LOG_INFO,
                "Input stream #%d:%d frame changed from size:%dx%d fmt:%s to size:%dx%d fmt:%s\n",
                ist->file_index, ist->st->index,
@@ -1808,8 +1810,11 @@ static int decode_video(InputStream *ist, AVPacket *pkt, int *got_output)
         ist->resample_pix_fmt = decoded_frame->format;
 
         for (i = 0; i < nb_filtergraphs; i++) {
+            /* a size change may only need the links downstream of the
+             * source to be reconfigured */
             if (ist_in_filtergraph(filtergraphs[i], ist) && ist->reinit_filters &&
-                configure_filtergraph(filtergraphs[i]) < 0) {
+                (format_changed ? configure_filtergraph(filtergraphs[i]) :
+                                  relink_filtergraph(filtergraphs[i], ist)) < 0) {
                 av_log(NULL, AV_LOG_FATAL, "Error reinitializing filters!\n");
                 exit_program(1);
             }
@@ -917,6 +917,39 @@ int configure_filtergraph(FilterGraph *fg)
     return 0;
 }
 
+/**
+ * Reconfigure fg for the new frame size of ist, in place if all filters
+ * downstream of its buffer source support it, from scratch otherwise.
+ */
+int relink_filtergraph(FilterGraph *fg, InputStream *ist)
+{
+    AVRational sar;
+    int i;
+
+    if (!fg->graph)
+        return configure_filtergraph(fg);
+
+    sar = ist->st->sample_aspect_ratio.num ?
+          ist->st->sample_aspect_ratio :
+          ist->st->codec->sample_aspect_ratio;
+    if(!sar.den)
+        sar = (AVRational){0,1};
+
+    for (i = 0; i < fg->nb_inputs; i++) {
+        AVFilterContext *buffer = fg->inputs[i]->filter;
+
+        if (fg->inputs[i]->ist != ist)
+            continue;
+        if (!buffer ||
+            av_opt_set_int(buffer, "width",  ist->resample_width,  AV_OPT_SEARCH_CHILDREN) < 0 ||
+            av_opt_set_int(buffer, "height", ist->resample_height, AV_OPT_SEARCH_CHILDREN) < 0 ||
+            av_opt_set_q  (buffer, "pixel_aspect", sar,            AV_OPT_SEARCH_CHILDREN) < 0 ||
+            avfilter_graph_relink(fg->graph, buffer) < 0)
+            return configure_filtergraph(fg);
+    }
+    return 0;
+}
+
 int ist_in_filtergraph(FilterGraph *fg, InputStream *ist)
 {
     int i;
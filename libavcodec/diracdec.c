@@ -1556,6 +1556,31 @@ static void interpolate_refplane(DiracContext *s, DiracFrame *ref, int plane, in
     ref->interpolated[plane] = 1;
 }
 
+/**
+ * IDWT of one plane of an intra picture. The planes only share read-only
+ * state, so this is run on all three planes in parallel.
+ */
+static int idwt_intra_plane(AVCodecContext *avctx, void *arg)
+{
+    DiracContext *s = avctx->priv_data;
+    int comp        = *(int *)arg;
+    Plane *p        = &s->plane[comp];
+    uint8_t *frame  = s->current_picture->avframe->data[comp];
+    DWTContext d;
+    int y;
+
+    if (ff_spatial_idwt_init2(&d, p->idwt_buf, p->idwt_width, p->idwt_height, p->idwt_stride,
+                              s->wavelet_idx+2, s->wavelet_depth, p->idwt_tmp))
+        return -1;
+
+    for (y = 0; y < p->height; y += 16) {
+        ff_spatial_idwt_slice2(&d, y+16); /* decode */
+        s->diracdsp.put_signed_rect_clamped(frame + y*p->stride, p->stride,
+                                            p->idwt_buf + y*p->idwt_stride, p->idwt_stride, p->width, 16);
+    }
+    return 0;
+}
+
 /**
  * Dirac Specification ->
  * 13.0 Transform data syntax. transform_data()
@@ -1575,9 +1600,30 @@ static int dirac_decode_frame_internal(DiracContext *s)
             decode_lowdelay(s);
     }
 
+    if (!s->num_refs) { /* intra */
+        static const int comps[3] = { 0, 1, 2 };
+        int ret[3];
+
+        /* coefficient unpacking reads s->gb in plane order, so it stays serial */
+        if (!s->zero_res && !s->low_delay) {
+            for (comp = 0; comp < 3; comp++) {
+                Plane *p = &s->plane[comp];
+                memset(p->idwt_buf, 0, p->idwt_stride * p->idwt_height * sizeof(IDWTELEM));
+                decode_component(s, comp); /* [DIRAC_STD] 13.4.1 core_transform_data() */
+            }
+        }
+
+        s->avctx->execute(s->avctx, idwt_intra_plane, (void *)comps, ret, 3, sizeof(int));
+        for (comp = 0; comp < 3; comp++)
+            if (ret[comp] < 0)
+                return ret[comp];
+        return 0;
+    }
+
     for (comp = 0; comp < 3; comp++) {
         Plane *p       = &s->plane[comp];
         uint8_t *frame = s->current_picture->avframe->data[comp];
+        int rowheight  = p->ybsep*p->stride;
 
         /* FIXME: small resolutions */
         for (i = 0; i < 4; i++)
@@ -1592,52 +1638,41 @@ static int dirac_decode_frame_internal(DiracContext *s)
                                   s->wavelet_idx+2, s->wavelet_depth, p->idwt_tmp))
             return -1;
 
-        if (!s->num_refs) { /* intra */
-            for (y = 0; y < p->height; y += 16) {
-                ff_spatial_idwt_slice2(&d, y+16); /* decode */
-                s->diracdsp.put_signed_rect_clamped(frame + y*p->stride, p->stride,
-                                                    p->idwt_buf + y*p->idwt_stride, p->idwt_stride, p->width, 16);
-            }
-        } else { /* inter */
-            int rowheight = p->ybsep*p->stride;
+        select_dsp_funcs(s, p->width, p->height, p->xblen, p->yblen);
 
-            select_dsp_funcs(s, p->width, p->height, p->xblen, p->yblen);
+        for (i = 0; i < s->num_refs; i++)
+            interpolate_refplane(s, s->ref_pics[i], comp, p->width, p->height);
 
-            for (i = 0; i < s->num_refs; i++)
-                interpolate_refplane(s, s->ref_pics[i], comp, p->width, p->height);
+        memset(s->mctmp, 0, 4*p->yoffset*p->stride);
 
-            memset(s->mctmp, 0, 4*p->yoffset*p->stride);
+        dsty = -p->yoffset;
+        for (y = 0; y < s->blheight; y++) {
+            int h     = 0,
+                start = FFMAX(dsty, 0);
+            uint16_t *mctmp    = s->mctmp + y*rowheight;
+            DiracBlock *blocks = s->blmotion + y*s->blwidth;
 
-            dsty = -p->yoffset;
-            for (y = 0; y < s->blheight; y++) {
-                int h     = 0,
-                    start = FFMAX(dsty, 0);
-                uint16_t *mctmp    = s->mctmp + y*rowheight;
-                DiracBlock *blocks = s->blmotion + y*s->blwidth;
+            init_obmc_weights(s, p, y);
 
-                init_obmc_weights(s, p, y);
-
-                if (y == s->blheight-1 || start+p->ybsep > p->height)
-                    h = p->height - start;
-                else
-                    h = p->ybsep - (start - dsty);
-                if (h < 0)
-                    break;
+            if (y == s->blheight-1 || start+p->ybsep > p->height)
+                h = p->height - start;
+            else
+                h = p->ybsep - (start - dsty);
+            if (h < 0)
+                break;
 
-                memset(mctmp+2*p->yoffset*p->stride, 0, 2*rowheight);
-                mc_row(s, blocks, mctmp, comp, dsty);
+            memset(mctmp+2*p->yoffset*p->stride, 0, 2*rowheight);
+            mc_row(s, blocks, mctmp, comp, dsty);
 
-                mctmp += (start - dsty)*p->stride + p->xoffset;
-                ff_spatial_idwt_slice2(&d, start + h); /* decode */
-                s->diracdsp.add_rect_clamped(frame + start*p->stride, mctmp, p->stride,
-                                             p->idwt_buf + start*p->idwt_stride, p->idwt_stride, p->width, h);
+            mctmp += (start - dsty)*p->stride + p->xoffset;
+            ff_spatial_idwt_slice2(&d, start + h); /* decode */
+            s->diracdsp.add_rect_clamped(frame + start*p->stride, mctmp, p->stride,
+                                         p->idwt_buf + start*p->idwt_stride, p->idwt_stride, p->width, h);
 
-                dsty += p->ybsep;
-            }
+            dsty += p->ybsep;
         }
     }
 
-
     return 0;
 }
 
@@ -1969,6 +2004,6 @@ AVCodec ff_dirac_decoder = {
     .init           = dirac_decode_init,
     .close          = dirac_decode_end,
     .decode         = dirac_decode_frame,
-    .capabilities   = CODEC_CAP_DELAY,
+    .capabilities   = CODEC_CAP_DELAY | CODEC_CAP_SLICE_THREADS,
     .flush          = dirac_decode_flush,
 };
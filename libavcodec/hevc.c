@@ -349,6 +349,26 @@ fail:
     return ret;
 }
 
+/**
+ * Check whether the current picture is discarded at the given AVDiscard
+ * level, following the documented meaning of the levels: AVDISCARD_BIDIR
+ * discards B pictures even when they are references, so the pictures
+ * predicted from them are decoded from generated missing references, as
+ * H.264 does. Must be called after the slice type has been parsed.
+ */
+static int discard_slice(HEVCContext *s, enum AVDiscard skip)
+{
+    /* sub-layer non-reference pictures can still be referenced from
+     * higher sub-layers, so only the highest one is really non-reference */
+    int nonref = s->nal_unit_type <= NAL_RASL_R && !(s->nal_unit_type & 1) &&
+                 s->temporal_id == s->sps->max_sub_layers - 1;
+
+    return skip >= AVDISCARD_ALL                                     ||
+           (skip >= AVDISCARD_NONKEY && !IS_IRAP(s))                 ||
+           (skip >= AVDISCARD_BIDIR  && s->sh.slice_type == B_SLICE) ||
+           (skip >= AVDISCARD_NONREF && nonref);
+}
+
 static int hls_slice_header(HEVCContext *s)
 {
     GetBitContext *gb = &s->HEVClc->gb;
@@ -637,6 +657,14 @@ static int hls_slice_header(HEVCContext *s)
         } else {
             sh->slice_loop_filter_across_slices_enabled_flag = s->pps->seq_loop_filter_across_slices_enabled_flag;
         }
+
+        /* The in-loop filter syntax has been parsed at this point, so it is
+         * safe to override its effect for the reconstruction. */
+        sh->disable_sao = 0;
+        if (discard_slice(s, s->avctx->skip_loop_filter)) {
+            sh->disable_deblocking_filter_flag = 1;
+            sh->disable_sao                    = 1;
+        }
     } else if (!s->slice_initialized) {
         av_log(s->avctx, AV_LOG_ERROR, "Independent slice segment missing.\n");
         return AVERROR_INVALIDDATA;
@@ -796,6 +824,11 @@ static void hls_sao_param(HEVCContext *s, int rx, int ry)
             }
         }
     }
+
+    /* the syntax elements have been consumed, only drop their effect */
+    if (s->sh.disable_sao)
+        for (c_idx = 0; c_idx < 3; c_idx++)
+            sao->type_idx[c_idx] = SAO_NOT_APPLIED;
 }
 
 #undef SET_SAO
@@ -2351,6 +2384,14 @@ static int decode_nal_unit(HEVCContext *s, const uint8_t *nal, int length)
                 s->max_ra = INT_MIN;
         }
 
+        /* decided once per picture, slice types may differ between slices */
+        if (s->sh.first_slice_in_pic_flag)
+            s->skip_pic = discard_slice(s, s->avctx->skip_frame);
+        if (s->skip_pic) {
+            s->is_decoded = 0;
+            break;
+        }
+
         if (s->sh.first_slice_in_pic_flag) {
             ret = hevc_frame_start(s);
             if (ret < 0)
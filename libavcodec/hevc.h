@@ -559,6 +559,7 @@ typedef struct SliceHeader {
 
     uint8_t cabac_init_flag;
     uint8_t disable_deblocking_filter_flag; ///< slice_header_disable_deblocking_filter_flag
+    uint8_t disable_sao;                    ///< SAO skipped because of AVCodecContext.skip_loop_filter
     uint8_t slice_loop_filter_across_slices_enabled_flag;
     uint8_t collocated_list;
 
@@ -798,6 +799,7 @@ typedef struct HEVCContext {
     int bs_height;
 
     int is_decoded;
+    int skip_pic;  ///< current picture is discarded because of AVCodecContext.skip_frame
 
     HEVCPredContext hpc;
     HEVCDSPContext hevcdsp;
@@ -32,7 +32,7 @@ extern const xmm_reg  ff_pw_4;
 extern const xmm_reg  ff_pw_5;
 extern const xmm_reg  ff_pw_8;
 extern const uint64_t ff_pw_15;
-extern const xmm_reg  ff_pw_16;
+extern const ymm_reg  ff_pw_16;
 extern const xmm_reg  ff_pw_18;
 extern const uint64_t ff_pw_20;
 extern const xmm_reg  ff_pw_32;
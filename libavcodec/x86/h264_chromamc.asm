@@ -61,6 +61,7 @@ cextern pw_3
 cextern pw_4
 cextern pw_8
 pw_28: times 8 dw 28
+pb_unpack_01: db 0, 8, 1, 9, 2, 10, 3, 11, 4, 12, 5, 13, 6, 14, 7, 15
 cextern pw_32
 cextern pw_64
 
@@ -676,3 +677,144 @@ chroma_mc8_ssse3_func avg, h264, _rnd
 chroma_mc8_ssse3_func avg, vc1,  _nornd
 INIT_MMX ssse3
 chroma_mc4_ssse3_func avg, h264
+
+%if HAVE_AVX2_EXTERNAL && ARCH_X86_64
+; two rows per ymm register, one per 128-bit lane; each row is built from two
+; 8-byte loads so that no more source pixels are read than by the C version
+%macro LOAD_PAIRS_AVX2 3 ; dst, first row address, second row address
+    movq         x%1, [%2]
+    movhps       x%1, [%2+1]
+    movq         xm3, [%3]
+    movhps       xm3, [%3+1]
+    vinserti128   %1, %1, xm3, 1
+    pshufb        %1, m6
+%endmacro
+
+; %1=put/avg, %2=ymm holding two rows of words; clobbers m3
+%macro STORE2_AVX2 2
+    vextracti128 xm3, %2, 1
+    packuswb     x%2, xm3
+%ifidn %1, avg
+    movq         xm3, [r0   ]
+    movhps       xm3, [r0+r2]
+    pavgb        x%2, xm3
+%endif
+    movq     [r0   ], x%2
+    movhps   [r0+r2], x%2
+%endmacro
+
+%macro chroma_mc8_avx2_func 1
+cglobal %1_h264_chroma_mc8_rnd, 6, 7, 8
+    movsxd        r2, r2d
+    mov          r6d, r5d
+    or           r6d, r4d
+    jne .at_least_one_non_zero
+    ; mx == 0 AND my == 0 - no filter needed
+    lea           r4, [r2*2]
+.next2rows_mv0:
+    movq         xm0, [r1   ]
+    movhps       xm0, [r1+r2]
+%ifidn %1, avg
+    movq         xm1, [r0   ]
+    movhps       xm1, [r0+r2]
+    pavgb        xm0, xm1
+%endif
+    movq     [r0   ], xm0
+    movhps   [r0+r2], xm0
+    add           r1, r4
+    add           r0, r4
+    sub          r3d, 2
+    jg .next2rows_mv0
+    RET
+
+.at_least_one_non_zero:
+    vbroadcasti128 m6, [pb_unpack_01]
+    test         r5d, r5d
+    je .my_is_zero
+    test         r4d, r4d
+    je .mx_is_zero
+
+    ; general case, bilinear
+    mov          r6d, r4d
+    shl          r4d, 8
+    sub           r4, r6
+    mov           r6, 8
+    add           r4, 8           ; x*255+8 = x<<8 | (8-x)
+    sub          r6d, r5d
+    imul          r6, r4          ; (8-y)*(x*255+8) = (8-y)*x<<8 | (8-y)*(8-x)
+    imul         r4d, r5d         ;    y *(x*255+8) =    y *x<<8 |    y *(8-x)
+    movd         xm7, r6d
+    movd         xm5, r4d
+    vpbroadcastw  m7, xm7
+    vpbroadcastw  m5, xm5
+    vpbroadcastw  m4, [pw_32]
+    LOAD_PAIRS_AVX2 m0, r1, r1    ; row 0 in both lanes
+
+.next2rows:
+    LOAD_PAIRS_AVX2 m1, r1+r2, r1+r2*2
+    lea           r1, [r1+r2*2]
+    vperm2i128    m2, m0, m1, 0x21
+    pmaddubsw     m0, m1, m5
+    pmaddubsw     m2, m7
+    paddw         m2, m4
+    paddw         m2, m0
+    psrlw         m2, 6
+    mova          m0, m1
+    STORE2_AVX2   %1, m2
+    sub          r3d, 2
+    lea           r0, [r0+r2*2]
+    jg .next2rows
+    RET
+
+.my_is_zero:
+    mov          r5d, r4d
+    shl          r4d, 8
+    add           r4, 8
+    sub           r4, r5          ; 255*x+8 = x<<8 | (8-x)
+    movd         xm7, r4d
+    vpbroadcastw  m7, xm7
+    vpbroadcastw  m4, [pw_4]
+
+.next2xrows:
+    LOAD_PAIRS_AVX2 m0, r1, r1+r2
+    pmaddubsw     m0, m7
+    paddw         m0, m4
+    psrlw         m0, 3
+    STORE2_AVX2   %1, m0
+    sub          r3d, 2
+    lea           r0, [r0+r2*2]
+    lea           r1, [r1+r2*2]
+    jg .next2xrows
+    RET
+
+.mx_is_zero:
+    mov          r4d, r5d
+    shl          r5d, 8
+    add           r5, 8
+    sub           r5, r4          ; 255*y+8 = y<<8 | (8-y)
+    movd         xm7, r5d
+    vpbroadcastw  m7, xm7
+    vpbroadcastw  m4, [pw_4]
+
+.next2yrows:
+    movq         xm0, [r1     ]
+    movhps       xm0, [r1+r2  ]
+    movq         xm3, [r1+r2  ]
+    movhps       xm3, [r1+r2*2]
+    vinserti128   m0, m0, xm3, 1
+    pshufb        m0, m6
+    pmaddubsw     m0, m7
+    paddw         m0, m4
+    psrlw         m0, 3
+    STORE2_AVX2   %1, m0
+    sub          r3d, 2
+    lea           r0, [r0+r2*2]
+    lea           r1, [r1+r2*2]
+    jg .next2yrows
+    RET
+%endmacro
+
+INIT_YMM avx2
+chroma_mc8_avx2_func put
+chroma_mc8_avx2_func avg
+%endif
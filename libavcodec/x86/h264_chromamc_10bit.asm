@@ -239,6 +239,131 @@ cglobal %1_h264_chroma_mc2_10, 6,7
     REP_RET
 %endmacro
 
+%if HAVE_AVX2_EXTERNAL && ARCH_X86_64
+; two rows per ymm register, one per 128-bit lane
+%macro CHROMA_MC8_AVX2 1
+cglobal %1_h264_chroma_mc8_10, 6,7,11
+    movsxd        r2, r2d
+    mov          r6d, r5d
+    or           r6d, r4d
+    jne .at_least_one_non_zero
+    ; mx == 0 AND my == 0 - no filter needed
+    lea           r4, [r2*2]
+.next2rows_mv0:
+    movu         xm0, [r1   ]
+    vinserti128   m0, m0, [r1+r2], 1
+%ifidn %1, avg
+    movu         xm1, [r0   ]
+    vinserti128   m1, m1, [r0+r2], 1
+    pavgw         m0, m1
+%endif
+    movu     [r0   ], xm0
+    vextracti128 [r0+r2], m0, 1
+    add           r1, r4
+    add           r0, r4
+    sub          r3d, 2
+    jg .next2rows_mv0
+    RET
+
+.at_least_one_non_zero:
+    mov          r6d, 2
+    test         r5d, r5d
+    je .x_interpolation
+    mov           r6, r2        ; dxy = x ? 1 : stride
+    test         r4d, r4d
+    jne .xy_interpolation
+.x_interpolation:
+    ; mx == 0 XOR my == 0 - 1 dimensional filter only
+    or           r4d, r5d       ; x + y
+    movd         xm5, r4d
+    vpbroadcastw  m5, xm5       ; B = x
+    vpbroadcastw  m4, [pw_8]
+    vpbroadcastw  m6, [pw_4]    ; rnd >> 3
+    psubw         m4, m5        ; A = 8-x
+    lea           r4, [r1+r6]
+
+.next1drow:
+    movu         xm0, [r1   ]
+    vinserti128   m0, m0, [r1+r2], 1
+    movu         xm2, [r4   ]
+    vinserti128   m2, m2, [r4+r2], 1
+    pmullw        m0, m4
+    pmullw        m2, m5
+    paddw         m0, m6
+    paddw         m0, m2
+    psrlw         m0, 3
+%ifidn %1, avg
+    movu         xm1, [r0   ]
+    vinserti128   m1, m1, [r0+r2], 1
+    pavgw         m0, m1
+%endif
+    movu     [r0   ], xm0
+    vextracti128 [r0+r2], m0, 1
+    lea           r0, [r0+r2*2]
+    lea           r1, [r1+r2*2]
+    lea           r4, [r4+r2*2]
+    sub          r3d, 2
+    jg .next1drow
+    RET
+
+.xy_interpolation: ; general case, bilinear
+    mov          r6d, r4d
+    imul         r6d, r5d         ; D = x * y
+    shl          r4d, 3
+    shl          r5d, 3
+    movd         xm7, r6d
+    vpbroadcastw  m7, xm7
+    sub          r4d, r6d         ; B = 8x - xy
+    sub          r5d, r6d         ; C = 8y - xy
+    movd         xm5, r4d
+    movd         xm6, r5d
+    vpbroadcastw  m5, xm5
+    vpbroadcastw  m6, xm6
+    add          r4d, r5d
+    add          r4d, r6d
+    neg          r4d
+    add          r4d, 64          ; A = 64 - B - C - D
+    movd         xm4, r4d
+    vpbroadcastw  m4, xm4
+    vpbroadcastw  m8, [pw_32]
+
+    movu         xm0, [r1  ]
+    vinserti128   m0, m0, xm0, 1  ; src[0..7] in the upper lane
+    movu         xm1, [r1+2]
+    vinserti128   m1, m1, xm1, 1  ; src[1..8] in the upper lane
+.next2drows:
+    movu         xm2, [r1+r2    ]
+    vinserti128   m2, m2, [r1+r2*2  ], 1
+    movu         xm3, [r1+r2  +2]
+    vinserti128   m3, m3, [r1+r2*2+2], 1
+    lea           r1, [r1+r2*2]
+    vperm2i128    m9, m0, m2, 0x21
+    vperm2i128   m10, m1, m3, 0x21
+    pmullw        m9, m4
+    pmullw       m10, m5
+    paddw         m9, m10         ; A * src[0..7] + B * src[1..8]
+    pmullw       m10, m2, m6
+    paddw         m9, m10         ; += C * src[0..7+stride]
+    pmullw       m10, m3, m7
+    paddw         m9, m10         ; += D * src[1..8+stride]
+    paddw         m9, m8
+    psrlw         m9, 6
+%ifidn %1, avg
+    movu        xm10, [r0   ]
+    vinserti128  m10, m10, [r0+r2], 1
+    pavgw         m9, m10
+%endif
+    movu     [r0   ], xm9
+    vextracti128 [r0+r2], m9, 1
+    mova          m0, m2
+    mova          m1, m3
+    lea           r0, [r0+r2*2]
+    sub          r3d, 2
+    jg .next2drows
+    RET
+%endmacro
+%endif
+
 %macro NOTHING 2-3
 %endmacro
 %macro AVG 2-3
@@ -269,3 +394,9 @@ CHROMA_MC8 avg
 INIT_MMX mmxext
 CHROMA_MC4 avg
 CHROMA_MC2 avg
+
+%if HAVE_AVX2_EXTERNAL && ARCH_X86_64
+INIT_YMM avx2
+CHROMA_MC8_AVX2 put
+CHROMA_MC8_AVX2 avg
+%endif
@@ -56,20 +56,35 @@ cextern pw_4
 %endmacro
 
 %macro LOAD_AB 4
+%if mmsize == 32
+    movd      x%1, %3
+    movd      x%2, %4
+    vpbroadcastw %1, x%1
+    vpbroadcastw %2, x%2
+%else
     movd       %1, %3
     movd       %2, %4
     SPLATW     %1, %1
     SPLATW     %2, %2
+%endif
 %endmacro
 
 ; in:  %2=tc reg
 ; out: %1=splatted tc
 %macro LOAD_TC 2
+%if mmsize == 32
+    movd       x%1, [%2]
+    punpcklbw  x%1, x%1
+    punpcklwd  x%1, x%1
+    vpermq      %1, %1, q1100
+    punpckldq   %1, %1
+%else
     movd        %1, [%2]
     punpcklbw   %1, %1
+%endif
 %if mmsize == 8
     pshufw      %1, %1, 0
-%else
+%elif mmsize == 16
     pshuflw     %1, %1, 01010000b
     pshufd      %1, %1, 01010000b
 %endif
@@ -93,14 +108,24 @@ cextern pw_4
 ; out: %1=p0', m2=q0'
 %macro DEBLOCK_P0_Q0 7
     psubw   %3, %4
+%if mmsize == 32
+    vpbroadcastw %7, [pw_4]
+    paddw   %3, %7
+    pxor    %7, %7
+%else
     pxor    %7, %7
     paddw   %3, [pw_4]
+%endif
     psubw   %7, %5
     psubw   %6, %2, %1
     psllw   %6, 2
     paddw   %3, %6
     psraw   %3, 3
+%if mmsize == 32
+    vpbroadcastw %6, [pw_pixel_max]
+%else
     mova    %6, [pw_pixel_max]
+%endif
     CLIPW   %3, %7, %5
     pxor    %7, %7
     paddw   %1, %3
@@ -139,14 +164,14 @@ cextern pw_4
     movq        [r0+r1*2-4], m2
     movq        [r0+%2-4], m3
 %else
-    movq        [r0-4], m0
-    movhps      [r0+r1-4], m0
-    movq        [r0+r1*2-4], m1
-    movhps      [%1-4], m1
-    movq        [%1+r1-4], m2
-    movhps      [%1+r1*2-4], m2
-    movq        [%1+%2-4], m3
-    movhps      [%1+r1*4-4], m3
+    movq        [r0-4], xm0
+    movhps      [r0+r1-4], xm0
+    movq        [r0+r1*2-4], xm1
+    movhps      [%1-4], xm1
+    movq        [%1+r1-4], xm2
+    movhps      [%1+r1*2-4], xm2
+    movq        [%1+%2-4], xm3
+    movhps      [%1+r1*4-4], xm3
 %endif
 %endmacro
 
@@ -421,11 +446,80 @@ DEBLOCK_LUMA_64
 INIT_XMM avx
 DEBLOCK_LUMA_64
 %endif
+
+%if HAVE_AVX2_EXTERNAL
+; all 16 pixels of the edge fit in one register, so there is no loop
+INIT_YMM avx2
+cglobal deblock_v_luma_10, 5,5,15
+    shl        r2d, 2
+    shl        r3d, 2
+    LOAD_AB    m12, m13, r2d, r3d
+    mov         r2, r0
+    sub         r0, r1
+    sub         r0, r1
+    sub         r0, r1
+    movu        m8, [r0]
+    movu        m0, [r0+r1]
+    movu        m1, [r0+r1*2]
+    movu        m2, [r2]
+    movu        m3, [r2+r1]
+    movu        m9, [r2+r1*2]
+    DEBLOCK_LUMA_INTER_SSE2
+    movu   [r0+r1], m0
+    movu [r0+r1*2], m1
+    movu      [r2], m2
+    movu   [r2+r1], m3
+    RET
+
+; rows 0-7 go in the low lanes and rows 8-15 in the high lanes, the
+; in-lane transposes then give one 16-pixel column per register
+cglobal deblock_h_luma_10, 5,7,15
+    shl        r2d, 2
+    shl        r3d, 2
+    LOAD_AB    m12, m13, r2d, r3d
+    lea         r5, [r1*3]
+    lea         r6, [r0+r1*4]
+    lea         r2, [r0+r1*8]
+    lea         r3, [r6+r1*8]
+    movu       xm4, [r0-8]      ; p3 p2 p1 p0 q0 q1 q2 q3
+    movu       xm8, [r0+r1-8]
+    movu       xm0, [r0+r1*2-8]
+    movu       xm1, [r0+r5-8]
+    movu       xm2, [r6-8]
+    movu       xm3, [r6+r1-8]
+    movu       xm9, [r6+r1*2-8]
+    movu       xm5, [r6+r5-8]
+    vinserti128 m4, m4, [r2-8], 1
+    vinserti128 m8, m8, [r2+r1-8], 1
+    vinserti128 m0, m0, [r2+r1*2-8], 1
+    vinserti128 m1, m1, [r2+r5-8], 1
+    vinserti128 m2, m2, [r3-8], 1
+    vinserti128 m3, m3, [r3+r1-8], 1
+    vinserti128 m9, m9, [r3+r1*2-8], 1
+    vinserti128 m5, m5, [r3+r5-8], 1
+    TRANSPOSE8x8W 4, 8, 0, 1, 2, 3, 9, 5, 10
+
+    DEBLOCK_LUMA_INTER_SSE2
+
+    TRANSPOSE4x4W 0, 1, 2, 3, 4
+    lea         r6, [r0+r5]
+    LUMA_H_STORE r6, r5
+    vextracti128 xm0, m0, 1
+    vextracti128 xm1, m1, 1
+    vextracti128 xm2, m2, 1
+    vextracti128 xm3, m3, 1
+    lea         r0, [r0+r1*8]
+    lea         r6, [r6+r1*8]
+    LUMA_H_STORE r6, r5
+    RET
+%endif
 %endif
 
 %macro SWAPMOVA 2
 %ifid %1
     SWAP %1, %2
+%elif mmsize == 32
+    movu %1, %2
 %else
     mova %1, %2
 %endif
@@ -557,6 +651,33 @@ DEBLOCK_LUMA_64
 %endif
 %endmacro
 
+; in: %1=offset left of pix, %2-%5=rows 0/4 .. 3/7 as left by TRANSPOSE2x4x4W
+;     r0=pix, r4=pix+4*stride, r2/r3 the same 8 rows further down for ymm
+%macro LUMA_H_INTRA_STORE_8x4W 5
+    movq       [r0-%1], xm%2
+    movq       [r0+r1-%1], xm%3
+    movq       [r0+r1*2-%1], xm%4
+    movq       [r0+r5-%1], xm%5
+    movhps     [r4-%1], xm%2
+    movhps     [r4+r1-%1], xm%3
+    movhps     [r4+r1*2-%1], xm%4
+    movhps     [r4+r5-%1], xm%5
+%if mmsize == 32
+    vextracti128 xm%2, m%2, 1
+    vextracti128 xm%3, m%3, 1
+    vextracti128 xm%4, m%4, 1
+    vextracti128 xm%5, m%5, 1
+    movq       [r2-%1], xm%2     ; rows 8-15 from the high lanes
+    movq       [r2+r1-%1], xm%3
+    movq       [r2+r1*2-%1], xm%4
+    movq       [r2+r5-%1], xm%5
+    movhps     [r3-%1], xm%2
+    movhps     [r3+r1-%1], xm%3
+    movhps     [r3+r1*2-%1], xm%4
+    movhps     [r3+r5-%1], xm%5
+%endif
+%endmacro
+
 ; in: %1=q3 %2=q2' %3=q1' %4=q0' %5=p0' %6=p1' %7=p2' %8=p3 %9=tmp
 %macro LUMA_H_INTRA_STORE 9
 %if mmsize == 8
@@ -573,28 +694,14 @@ DEBLOCK_LUMA_64
     movq       [r0+r4], m%1
 %else
     TRANSPOSE2x4x4W %1, %2, %3, %4, %9
-    movq       [r0-8], m%1
-    movq       [r0+r1-8], m%2
-    movq       [r0+r1*2-8], m%3
-    movq       [r0+r5-8], m%4
-    movhps     [r4-8], m%1
-    movhps     [r4+r1-8], m%2
-    movhps     [r4+r1*2-8], m%3
-    movhps     [r4+r5-8], m%4
+    LUMA_H_INTRA_STORE_8x4W 8, %1, %2, %3, %4
 %ifnum %8
     SWAP       %1, %8
 %else
     mova       m%1, %8
 %endif
     TRANSPOSE2x4x4W %5, %6, %7, %1, %9
-    movq       [r0], m%5
-    movq       [r0+r1], m%6
-    movq       [r0+r1*2], m%7
-    movq       [r0+r5], m%1
-    movhps     [r4], m%5
-    movhps     [r4+r1], m%6
-    movhps     [r4+r1*2], m%7
-    movhps     [r4+r5], m%1
+    LUMA_H_INTRA_STORE_8x4W 0, %5, %6, %7, %1
 %endif
 %endmacro
 
@@ -719,6 +826,112 @@ INIT_XMM avx
 DEBLOCK_LUMA_INTRA_64
 %endif
 
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+cglobal deblock_v_luma_intra_10, 4,6,16
+    %define t0 m1
+    %define t1 m2
+    %define t2 m4
+    %define p2 m8
+    %define p1 m9
+    %define p0 m10
+    %define q0 m11
+    %define q1 m12
+    %define q2 m13
+    %define aa m5
+    %define bb m14
+    lea     r4, [r1*4]
+    lea     r5, [r1*3] ; 3*stride
+    neg     r4
+    add     r4, r0     ; pix-4*stride
+    vpbroadcastw m0, [pw_2]
+    shl    r2d, 2
+    shl    r3d, 2
+    LOAD_AB aa, bb, r2d, r3d
+    movu    p2, [r4+r1]
+    movu    p1, [r4+2*r1]
+    movu    p0, [r4+r5]
+    movu    q0, [r0]
+    movu    q1, [r0+r1]
+    movu    q2, [r0+2*r1]
+
+    LOAD_MASK p1, p0, q0, q1, aa, bb, m3, t0, t1
+    psrlw   t2, aa, 2
+    paddw   t2, m0 ; alpha/4+2
+    DIFF_LT p0, q0, t2, m6, t0 ; m6 = |p0-q0| < alpha/4+2
+    DIFF_LT p2, p0, bb, t1, t0 ; m7 = |p2-p0| < beta
+    DIFF_LT q2, q0, bb, m7, t0 ; t1 = |q2-q0| < beta
+    pand    m6, m3
+    pand    m7, m6
+    pand    m6, t1
+    movu   m15, [r4]    ; p3
+    LUMA_INTRA_P012 p0, p1, p2, m15, q0, q1, m3, m6, m0, [r4+r5], [r4+2*r1], [r4+r1]
+    movu   m15, [r0+r5] ; q3
+    LUMA_INTRA_P012 q0, q1, q2, m15, p0, p1, m3, m7, m0, [r0], [r0+r1], [r0+2*r1]
+    RET
+
+cglobal deblock_h_luma_intra_10, 4,6,16
+    %define t0 m15
+    %define t1 m14
+    %define t2 m2
+    %define q3 m5
+    %define q2 m8
+    %define q1 m9
+    %define q0 m10
+    %define p0 m11
+    %define p1 m12
+    %define p2 m13
+    %define p3 m4
+    %define spill [rsp]
+    %assign pad 40-(stack_offset&15)
+    SUB     rsp, pad
+    lea     r4, [r1*4]
+    lea     r5, [r1*3] ; 3*stride
+    add     r4, r0     ; pix+4*stride
+    vpbroadcastw m0, [pw_2]
+    shl    r2d, 2
+    shl    r3d, 2
+    LOAD_AB m1, m2, r2d, r3d
+    lea     r2, [r0+r1*8]
+    lea     r3, [r4+r1*8]
+    movu   xm5, [r0-8]
+    movu   xm8, [r0+r1-8]
+    movu   xm9, [r0+r1*2-8]
+    movu   xm10, [r0+r5-8]
+    movu   xm11, [r4-8]
+    movu   xm12, [r4+r1-8]
+    movu   xm13, [r4+r1*2-8]
+    movu   xm4, [r4+r5-8]
+    vinserti128 q3, q3, [r2-8], 1
+    vinserti128 q2, q2, [r2+r1-8], 1
+    vinserti128 q1, q1, [r2+r1*2-8], 1
+    vinserti128 q0, q0, [r2+r5-8], 1
+    vinserti128 p0, p0, [r3-8], 1
+    vinserti128 p1, p1, [r3+r1-8], 1
+    vinserti128 p2, p2, [r3+r1*2-8], 1
+    vinserti128 p3, p3, [r3+r5-8], 1
+    TRANSPOSE8x8W 5, 8, 9, 10, 11, 12, 13, 4, 3
+
+    LOAD_MASK q1, q0, p0, p1, m1, m2, m3, t0, t1
+    psrlw   m1, 2
+    paddw   m1, m0 ; alpha/4+2
+    DIFF_LT p0, q0, m1, m6, t0 ; m6 = |p0-q0| < alpha/4+2
+    DIFF_LT q2, q0, m2, t1, t0 ; t1 = |q2-q0| < beta
+    DIFF_LT p0, p2, m2, m7, t0 ; m7 = |p2-p0| < beta
+    pand    m6, m3
+    pand    m7, m6
+    pand    m6, t1
+
+    movu spill, q3
+    LUMA_INTRA_P012 q0, q1, q2, q3, p0, p1, m3, m6, m0, m5, m1, q2
+    LUMA_INTRA_P012 p0, p1, p2, p3, q0, q1, m3, m7, m0, p0, m6, p2
+    movu    m7, spill
+
+    LUMA_H_INTRA_STORE 7, 8, 1, 5, 11, 6, 13, 4, 14
+    ADD    rsp, pad
+    RET
+%endif
+
 %endif
 
 %macro DEBLOCK_LUMA_INTRA 0
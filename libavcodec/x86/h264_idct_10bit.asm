@@ -548,6 +548,74 @@ INIT_XMM avx
 IDCT8_ADD
 %endif
 
+%if HAVE_AVX2_EXTERNAL && ARCH_X86_64
+; one row of eight coefficients per ymm register, so the whole block stays in
+; registers and neither pass goes through the stack
+%macro TRANSPOSE8x8D_AVX2 0 ; m0-7, clobbers m8
+    TRANSPOSE4x4D 0, 1, 2, 3, 8
+    TRANSPOSE4x4D 4, 5, 6, 7, 8
+%assign %%i 0
+%rep 4
+%assign %%j %%i+4
+    vperm2i128    m8, m %+ %%i, m %+ %%j, 0x20
+    vperm2i128    m %+ %%j, m %+ %%i, m %+ %%j, 0x31
+    SWAP      %%i, 8
+%assign %%i %%i+1
+%endrep
+%endmacro
+
+; %1, %2 = rows, %3 = dst; m8 = 0, m9 = pw_pixel_max
+%macro STORE_DIFFx2_AVX2 3
+    psrad        m%1, 6
+    psrad        m%2, 6
+    packssdw     m%1, m%2
+    vpermq       m%1, m%1, q3120
+    movu        xm%2, [%3]
+    vinserti128  m%2, m%2, [%3+r2], 1
+    paddsw       m%1, m%2
+    CLIPW        m%1, m8, m9
+    movu       [%3], xm%1
+    vextracti128 [%3+r2], m%1, 1
+%endmacro
+
+INIT_YMM avx2
+cglobal h264_idct8_add_10, 3,3,10
+    movsxdifnidn  r2, r2d
+    add   dword [r1], 32
+    movu          m7, [r1+112*2]
+    movu          m6, [r1+ 96*2]
+    movu          m5, [r1+ 80*2]
+    movu          m3, [r1+ 48*2]
+    movu          m2, [r1+ 32*2]
+    movu          m1, [r1+ 16*2]
+    movu          m8, [r1]        ; block is only 16-byte aligned
+    movu          m9, [r1+ 64*2]
+    IDCT8_1D     m8, m9
+    TRANSPOSE8x8D_AVX2
+    SWAP          0, 8
+    SWAP          4, 9
+    IDCT8_1D     m8, m9
+
+    pxor          m8, m8
+    vpbroadcastw  m9, [pw_pixel_max]
+    movu    [r1+  0], m8
+    movu    [r1+ 32], m8
+    movu    [r1+ 64], m8
+    movu    [r1+ 96], m8
+    movu    [r1+128], m8
+    movu    [r1+160], m8
+    movu    [r1+192], m8
+    movu    [r1+224], m8
+    STORE_DIFFx2_AVX2 0, 1, r0
+    lea           r0, [r0+r2*2]
+    STORE_DIFFx2_AVX2 2, 3, r0
+    lea           r0, [r0+r2*2]
+    STORE_DIFFx2_AVX2 4, 5, r0
+    lea           r0, [r0+r2*2]
+    STORE_DIFFx2_AVX2 6, 7, r0
+    RET
+%endif
+
 ;-----------------------------------------------------------------------------
 ; h264_idct8_add4(pixel **dst, const int *block_offset, dctcoef *block, int stride, const uint8_t nnzc[6*8])
 ;-----------------------------------------------------------------------------
@@ -237,6 +237,25 @@ static av_always_inline void ff_ ## OPNAME ## h264_qpel16_hv_lowpass_ ## MMX(uin
 #define ff_put_h264_qpel8or16_hv2_lowpass_sse2 ff_put_h264_qpel8or16_hv2_lowpass_mmxext
 #define ff_avg_h264_qpel8or16_hv2_lowpass_sse2 ff_avg_h264_qpel8or16_hv2_lowpass_mmxext
 
+#if ARCH_X86_64
+#define DEF_QPEL16_AVX2(OPNAME)\
+void ff_ ## OPNAME ## _h264_qpel16_h_lowpass_avx2(uint8_t *dst, uint8_t *src, int dstStride, int srcStride);\
+void ff_ ## OPNAME ## _h264_qpel16_h_lowpass_l2_avx2(uint8_t *dst, uint8_t *src, uint8_t *src2, int dstStride, int src2Stride);\
+void ff_ ## OPNAME ## _h264_qpel16_v_lowpass_avx2(uint8_t *dst, uint8_t *src, int dstStride, int srcStride);\
+void ff_ ## OPNAME ## _h264_qpel16_hv2_lowpass_avx2(uint8_t *dst, int16_t *tmp, int dstStride);\
+static av_always_inline void ff_ ## OPNAME ## _h264_qpel16_hv_lowpass_avx2(uint8_t *dst, int16_t *tmp, uint8_t *src, int dstStride, int tmpStride, int srcStride){\
+    ff_put_h264_qpel16_hv1_lowpass_avx2(src - 2*srcStride - 2, tmp, srcStride);\
+    ff_ ## OPNAME ## _h264_qpel16_hv2_lowpass_avx2(dst, tmp, dstStride);\
+}
+
+void ff_put_h264_qpel16_hv1_lowpass_avx2(uint8_t *src, int16_t *tmp, int srcStride);
+DEF_QPEL16_AVX2(put)
+DEF_QPEL16_AVX2(avg)
+
+#define ff_put_pixels16_l2_avx2 ff_put_pixels16_l2_mmxext
+#define ff_avg_pixels16_l2_avx2 ff_avg_pixels16_l2_mmxext
+#endif /* ARCH_X86_64 */
+
 #define H264_MC(OPNAME, SIZE, MMX, ALIGN) \
 H264_MC_C(OPNAME, SIZE, MMX, ALIGN)\
 H264_MC_V(OPNAME, SIZE, MMX, ALIGN)\
@@ -403,6 +422,14 @@ H264_MC_816(H264_MC_V, sse2)
 H264_MC_816(H264_MC_HV, sse2)
 H264_MC_816(H264_MC_H, ssse3)
 H264_MC_816(H264_MC_HV, ssse3)
+#if ARCH_X86_64
+H264_MC_V(put_, 16, avx2, 32)
+H264_MC_H(put_, 16, avx2, 32)
+H264_MC_HV(put_, 16, avx2, 32)
+H264_MC_V(avg_, 16, avx2, 32)
+H264_MC_H(avg_, 16, avx2, 32)
+H264_MC_HV(avg_, 16, avx2, 32)
+#endif
 
 
 //10bit
@@ -424,6 +451,10 @@ void ff_ ## OP ## _h264_qpel ## NUM ## _ ## TYPE ## _ ## DEPTH ## _ ## OPT \
     LUMA_MC_OP(put, 16, DEPTH, TYPE, OPT) \
     LUMA_MC_OP(avg, 16, DEPTH, TYPE, OPT)
 
+#define LUMA_MC_16(DEPTH, TYPE, OPT) \
+    LUMA_MC_OP(put, 16, DEPTH, TYPE, OPT) \
+    LUMA_MC_OP(avg, 16, DEPTH, TYPE, OPT)
+
 LUMA_MC_ALL(10, mc00, mmxext)
 LUMA_MC_ALL(10, mc10, mmxext)
 LUMA_MC_ALL(10, mc20, mmxext)
@@ -464,6 +495,25 @@ LUMA_MC_816(10, mc13, sse2)
 LUMA_MC_816(10, mc23, sse2)
 LUMA_MC_816(10, mc33, sse2)
 
+#if ARCH_X86_64
+LUMA_MC_16(10, mc00, avx2)
+LUMA_MC_16(10, mc10, avx2)
+LUMA_MC_16(10, mc20, avx2)
+LUMA_MC_16(10, mc30, avx2)
+LUMA_MC_16(10, mc01, avx2)
+LUMA_MC_16(10, mc11, avx2)
+LUMA_MC_16(10, mc21, avx2)
+LUMA_MC_16(10, mc31, avx2)
+LUMA_MC_16(10, mc02, avx2)
+LUMA_MC_16(10, mc12, avx2)
+LUMA_MC_16(10, mc22, avx2)
+LUMA_MC_16(10, mc32, avx2)
+LUMA_MC_16(10, mc03, avx2)
+LUMA_MC_16(10, mc13, avx2)
+LUMA_MC_16(10, mc23, avx2)
+LUMA_MC_16(10, mc33, avx2)
+#endif
+
 #define QPEL16_OPMC(OP, MC, MMX)\
 void ff_ ## OP ## _h264_qpel16_ ## MC ## _10_ ## MMX(uint8_t *dst, uint8_t *src, ptrdiff_t stride){\
     ff_ ## OP ## _h264_qpel8_ ## MC ## _10_ ## MMX(dst   , src   , stride);\
@@ -530,6 +580,12 @@ QPEL16(mmxext)
         c->avg_h264_qpel_pixels_tab[1][x + y * 4] = avg_h264_qpel8_mc  ## x ## y ## _ ## CPU; \
     } while (0)
 
+#define H264_QPEL16_FUNCS(x, y, CPU)                                                          \
+    do {                                                                                      \
+        c->put_h264_qpel_pixels_tab[0][x + y * 4] = put_h264_qpel16_mc ## x ## y ## _ ## CPU; \
+        c->avg_h264_qpel_pixels_tab[0][x + y * 4] = avg_h264_qpel16_mc ## x ## y ## _ ## CPU; \
+    } while (0)
+
 #define H264_QPEL_FUNCS_10(x, y, CPU)                                                               \
     do {                                                                                            \
         c->put_h264_qpel_pixels_tab[0][x + y * 4] = ff_put_h264_qpel16_mc ## x ## y ## _10_ ## CPU; \
@@ -630,5 +686,30 @@ av_cold void ff_h264qpel_init_x86(H264QpelContext *c, int bit_depth)
             H264_QPEL_FUNCS_10(3, 0, sse2);
         }
     }
+
+#if ARCH_X86_64
+    if (EXTERNAL_AVX2(cpu_flags)) {
+        if (!high_bit_depth) {
+            H264_QPEL16_FUNCS(0, 1, avx2);
+            H264_QPEL16_FUNCS(0, 2, avx2);
+            H264_QPEL16_FUNCS(0, 3, avx2);
+            H264_QPEL16_FUNCS(1, 0, avx2);
+            H264_QPEL16_FUNCS(1, 1, avx2);
+            H264_QPEL16_FUNCS(1, 2, avx2);
+            H264_QPEL16_FUNCS(1, 3, avx2);
+            H264_QPEL16_FUNCS(2, 0, avx2);
+            H264_QPEL16_FUNCS(2, 1, avx2);
+            H264_QPEL16_FUNCS(2, 2, avx2);
+            H264_QPEL16_FUNCS(2, 3, avx2);
+            H264_QPEL16_FUNCS(3, 0, avx2);
+            H264_QPEL16_FUNCS(3, 1, avx2);
+            H264_QPEL16_FUNCS(3, 2, avx2);
+            H264_QPEL16_FUNCS(3, 3, avx2);
+        } else if (bit_depth == 10) {
+            SET_QPEL_FUNCS(put_h264_qpel, 0, 16, 10_avx2, ff_);
+            SET_QPEL_FUNCS(avg_h264_qpel, 0, 16, 10_avx2, ff_);
+        }
+    }
+#endif
 #endif
 }
@@ -30,19 +30,19 @@ cextern pw_16
 cextern pw_1
 cextern pb_0
 
-pw_pixel_max: times 8 dw ((1 << 10)-1)
+pw_pixel_max: times 16 dw ((1 << 10)-1)
 
-pad10: times 8 dw 10*1023
-pad20: times 8 dw 20*1023
-pad30: times 8 dw 30*1023
-depad: times 4 dd 32*20*1023 + 512
-depad2: times 8 dw 20*1023 + 16*1022 + 16
-unpad: times 8 dw 16*1022/32 ; needs to be mod 16
+pad10: times 16 dw 10*1023
+pad20: times 16 dw 20*1023
+pad30: times 16 dw 30*1023
+depad: times 8 dd 32*20*1023 + 512
+depad2: times 16 dw 20*1023 + 16*1022 + 16
+unpad: times 16 dw 16*1022/32 ; needs to be mod 16
 
-tap1: times 4 dw  1, -5
-tap2: times 4 dw 20, 20
-tap3: times 4 dw -5,  1
-pd_0f: times 4 dd 0xffff
+tap1: times 8 dw  1, -5
+tap2: times 8 dw 20, 20
+tap3: times 8 dw -5,  1
+pd_0f: times 8 dd 0xffff
 
 SECTION .text
 
@@ -52,6 +52,12 @@ SECTION .text
     mova  %1, %2
 %endmacro
 
+; dst is only 16-byte aligned
+%macro AVG_MOVU 2
+    pavgw %2, %1
+    movu  %1, %2
+%endmacro
+
 %macro ADDW 3
 %if mmsize == 8
     paddw %1, %2
@@ -102,11 +108,22 @@ INIT_MMX mmxext
 INIT_XMM sse2
 %1 put, 8
 
+%if HAVE_AVX2_EXTERNAL && ARCH_X86_64
+%define OP_MOV movu
+INIT_YMM avx2
+%1 put, 16
+%endif
+
 %define OP_MOV AVG_MOV
 INIT_MMX mmxext
 %1 avg, 4
 INIT_XMM sse2
 %1 avg, 8
+%if HAVE_AVX2_EXTERNAL && ARCH_X86_64
+%define OP_MOV AVG_MOVU
+INIT_YMM avx2
+%1 avg, 16
+%endif
 %endmacro
 
 %macro MCAxA_OP 7
@@ -153,12 +170,13 @@ cglobal %1_h264_qpel%4_%2_10, %5,%6 + 2,%7
 ;cpu, put/avg, mc, 4/8, ...
 %macro cglobal_mc 6
 %assign i %3*2
-%if ARCH_X86_32 || cpuflag(sse2)
+%if (ARCH_X86_32 || cpuflag(sse2)) && mmsize < 32
 MCAxA_OP %1, %2, %3, i, %4,%5,%6
 %endif
 
 cglobal %1_h264_qpel%3_%2_10, %4,%5,%6
-%if UNIX64 == 0 ; no prologue or epilogue for UNIX64
+; no prologue or epilogue for UNIX64, except for the vzeroupper of ymm versions
+%if UNIX64 == 0 || mmsize == 32
     call stub_%1_h264_qpel%3_%2_10 %+ SUFFIX
     RET
 %endif
@@ -212,6 +230,26 @@ cglobal %1_h264_qpel16_mc00_10, 3,4
     dec r3d
     jg .loop
     REP_RET
+
+%if HAVE_AVX2_EXTERNAL && ARCH_X86_64
+INIT_YMM avx2
+cglobal %1_h264_qpel16_mc00_10, 3,4
+    mov r3d, 8
+.loop:
+    movu           m0, [r1   ]
+    movu           m1, [r1+r2]
+%ifidn %1, avg
+    pavgw          m0, [r0   ]
+    pavgw          m1, [r0+r2]
+%endif
+    movu    [r0   ], m0
+    movu    [r0+r2], m1
+    lea            r0, [r0+r2*2]
+    lea            r1, [r1+r2*2]
+    dec r3d
+    jg .loop
+    RET
+%endif
 %endmacro
 
 %define OP_MOV mova
@@ -233,6 +271,11 @@ INIT_XMM ssse3, cache64
 %1 put, 8
 INIT_XMM sse2
 %1 put, 8
+%if HAVE_AVX2_EXTERNAL && ARCH_X86_64
+%define OP_MOV movu
+INIT_YMM avx2
+%1 put, 16
+%endif
 
 %define OP_MOV AVG_MOV
 INIT_MMX mmxext
@@ -243,6 +286,11 @@ INIT_XMM ssse3, cache64
 %1 avg, 8
 INIT_XMM sse2
 %1 avg, 8
+%if HAVE_AVX2_EXTERNAL && ARCH_X86_64
+%define OP_MOV AVG_MOVU
+INIT_YMM avx2
+%1 avg, 16
+%endif
 %endmacro
 
 %macro MC20 2
@@ -256,7 +304,7 @@ cglobal_mc %1, mc20, %2, 3,4,9
     %define p16 [pw_16]
 %endif
 .nextrow:
-%if %0 == 4
+%if %0 == 4 || mmsize == 32
     movu     m2, [r1-4]
     movu     m3, [r1-2]
     movu     m4, [r1+0]
@@ -331,7 +379,7 @@ cglobal_mc %1, mc10, %2, 3,5,9
     %define p16 [pw_16]
 %endif
 .nextrow:
-%if %0 == 4
+%if %0 == 4 || mmsize == 32
     movu     m2, [r1-4]
     movu     m3, [r1-2]
     movu     m4, [r1+0]
@@ -413,6 +461,17 @@ SWAP 0,1,2,3,4,5
 %assign i i+1
 %endrep
 
+%if HAVE_AVX2_EXTERNAL && ARCH_X86_64
+INIT_YMM avx2
+RESET_MM_PERMUTATION
+%assign i 0
+%rep 6
+V_FILT m0, m1, m2, m3, m4, m5, m6, m7, 16, i
+SWAP 0,1,2,3,4,5
+%assign i i+1
+%endrep
+%endif
+
 %macro MC02 2
 cglobal_mc %1, mc02, %2, 3,4,8
     PRELOAD_V
@@ -522,6 +581,17 @@ SWAP 0,1,2,3,4,5
 %assign i i+1
 %endrep
 
+%if HAVE_AVX2_EXTERNAL && ARCH_X86_64
+INIT_YMM avx2
+RESET_MM_PERMUTATION
+%assign i 0
+%rep 6
+H_FILT_AVG 16, i
+SWAP 0,1,2,3,4,5
+%assign i i+1
+%endrep
+%endif
+
 %macro MC11 2
 ; this REALLY needs x86_64
 cglobal_mc %1, mc11, %2, 3,6,8
@@ -608,12 +678,11 @@ MC MC33
 %endmacro
 
 %macro HV 1
-%if mmsize==16
-%define PAD 12
-%define COUNT 2
-%else
-%define PAD 4
+%define PAD mmsize-4
+%if mmsize==8
 %define COUNT 3
+%else
+%define COUNT 2
 %endif
 put_hv%1_10:
     neg      r2           ; This actually saves instructions
@@ -647,6 +716,9 @@ put_hv%1_10:
     lea      r1, [r1+r2*8+mmsize]
 %if %1==8
     lea      r1, [r1+r2*4]
+%elif %1==16
+    lea      r1, [r1+r2*8]
+    lea      r1, [r1+r2*4]
 %endif
     dec      r3d
     jg .v_loop
@@ -658,6 +730,10 @@ INIT_MMX mmxext
 HV 4
 INIT_XMM sse2
 HV 8
+%if HAVE_AVX2_EXTERNAL && ARCH_X86_64
+INIT_YMM avx2
+HV 16
+%endif
 
 %macro H_LOOP 1
 %if num_mmregs > 8
@@ -722,6 +798,10 @@ INIT_MMX mmxext
 H_LOOP 4
 INIT_XMM sse2
 H_LOOP 8
+%if HAVE_AVX2_EXTERNAL && ARCH_X86_64
+INIT_YMM avx2
+H_LOOP 16
+%endif
 
 %macro MC22 2
 cglobal_mc %1, mc22, %2, 3,7,12
@@ -851,6 +931,10 @@ INIT_MMX mmxext
 H_NRD 4
 INIT_XMM sse2
 H_NRD 8
+%if HAVE_AVX2_EXTERNAL && ARCH_X86_64
+INIT_YMM avx2
+H_NRD 16
+%endif
 
 %macro MC21 2
 cglobal_mc %1, mc21, %2, 3,7,12
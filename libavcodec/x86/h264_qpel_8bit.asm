@@ -860,3 +860,210 @@ INIT_XMM ssse3
 QPEL16_H_LOWPASS_L2_OP put
 QPEL16_H_LOWPASS_L2_OP avg
 %endif
+
+%if HAVE_AVX2_EXTERNAL && ARCH_X86_64
+; 16-pixel wide AVX2 versions: one row is widened to 16 words in a ymm
+; register and two rows are packed back together for the store.
+
+; %1=put/avg, %2=register holding two packed rows, %3=dst stride
+%macro OP2_AVX2 3
+%ifidn %1, avg
+    movu         xm5, [r0]
+    vinserti128   m5, m5, [r0+%3], 1
+    pavgb         %2, m5
+%endif
+    movu        [r0], x%2
+    vextracti128 [r0+%3], %2, 1
+%endmacro
+
+; %1=dst, %2=src address; needs m6=pw_5, m7=pw_16, clobbers m3-m5
+%macro H_LOWPASS_AVX2 2
+    pmovzxbw      %1, [%2-2]
+    pmovzxbw      m3, [%2+3]
+    pmovzxbw      m4, [%2-1]
+    pmovzxbw      m5, [%2+2]
+    paddw         %1, m3         ; src[-2] + src[3]
+    pmovzxbw      m3, [%2+0]
+    paddw         m4, m5         ; src[-1] + src[2]
+    pmovzxbw      m5, [%2+1]
+    paddw         m3, m5         ; src[0] + src[1]
+    psllw         m3, 2
+    psubw         m3, m4
+    pmullw        m3, m6
+    paddw         %1, m7
+    paddw         %1, m3
+    psraw         %1, 5
+%endmacro
+
+%macro QPEL16_H_LOWPASS_AVX2 1
+cglobal %1_h264_qpel16_h_lowpass, 4,5,8 ; dst, src, dstStride, srcStride
+    movsxdifnidn  r2, r2d
+    movsxdifnidn  r3, r3d
+    vpbroadcastw  m6, [pw_5]
+    vpbroadcastw  m7, [pw_16]
+    mov          r4d, 8
+.loop:
+    H_LOWPASS_AVX2 m0, r1
+    H_LOWPASS_AVX2 m1, r1+r3
+    packuswb      m0, m1
+    vpermq        m0, m0, q3120
+    OP2_AVX2      %1, m0, r2
+    lea           r1, [r1+r3*2]
+    lea           r0, [r0+r2*2]
+    dec          r4d
+    jg         .loop
+    RET
+
+cglobal %1_h264_qpel16_h_lowpass_l2, 5,6,8 ; dst, src, src2, dstStride, src2Stride
+    movsxdifnidn  r3, r3d
+    movsxdifnidn  r4, r4d
+    vpbroadcastw  m6, [pw_5]
+    vpbroadcastw  m7, [pw_16]
+    mov          r5d, 8
+.loop:
+    H_LOWPASS_AVX2 m0, r1
+    H_LOWPASS_AVX2 m1, r1+r3
+    packuswb      m0, m1
+    vpermq        m0, m0, q3120
+    movu         xm1, [r2]
+    vinserti128   m1, m1, [r2+r4], 1
+    pavgb         m0, m1
+    OP2_AVX2      %1, m0, r3
+    lea           r1, [r1+r3*2]
+    lea           r0, [r0+r3*2]
+    lea           r2, [r2+r4*2]
+    dec          r5d
+    jg         .loop
+    RET
+%endmacro
+
+; %1=dst; m0-m4 hold rows -2..2 as words, m6=pw_5, m7=pw_16
+%macro FILT_V_AVX2 1
+    pmovzxbw      m5, [r1]
+    add           r1, r3
+    paddw         %1, m2, m3
+    paddw         m0, m5
+    psllw         %1, 2
+    psubw         %1, m1
+    psubw         %1, m4
+    pmullw        %1, m6
+    paddw         m0, m7
+    paddw         %1, m0
+    psraw         %1, 5
+    SWAP           0, 1, 2, 3, 4, 5
+%endmacro
+
+%macro QPEL16_V_LOWPASS_AVX2 1
+cglobal %1_h264_qpel16_v_lowpass, 4,4,10 ; dst, src, dstStride, srcStride
+    movsxdifnidn  r2, r2d
+    movsxdifnidn  r3, r3d
+    sub           r1, r3
+    sub           r1, r3
+    vpbroadcastw  m6, [pw_5]
+    vpbroadcastw  m7, [pw_16]
+    pmovzxbw      m0, [r1]
+    pmovzxbw      m1, [r1+r3]
+    lea           r1, [r1+r3*2]
+    pmovzxbw      m2, [r1]
+    pmovzxbw      m3, [r1+r3]
+    lea           r1, [r1+r3*2]
+    pmovzxbw      m4, [r1]
+    add           r1, r3
+%rep 8
+    FILT_V_AVX2   m8
+    FILT_V_AVX2   m9
+    packuswb      m8, m9
+    vpermq        m8, m8, q3120
+    OP2_AVX2      %1, m8, r2
+    lea           r0, [r0+r2*2]
+%endrep
+    RET
+%endmacro
+
+; vertical pass of the 2D filter over the 21 columns needed by the
+; horizontal pass, done as two overlapping 16-column halves
+%macro FILT_HV_AVX2 1 ; offset
+    pmovzxbw      m5, [r0]
+    add           r0, r2
+    paddw         m8, m2, m3
+    paddw         m0, m5
+    psllw         m8, 2
+    psubw         m8, m1
+    psubw         m8, m4
+    pmullw        m8, m6
+    paddw         m0, m7
+    paddw         m8, m0
+    movu     [r1+%1], m8
+    SWAP           0, 1, 2, 3, 4, 5
+%endmacro
+
+%macro QPEL16_HV1_LOWPASS_AVX2 0
+cglobal put_h264_qpel16_hv1_lowpass, 3,4,9 ; src, tmp, srcStride
+    movsxdifnidn  r2, r2d
+    vpbroadcastw  m6, [pw_5]
+    vpbroadcastw  m7, [pw_16]
+    mov           r3, r0
+%assign j 0
+%rep 2
+    pmovzxbw      m0, [r0]
+    pmovzxbw      m1, [r0+r2]
+    lea           r0, [r0+r2*2]
+    pmovzxbw      m2, [r0]
+    pmovzxbw      m3, [r0+r2]
+    lea           r0, [r0+r2*2]
+    pmovzxbw      m4, [r0]
+    add           r0, r2
+%assign i 0
+%rep 16
+    FILT_HV_AVX2  i*48+j*10
+%assign i i+1
+%endrep
+    lea           r0, [r3+5]
+%assign j j+1
+%endrep
+    RET
+%endmacro
+
+; %1=dst, %2=offset of a 48-byte row of the vertical pass from r1
+%macro HV2_AVX2 2
+    movu          %1, [r1+%2]
+    movu          m3, [r1+%2+2]
+    movu          m4, [r1+%2+4]
+    paddw         %1, [r1+%2+10]
+    paddw         m3, [r1+%2+8]
+    paddw         m4, [r1+%2+6]
+    psubw         %1, m3
+    psraw         %1, 2
+    psubw         %1, m3
+    paddw         %1, m4
+    psraw         %1, 2
+    paddw         %1, m4
+    psraw         %1, 6
+%endmacro
+
+%macro QPEL16_HV2_LOWPASS_AVX2 1
+cglobal %1_h264_qpel16_hv2_lowpass, 3,4,6 ; dst, tmp, dstStride
+    movsxdifnidn  r2, r2d
+    mov          r3d, 8
+.loop:
+    HV2_AVX2      m0, 0
+    HV2_AVX2      m1, 48
+    packuswb      m0, m1
+    vpermq        m0, m0, q3120
+    OP2_AVX2      %1, m0, r2
+    add           r1, 96
+    lea           r0, [r0+r2*2]
+    dec          r3d
+    jg         .loop
+    RET
+%endmacro
+
+INIT_YMM avx2
+QPEL16_H_LOWPASS_AVX2 put
+QPEL16_H_LOWPASS_AVX2 avg
+QPEL16_V_LOWPASS_AVX2 put
+QPEL16_V_LOWPASS_AVX2 avg
+QPEL16_HV1_LOWPASS_AVX2
+QPEL16_HV2_LOWPASS_AVX2 put
+QPEL16_HV2_LOWPASS_AVX2 avg
+%endif
@@ -143,22 +143,27 @@ WEIGHT_FUNC_HALF_MM 8, 8
     sub        r4, 1
 .normal
 %if cpuflag(ssse3)
-    movd       m4, r5d
-    movd       m0, r6d
+    movd      xm4, r5d
+    movd      xm0, r6d
 %else
     movd       m3, r5d
     movd       m4, r6d
 %endif
-    movd       m5, off_regd
-    movd       m6, r4d
-    pslld      m5, m6
-    psrld      m5, 1
+    movd      xm5, off_regd
+    movd      xm6, r4d
+    pslld     xm5, xm6
+    psrld     xm5, 1
 %if cpuflag(ssse3)
-    punpcklbw  m4, m0
+    punpcklbw xm4, xm0
+%if mmsize == 32
+    vpbroadcastw m4, xm4
+    vpbroadcastw m5, xm5
+%else
     pshuflw    m4, m4, 0
     pshuflw    m5, m5, 0
     punpcklqdq m4, m4
     punpcklqdq m5, m5
+%endif
 
 %else
 %if mmsize == 16
@@ -269,8 +274,8 @@ BIWEIGHT_FUNC_HALF_MM 8, 8
     pmaddubsw  m2, m4
     paddsw     m0, m5
     paddsw     m2, m5
-    psraw      m0, m6
-    psraw      m2, m6
+    psraw      m0, xm6
+    psraw      m2, xm6
     packuswb   m0, m2
 %endmacro
 
@@ -315,3 +320,59 @@ cglobal h264_biweight_8, 7, 8, 8
     dec        r3d
     jnz .nextrow
     REP_RET
+
+%if HAVE_AVX2_EXTERNAL
+; AVX2 versions process two rows per iteration, one row per 128-bit lane.
+INIT_YMM avx2
+cglobal h264_weight_16, 6, 7, 7
+    add        r5, r5
+    inc        r5
+    movd      xm3, r4d
+    movd      xm5, r5d
+    movd      xm6, r3d
+    pslld     xm5, xm6
+    psrld     xm5, 1
+    vpbroadcastw m3, xm3
+    vpbroadcastw m5, xm5
+    sar       r2d, 1
+    lea        r6, [r1*2]
+.nextrow:
+    pmovzxbw   m0, [r0]
+    pmovzxbw   m1, [r0+r1]
+    pmullw     m0, m3
+    pmullw     m1, m3
+    paddsw     m0, m5
+    paddsw     m1, m5
+    psraw      m0, xm6
+    psraw      m1, xm6
+    packuswb   m0, m1
+    vpermq     m0, m0, q3120
+    mova     [r0], xm0
+    vextracti128 [r0+r1], m0, 1
+    add        r0, r6
+    dec        r2d
+    jnz .nextrow
+    RET
+
+INIT_YMM avx2
+cglobal h264_biweight_16, 7, 8, 7
+    BIWEIGHT_SETUP
+    movifnidn r3d, r3m
+    sar       r3d, 1
+    lea        r4, [r2*2]
+.nextrow:
+    mova      xm0, [r0]
+    mova      xm1, [r1]
+    vinserti128 m0, m0, [r0+r2], 1
+    vinserti128 m1, m1, [r1+r2], 1
+    punpckhbw  m2, m0, m1
+    punpcklbw  m0, m1
+    BIWEIGHT_SSSE3_OP
+    mova     [r0], xm0
+    vextracti128 [r0+r2], m0, 1
+    add        r0, r4
+    add        r1, r4
+    dec        r3d
+    jnz .nextrow
+    RET
+%endif ; HAVE_AVX2_EXTERNAL
@@ -26,7 +26,7 @@
 
 SECTION_RODATA 32
 
-pw_pixel_max: times 8 dw ((1 << 10)-1)
+pw_pixel_max: times 16 dw ((1 << 10)-1)
 sq_1: dq 1
       dq 0
 
@@ -34,6 +34,16 @@ cextern pw_1
 
 SECTION .text
 
+; only 16-byte alignment is guaranteed for the data, so use unaligned
+; loads and stores for the 32-byte AVX2 rows
+%macro MOVROW 2
+%if mmsize == 32
+    movu       %1, %2
+%else
+    mova       %1, %2
+%endif
+%endmacro
+
 ;-----------------------------------------------------------------------------
 ; void h264_weight(uint8_t *dst, int stride, int height, int log2_denom,
 ;                  int weight, int offset);
@@ -49,16 +59,21 @@ SECTION .text
 %endmacro
 
 %macro WEIGHT_SETUP 0
-    mova       m0, [pw_1]
-    movd       m2, r3m
-    pslld      m0, m2       ; 1<<log2_denom
-    SPLATW     m0, m0
+    mova      xm0, [pw_1]
+    movd      xm2, r3m
+    pslld     xm0, xm2      ; 1<<log2_denom
     shl        r5, 19       ; *8, move to upper half of dword
     lea        r5, [r5+r4*2+0x10000]
-    movd       m3, r5d      ; weight<<1 | 1+(offset<<(3))
+    movd      xm3, r5d      ; weight<<1 | 1+(offset<<(3))
+%if mmsize == 32
+    vpbroadcastw m0, xm0
+    vpbroadcastd m3, xm3
+%else
+    SPLATW     m0, m0
     pshufd     m3, m3, 0
+%endif
     mova       m4, [pw_pixel_max]
-    paddw      m2, [sq_1]   ; log2_denom+1
+    paddw     xm2, [sq_1]   ; log2_denom+1
 %if notcpuflag(sse4)
     pxor       m7, m7
 %endif
@@ -66,7 +81,7 @@ SECTION .text
 
 %macro WEIGHT_OP 1-2
 %if %0==1
-    mova        m5, [r0+%1]
+    MOVROW      m5, [r0+%1]
     punpckhwd   m6, m5, m0
     punpcklwd   m5, m0
 %else
@@ -77,8 +92,8 @@ SECTION .text
 %endif
     pmaddwd     m5, m3
     pmaddwd     m6, m3
-    psrad       m5, m2
-    psrad       m6, m2
+    psrad       m5, xm2
+    psrad       m6, xm2
 %if cpuflag(sse4)
     packusdw    m5, m6
     pminsw      m5, m4
@@ -109,13 +124,13 @@ INIT_XMM sse4
 WEIGHT_FUNC_DBL
 
 
-%macro WEIGHT_FUNC_MM 0
-cglobal h264_weight_8_10
+%macro WEIGHT_FUNC_MM 0-1 8
+cglobal h264_weight_%1_10
     WEIGHT_PROLOGUE
     WEIGHT_SETUP
 .nextrow:
     WEIGHT_OP   0
-    mova     [r0], m5
+    MOVROW   [r0], m5
     add        r0, r1
     dec        r2d
     jnz .nextrow
@@ -126,6 +141,10 @@ INIT_XMM sse2
 WEIGHT_FUNC_MM
 INIT_XMM sse4
 WEIGHT_FUNC_MM
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+WEIGHT_FUNC_MM 16
+%endif
 
 
 %macro WEIGHT_FUNC_HALF_MM 0
@@ -176,13 +195,18 @@ DECLARE_REG_TMP 7
     or         t0, 1
     shl        r6, 16
     or         r5, r6
-    movd       m4, r5d      ; weightd | weights
-    movd       m5, t0d      ; (offset+1)|1
-    movd       m6, r4m      ; log2_denom
-    pslld      m5, m6       ; (((offset<<2)+1)|1)<<log2_denom
-    paddd      m6, [sq_1]
+    movd      xm4, r5d      ; weightd | weights
+    movd      xm5, t0d      ; (offset+1)|1
+    movd      xm6, r4m      ; log2_denom
+    pslld     xm5, xm6      ; (((offset<<2)+1)|1)<<log2_denom
+    paddd     xm6, [sq_1]
+%if mmsize == 32
+    vpbroadcastd m4, xm4
+    vpbroadcastd m5, xm5
+%else
     pshufd     m4, m4, 0
     pshufd     m5, m5, 0
+%endif
     mova       m3, [pw_pixel_max]
     movifnidn r3d, r3m
 %if notcpuflag(sse4)
@@ -192,8 +216,8 @@ DECLARE_REG_TMP 7
 
 %macro BIWEIGHT 1-2
 %if %0==1
-    mova       m0, [r0+%1]
-    mova       m1, [r1+%1]
+    MOVROW     m0, [r0+%1]
+    MOVROW     m1, [r1+%1]
     punpckhwd  m2, m0, m1
     punpcklwd  m0, m1
 %else
@@ -208,8 +232,8 @@ DECLARE_REG_TMP 7
     pmaddwd    m2, m4
     paddd      m0, m5
     paddd      m2, m5
-    psrad      m0, m6
-    psrad      m2, m6
+    psrad      m0, xm6
+    psrad      m2, xm6
 %if cpuflag(sse4)
     packusdw   m0, m2
     pminsw     m0, m3
@@ -240,13 +264,13 @@ BIWEIGHT_FUNC_DBL
 INIT_XMM sse4
 BIWEIGHT_FUNC_DBL
 
-%macro BIWEIGHT_FUNC 0
-cglobal h264_biweight_8_10
+%macro BIWEIGHT_FUNC 0-1 8
+cglobal h264_biweight_%1_10
     BIWEIGHT_PROLOGUE
     BIWEIGHT_SETUP
 .nextrow:
     BIWEIGHT  0
-    mova   [r0], m0
+    MOVROW [r0], m0
     add      r0, r2
     add      r1, r2
     dec      r3d
@@ -258,6 +282,10 @@ INIT_XMM sse2
 BIWEIGHT_FUNC
 INIT_XMM sse4
 BIWEIGHT_FUNC
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+BIWEIGHT_FUNC 16
+%endif
 
 %macro BIWEIGHT_FUNC_HALF 0
 cglobal h264_biweight_4_10
@@ -44,6 +44,7 @@ IDCT_ADD_FUNC(8, 10, sse2)
 IDCT_ADD_FUNC(, 10, avx)
 IDCT_ADD_FUNC(8_dc, 10, avx)
 IDCT_ADD_FUNC(8, 10, avx)
+IDCT_ADD_FUNC(8, 10, avx2)
 
 
 #define IDCT_ADD_REP_FUNC(NUM, REP, DEPTH, OPT)                         \
@@ -151,6 +152,10 @@ static void deblock_v_luma_intra_8_mmxext(uint8_t *pix, int stride,
 
 LF_FUNC(v,  luma,       10, mmxext)
 LF_IFUNC(v, luma_intra, 10, mmxext)
+LF_FUNC(h,  luma,       10, avx2)
+LF_FUNC(v,  luma,       10, avx2)
+LF_IFUNC(h, luma_intra, 10, avx2)
+LF_IFUNC(v, luma_intra, 10, avx2)
 
 /***********************************/
 /* weighted prediction */
@@ -180,6 +185,9 @@ H264_BIWEIGHT_MMX_SSE(16)
 H264_BIWEIGHT_MMX_SSE(8)
 H264_BIWEIGHT_MMX(4)
 
+H264_WEIGHT(16, avx2)
+H264_BIWEIGHT(16, avx2)
+
 #define H264_WEIGHT_10(W, DEPTH, OPT)                                   \
 void ff_h264_weight_ ## W ## _ ## DEPTH ## _ ## OPT(uint8_t *dst,       \
                                                     int stride,         \
@@ -208,6 +216,9 @@ H264_BIWEIGHT_10_SSE(16, 10)
 H264_BIWEIGHT_10_SSE(8,  10)
 H264_BIWEIGHT_10_SSE(4,  10)
 
+H264_WEIGHT_10(16, 10, avx2)
+H264_BIWEIGHT_10(16, 10, avx2)
+
 av_cold void ff_h264dsp_init_x86(H264DSPContext *c, const int bit_depth,
                                  const int chroma_format_idc)
 {
@@ -292,6 +303,10 @@ av_cold void ff_h264dsp_init_x86(H264DSPContext *c, const int bit_depth,
             c->h264_v_loop_filter_luma_intra = ff_deblock_v_luma_intra_8_avx;
             c->h264_h_loop_filter_luma_intra = ff_deblock_h_luma_intra_8_avx;
         }
+        if (EXTERNAL_AVX2(cpu_flags)) {
+            c->weight_h264_pixels_tab[0]   = ff_h264_weight_16_avx2;
+            c->biweight_h264_pixels_tab[0] = ff_h264_biweight_16_avx2;
+        }
     } else if (bit_depth == 10) {
         if (EXTERNAL_MMXEXT(cpu_flags)) {
 #if ARCH_X86_32
@@ -366,6 +381,17 @@ av_cold void ff_h264dsp_init_x86(H264DSPContext *c, const int bit_depth,
             c->h264_h_loop_filter_luma_intra   = ff_deblock_h_luma_intra_10_avx;
 #endif /* HAVE_ALIGNED_STACK */
         }
+        if (EXTERNAL_AVX2(cpu_flags)) {
+            c->weight_h264_pixels_tab[0]   = ff_h264_weight_16_10_avx2;
+            c->biweight_h264_pixels_tab[0] = ff_h264_biweight_16_10_avx2;
+#if ARCH_X86_64
+            c->h264_idct8_add = ff_h264_idct8_add_10_avx2;
+            c->h264_v_loop_filter_luma       = ff_deblock_v_luma_10_avx2;
+            c->h264_h_loop_filter_luma       = ff_deblock_h_luma_10_avx2;
+            c->h264_v_loop_filter_luma_intra = ff_deblock_v_luma_intra_10_avx2;
+            c->h264_h_loop_filter_luma_intra = ff_deblock_h_luma_intra_10_avx2;
+#endif /* ARCH_X86_64 */
+        }
     }
 #endif
 }
@@ -202,6 +202,54 @@ lpf_funcs(88, 16, avx);
 
 #undef lpf_funcs
 
+#define ipred_func(size, type, opt) \
+void ff_vp9_ipred_##type##_##size##x##size##_##opt(uint8_t *dst, ptrdiff_t stride, \
+                                                  const uint8_t *l, const uint8_t *a)
+
+#define ipred_dc_funcs(size, opt) \
+ipred_func(size, dc, opt); \
+ipred_func(size, dc_left, opt); \
+ipred_func(size, dc_top, opt)
+
+#define ipred_dir_funcs(size, opt) \
+ipred_func(size, dl, opt); \
+ipred_func(size, dr, opt); \
+ipred_func(size, vl, opt); \
+ipred_func(size, vr, opt); \
+ipred_func(size, hd, opt); \
+ipred_func(size, hu, opt)
+
+ipred_func(8, v, mmx);
+ipred_func(16, v, sse);
+ipred_func(32, v, sse);
+ipred_func(32, v, avx2);
+ipred_func(4, h, mmxext);
+ipred_func(8, h, ssse3);
+ipred_func(16, h, ssse3);
+ipred_func(32, h, ssse3);
+ipred_func(32, h, avx2);
+ipred_dc_funcs(4, mmxext);
+ipred_dc_funcs(8, mmxext);
+ipred_dc_funcs(16, ssse3);
+ipred_dc_funcs(32, ssse3);
+ipred_dc_funcs(32, avx2);
+ipred_func(8, tm, ssse3);
+ipred_func(16, tm, ssse3);
+ipred_func(32, tm, ssse3);
+ipred_func(32, tm, avx2);
+ipred_func(4, tm, mmxext);
+ipred_dir_funcs(4, ssse3);
+ipred_dir_funcs(8, ssse3);
+ipred_dir_funcs(16, ssse3);
+ipred_dir_funcs(32, ssse3);
+ipred_dir_funcs(8, avx);
+ipred_dir_funcs(16, avx);
+ipred_dir_funcs(32, avx);
+
+#undef ipred_func
+#undef ipred_dc_funcs
+#undef ipred_dir_funcs
+
 #endif /* HAVE_YASM */
 
 av_cold void ff_vp9dsp_init_x86(VP9DSPContext *dsp)
@@ -248,6 +296,22 @@ av_cold void ff_vp9dsp_init_x86(VP9DSPContext *dsp)
     } \
 } while (0)
 
+#define init_ipred(tx, sz, opt) do { \
+    dsp->intra_pred[tx][HOR_PRED]     = ff_vp9_ipred_h_##sz##x##sz##_##opt; \
+    dsp->intra_pred[tx][DC_PRED]      = ff_vp9_ipred_dc_##sz##x##sz##_##opt; \
+    dsp->intra_pred[tx][LEFT_DC_PRED] = ff_vp9_ipred_dc_left_##sz##x##sz##_##opt; \
+    dsp->intra_pred[tx][TOP_DC_PRED]  = ff_vp9_ipred_dc_top_##sz##x##sz##_##opt; \
+} while (0)
+
+#define init_dir_ipred(tx, sz, opt) do { \
+    dsp->intra_pred[tx][DIAG_DOWN_LEFT_PRED]  = ff_vp9_ipred_dl_##sz##x##sz##_##opt; \
+    dsp->intra_pred[tx][DIAG_DOWN_RIGHT_PRED] = ff_vp9_ipred_dr_##sz##x##sz##_##opt; \
+    dsp->intra_pred[tx][VERT_LEFT_PRED]       = ff_vp9_ipred_vl_##sz##x##sz##_##opt; \
+    dsp->intra_pred[tx][VERT_RIGHT_PRED]      = ff_vp9_ipred_vr_##sz##x##sz##_##opt; \
+    dsp->intra_pred[tx][HOR_DOWN_PRED]        = ff_vp9_ipred_hd_##sz##x##sz##_##opt; \
+    dsp->intra_pred[tx][HOR_UP_PRED]          = ff_vp9_ipred_hu_##sz##x##sz##_##opt; \
+} while (0)
+
     if (EXTERNAL_MMX(cpu_flags)) {
         init_fpel(4, 0,  4, put, mmx);
         init_fpel(3, 0,  8, put, mmx);
@@ -255,17 +319,25 @@ av_cold void ff_vp9dsp_init_x86(VP9DSPContext *dsp)
         dsp->itxfm_add[4 /* lossless */][ADST_DCT] =
         dsp->itxfm_add[4 /* lossless */][DCT_ADST] =
         dsp->itxfm_add[4 /* lossless */][ADST_ADST] = ff_vp9_iwht_iwht_4x4_add_mmx;
+        dsp->intra_pred[TX_8X8][VERT_PRED] = ff_vp9_ipred_v_8x8_mmx;
     }
 
     if (EXTERNAL_MMXEXT(cpu_flags)) {
         init_fpel(4, 1,  4, avg, mmxext);
         init_fpel(3, 1,  8, avg, mmxext);
+        init_ipred(TX_4X4, 4, mmxext);
+        dsp->intra_pred[TX_4X4][TM_VP8_PRED] = ff_vp9_ipred_tm_4x4_mmxext;
+        dsp->intra_pred[TX_8X8][DC_PRED]      = ff_vp9_ipred_dc_8x8_mmxext;
+        dsp->intra_pred[TX_8X8][LEFT_DC_PRED] = ff_vp9_ipred_dc_left_8x8_mmxext;
+        dsp->intra_pred[TX_8X8][TOP_DC_PRED]  = ff_vp9_ipred_dc_top_8x8_mmxext;
     }
 
     if (EXTERNAL_SSE(cpu_flags)) {
         init_fpel(2, 0, 16, put, sse);
         init_fpel(1, 0, 32, put, sse);
         init_fpel(0, 0, 64, put, sse);
+        dsp->intra_pred[TX_16X16][VERT_PRED] = ff_vp9_ipred_v_16x16_sse;
+        dsp->intra_pred[TX_32X32][VERT_PRED] = ff_vp9_ipred_v_32x32_sse;
     }
 
     if (EXTERNAL_SSE2(cpu_flags)) {
@@ -282,7 +354,18 @@ av_cold void ff_vp9dsp_init_x86(VP9DSPContext *dsp)
         dsp->itxfm_add[TX_4X4][ADST_DCT]  = ff_vp9_idct_iadst_4x4_add_ssse3;
         dsp->itxfm_add[TX_4X4][DCT_ADST]  = ff_vp9_iadst_idct_4x4_add_ssse3;
         dsp->itxfm_add[TX_4X4][ADST_ADST] = ff_vp9_iadst_iadst_4x4_add_ssse3;
+        dsp->intra_pred[TX_8X8][HOR_PRED]    = ff_vp9_ipred_h_8x8_ssse3;
+        dsp->intra_pred[TX_8X8][TM_VP8_PRED] = ff_vp9_ipred_tm_8x8_ssse3;
+        init_ipred(TX_16X16, 16, ssse3);
+        init_ipred(TX_32X32, 32, ssse3);
+        dsp->intra_pred[TX_16X16][TM_VP8_PRED] = ff_vp9_ipred_tm_16x16_ssse3;
+        init_dir_ipred(TX_4X4, 4, ssse3);
+        init_dir_ipred(TX_8X8, 8, ssse3);
+        init_dir_ipred(TX_16X16, 16, ssse3);
+        dsp->intra_pred[TX_32X32][DIAG_DOWN_LEFT_PRED] = ff_vp9_ipred_dl_32x32_ssse3;
         if (ARCH_X86_64) {
+            init_dir_ipred(TX_32X32, 32, ssse3);
+            dsp->intra_pred[TX_32X32][TM_VP8_PRED] = ff_vp9_ipred_tm_32x32_ssse3;
             dsp->itxfm_add[TX_8X8][DCT_DCT] = ff_vp9_idct_idct_8x8_add_ssse3;
             dsp->itxfm_add[TX_8X8][ADST_DCT]  = ff_vp9_idct_iadst_8x8_add_ssse3;
             dsp->itxfm_add[TX_8X8][DCT_ADST]  = ff_vp9_iadst_idct_8x8_add_ssse3;
@@ -300,7 +383,11 @@ av_cold void ff_vp9dsp_init_x86(VP9DSPContext *dsp)
     }
 
     if (EXTERNAL_AVX(cpu_flags)) {
+        init_dir_ipred(TX_8X8, 8, avx);
+        init_dir_ipred(TX_16X16, 16, avx);
+        dsp->intra_pred[TX_32X32][DIAG_DOWN_LEFT_PRED] = ff_vp9_ipred_dl_32x32_avx;
         if (ARCH_X86_64) {
+            init_dir_ipred(TX_32X32, 32, avx);
             dsp->itxfm_add[TX_8X8][DCT_DCT] = ff_vp9_idct_idct_8x8_add_avx;
             dsp->itxfm_add[TX_8X8][ADST_DCT]  = ff_vp9_idct_iadst_8x8_add_avx;
             dsp->itxfm_add[TX_8X8][DCT_ADST]  = ff_vp9_iadst_idct_8x8_add_avx;
@@ -317,10 +404,20 @@ av_cold void ff_vp9dsp_init_x86(VP9DSPContext *dsp)
         init_lpf(avx);
     }
 
+    if (EXTERNAL_AVX2(cpu_flags)) {
+        init_ipred(TX_32X32, 32, avx2);
+        dsp->intra_pred[TX_32X32][VERT_PRED] = ff_vp9_ipred_v_32x32_avx2;
+        if (ARCH_X86_64)
+            dsp->intra_pred[TX_32X32][TM_VP8_PRED] = ff_vp9_ipred_tm_32x32_avx2;
+    }
+
 #undef init_fpel
 #undef init_subpel1
 #undef init_subpel2
 #undef init_subpel3
+#undef init_lpf
+#undef init_ipred
+#undef init_dir_ipred
 
 #endif /* HAVE_YASM */
 }
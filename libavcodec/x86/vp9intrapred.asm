@@ -0,0 +1,1254 @@
+;******************************************************************************
+;* VP9 Intra prediction SIMD optimizations
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA 32
+
+pb_1:       times 32 db 1
+pb_15:      times 32 db 15
+pb_15m1:    times 16 db 15, -1 ; pshufb masks that zero-extend one byte
+pw_m1:      times 16 dw -1     ; into every word
+pb_7m1:     times  8 db  7, -1
+pb_2:       times 16 db  2
+pb_7x8_6x8: times  8 db  7
+            times  8 db  6
+
+; pshufb masks replicating the last edge pixel, for the 4x4/8x8 directional
+; predictors
+pb_0to5_2x7:   db 0, 1, 2, 3, 4, 5, 7, 7
+               times 8 db 7
+pb_0to7_8x7:   db 0, 1, 2, 3, 4, 5, 6, 7
+               times 8 db 7
+pb_1to7_9x7:   db 1, 2, 3, 4, 5, 6, 7
+               times 9 db 7
+pb_2to7_10x7:  db 2, 3, 4, 5, 6, 7
+               times 10 db 7
+pb_3to0_12x0:  db 3, 2, 1, 0
+               times 12 db 0
+pb_2to0_13x0:  db 2, 1, 0
+               times 13 db 0
+pb_1to0_14x0:  db 1, 0
+               times 14 db 0
+pb_7to0_8x0:   db 7, 6, 5, 4, 3, 2, 1, 0
+               times 8 db 0
+pb_6to0_9x0:   db 6, 5, 4, 3, 2, 1, 0
+               times 9 db 0
+pb_5to0_10x0:  db 5, 4, 3, 2, 1, 0
+               times 10 db 0
+pb_15to0:      db 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0
+; gathers the even bytes into the upper half
+pb_8x80_even:  times 8 db 0x80
+               db 0, 2, 4, 6, 8, 10, 12, 14
+
+cextern pw_2
+cextern pw_4
+cextern pw_8
+cextern pw_16
+cextern pw_32
+
+SECTION .text
+
+; The left edge is stored bottom-to-top, i.e. row y of an NxN block uses
+; left[N-1-y]. dst, left and top are aligned to min(N, 16) bytes, so the
+; ymm versions use unaligned loads and stores.
+
+%macro MOVROW 2
+%if mmsize == 32
+    movu                    %1, %2
+%else
+    mova                    %1, %2
+%endif
+%endmacro
+
+;-----------------------------------------------------------------------------
+; void vp9_ipred_v_NxN(uint8_t *dst, ptrdiff_t stride,
+;                      const uint8_t *left, const uint8_t *top)
+;-----------------------------------------------------------------------------
+
+INIT_MMX mmx
+cglobal vp9_ipred_v_8x8, 4, 4, 0, dst, stride, l, a
+    movq                    m0, [aq]
+    DEFINE_ARGS dst, stride, stride3
+    lea               stride3q, [strideq*3]
+    movq      [dstq+strideq*0], m0
+    movq      [dstq+strideq*1], m0
+    movq      [dstq+strideq*2], m0
+    movq      [dstq+stride3q ], m0
+    lea                   dstq, [dstq+strideq*4]
+    movq      [dstq+strideq*0], m0
+    movq      [dstq+strideq*1], m0
+    movq      [dstq+strideq*2], m0
+    movq      [dstq+stride3q ], m0
+    RET
+
+INIT_XMM sse
+cglobal vp9_ipred_v_16x16, 4, 4, 1, dst, stride, l, a
+    mova                    m0, [aq]
+    DEFINE_ARGS dst, stride, stride3, cnt
+    lea               stride3q, [strideq*3]
+    mov                   cntd, 4
+.loop:
+    mova      [dstq+strideq*0], m0
+    mova      [dstq+strideq*1], m0
+    mova      [dstq+strideq*2], m0
+    mova      [dstq+stride3q ], m0
+    lea                   dstq, [dstq+strideq*4]
+    dec                   cntd
+    jg .loop
+    RET
+
+INIT_XMM sse
+cglobal vp9_ipred_v_32x32, 4, 4, 2, dst, stride, l, a
+    mova                    m0, [aq]
+    mova                    m1, [aq+16]
+    DEFINE_ARGS dst, stride, stride3, cnt
+    lea               stride3q, [strideq*3]
+    mov                   cntd, 8
+.loop:
+    mova   [dstq+strideq*0+ 0], m0
+    mova   [dstq+strideq*0+16], m1
+    mova   [dstq+strideq*1+ 0], m0
+    mova   [dstq+strideq*1+16], m1
+    mova   [dstq+strideq*2+ 0], m0
+    mova   [dstq+strideq*2+16], m1
+    mova   [dstq+stride3q + 0], m0
+    mova   [dstq+stride3q +16], m1
+    lea                   dstq, [dstq+strideq*4]
+    dec                   cntd
+    jg .loop
+    RET
+
+;-----------------------------------------------------------------------------
+; void vp9_ipred_h_NxN(uint8_t *dst, ptrdiff_t stride,
+;                      const uint8_t *left, const uint8_t *top)
+;-----------------------------------------------------------------------------
+
+INIT_MMX mmxext
+cglobal vp9_ipred_h_4x4, 3, 3, 0, dst, stride, l
+    movd                    m0, [lq]
+    punpcklbw               m0, m0
+    pshufw                  m1, m0, q3333
+    movd      [dstq+strideq*0], m1
+    pshufw                  m1, m0, q2222
+    movd      [dstq+strideq*1], m1
+    lea                   dstq, [dstq+strideq*2]
+    pshufw                  m1, m0, q1111
+    movd      [dstq+strideq*0], m1
+    pshufw                  m1, m0, q0000
+    movd      [dstq+strideq*1], m1
+    RET
+
+INIT_XMM ssse3
+cglobal vp9_ipred_h_8x8, 3, 4, 4, dst, stride, l, stride3
+    movq                    m0, [lq]
+    mova                    m2, [pb_7x8_6x8]
+    mova                    m3, [pb_2]
+    lea               stride3q, [strideq*3]
+    pshufb                  m1, m0, m2
+    movq      [dstq+strideq*0], m1
+    movhps    [dstq+strideq*1], m1
+    psubb                   m2, m3
+    pshufb                  m1, m0, m2
+    movq      [dstq+strideq*2], m1
+    movhps    [dstq+stride3q ], m1
+    lea                   dstq, [dstq+strideq*4]
+    psubb                   m2, m3
+    pshufb                  m1, m0, m2
+    movq      [dstq+strideq*0], m1
+    movhps    [dstq+strideq*1], m1
+    psubb                   m2, m3
+    pshufb                  m1, m0, m2
+    movq      [dstq+strideq*2], m1
+    movhps    [dstq+stride3q ], m1
+    RET
+
+; %1 = number of mmsize-wide stores per row
+; in: m0 = 16 left pixels, m2 = pb_15, m3 = pb_1
+%macro H_XMM_16ROWS 1
+    mov                   cntd, 4
+%%loop:
+%assign %%i 0
+%rep 4
+    pshufb                  m1, m0, m2
+%assign %%j 0
+%rep %1
+%if %%i == 3
+    MOVROW [dstq+stride3q+%%j*mmsize], m1
+%else
+    MOVROW [dstq+strideq*%%i+%%j*mmsize], m1
+%endif
+%assign %%j %%j+1
+%endrep
+    psubb                   m2, m3
+%assign %%i %%i+1
+%endrep
+    lea                   dstq, [dstq+strideq*4]
+    dec                   cntd
+    jg %%loop
+%endmacro
+
+INIT_XMM ssse3
+cglobal vp9_ipred_h_16x16, 3, 5, 4, dst, stride, l, stride3, cnt
+    mova                    m0, [lq]
+    mova                    m2, [pb_15]
+    mova                    m3, [pb_1]
+    lea               stride3q, [strideq*3]
+    H_XMM_16ROWS 1
+    RET
+
+%macro IPRED_H_32 0
+cglobal vp9_ipred_h_32x32, 3, 5, 4, dst, stride, l, stride3, cnt
+%if mmsize == 32
+    vbroadcasti128          m0, [lq+16]
+%else
+    mova                    m0, [lq+16]
+%endif
+    mova                    m2, [pb_15]
+    mova                    m3, [pb_1]
+    lea               stride3q, [strideq*3]
+    H_XMM_16ROWS 32/mmsize
+%if mmsize == 32
+    vbroadcasti128          m0, [lq]
+%else
+    mova                    m0, [lq]
+%endif
+    mova                    m2, [pb_15]
+    H_XMM_16ROWS 32/mmsize
+    RET
+%endmacro
+
+INIT_XMM ssse3
+IPRED_H_32
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+IPRED_H_32
+%endif
+
+;-----------------------------------------------------------------------------
+; void vp9_ipred_dc[_top|_left]_NxN(uint8_t *dst, ptrdiff_t stride,
+;                                   const uint8_t *left, const uint8_t *top)
+;-----------------------------------------------------------------------------
+
+; %1 = function name suffix, %2 = rounding constant, %3 = shift,
+; %4 and optionally %5 = edge pointer registers to sum
+%macro DC_4x4 3-5
+cglobal vp9_ipred_dc%1_4x4, 4, 4, 0, dst, stride, l, a
+    movd                    m0, [%4q]
+%if %0 == 5
+    movd                    m1, [%5q]
+    punpckldq               m0, m1
+%endif
+    pxor                    m1, m1
+    psadbw                  m0, m1
+    paddw                   m0, [%2]
+    psrlw                   m0, %3
+    pshufw                  m0, m0, q0000
+    packuswb                m0, m0
+    movd      [dstq+strideq*0], m0
+    movd      [dstq+strideq*1], m0
+    lea                   dstq, [dstq+strideq*2]
+    movd      [dstq+strideq*0], m0
+    movd      [dstq+strideq*1], m0
+    RET
+%endmacro
+
+INIT_MMX mmxext
+DC_4x4      , pw_4, 3, l, a
+DC_4x4 _top , pw_2, 2, a
+DC_4x4 _left, pw_2, 2, l
+
+%macro DC_8x8 3-5
+cglobal vp9_ipred_dc%1_8x8, 4, 4, 0, dst, stride, l, a
+    movq                    m0, [%4q]
+    pxor                    m1, m1
+    psadbw                  m0, m1
+%if %0 == 5
+    movq                    m2, [%5q]
+    psadbw                  m2, m1
+    paddw                   m0, m2
+%endif
+    paddw                   m0, [%2]
+    psrlw                   m0, %3
+    pshufw                  m0, m0, q0000
+    packuswb                m0, m0
+    DEFINE_ARGS dst, stride, stride3
+    lea               stride3q, [strideq*3]
+    movq      [dstq+strideq*0], m0
+    movq      [dstq+strideq*1], m0
+    movq      [dstq+strideq*2], m0
+    movq      [dstq+stride3q ], m0
+    lea                   dstq, [dstq+strideq*4]
+    movq      [dstq+strideq*0], m0
+    movq      [dstq+strideq*1], m0
+    movq      [dstq+strideq*2], m0
+    movq      [dstq+stride3q ], m0
+    RET
+%endmacro
+
+INIT_MMX mmxext
+DC_8x8      , pw_8, 4, l, a
+DC_8x8 _top , pw_4, 3, a
+DC_8x8 _left, pw_4, 3, l
+
+; store m0 into %1 rows of %2 bytes
+%macro DC_STORE 2
+    DEFINE_ARGS dst, stride, stride3, cnt
+    lea               stride3q, [strideq*3]
+    mov                   cntd, %1/4
+.loop:
+%assign %%j 0
+%rep %2/mmsize
+    MOVROW [dstq+strideq*0+%%j*mmsize], m0
+    MOVROW [dstq+strideq*1+%%j*mmsize], m0
+    MOVROW [dstq+strideq*2+%%j*mmsize], m0
+    MOVROW [dstq+stride3q +%%j*mmsize], m0
+%assign %%j %%j+1
+%endrep
+    lea                   dstq, [dstq+strideq*4]
+    dec                   cntd
+    jg .loop
+%endmacro
+
+%macro DC_16x16 3-5
+cglobal vp9_ipred_dc%1_16x16, 4, 4, 3, dst, stride, l, a
+    mova                    m0, [%4q]
+    pxor                    m2, m2
+    psadbw                  m0, m2
+%if %0 == 5
+    mova                    m1, [%5q]
+    psadbw                  m1, m2
+    paddw                   m0, m1
+%endif
+    movhlps                 m1, m0
+    paddw                   m0, m1
+    paddw                   m0, [%2]
+    psrlw                   m0, %3
+    pshufb                  m0, m2
+    DC_STORE 16, 16
+    RET
+%endmacro
+
+INIT_XMM ssse3
+DC_16x16      , pw_16, 5, l, a
+DC_16x16 _top , pw_8,  4, a
+DC_16x16 _left, pw_8,  4, l
+
+%macro DC_32x32 3-5
+cglobal vp9_ipred_dc%1_32x32, 4, 4, 3, dst, stride, l, a
+%if mmsize == 32
+    movu                    m0, [%4q]
+    pxor                    m2, m2
+    psadbw                  m0, m2
+%if %0 == 5
+    movu                    m1, [%5q]
+    psadbw                  m1, m2
+    paddw                   m0, m1
+%endif
+    vextracti128           xm1, m0, 1
+    paddw                  xm0, xm1
+%else
+    mova                    m0, [%4q]
+    mova                    m1, [%4q+16]
+    pxor                    m2, m2
+    psadbw                  m0, m2
+    psadbw                  m1, m2
+    paddw                   m0, m1
+%if %0 == 5
+    mova                    m1, [%5q]
+    psadbw                  m1, m2
+    paddw                   m0, m1
+    mova                    m1, [%5q+16]
+    psadbw                  m1, m2
+    paddw                   m0, m1
+%endif
+%endif
+    movhlps                xm1, xm0
+    paddw                  xm0, xm1
+    paddw                  xm0, [%2]
+    psrlw                  xm0, %3
+%if mmsize == 32
+    vpbroadcastb            m0, xm0
+%else
+    pshufb                  m0, m2
+%endif
+    DC_STORE 32, 32
+    RET
+%endmacro
+
+INIT_XMM ssse3
+DC_32x32      , pw_32, 6, l, a
+DC_32x32 _top , pw_16, 5, a
+DC_32x32 _left, pw_16, 5, l
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+DC_32x32      , pw_32, 6, l, a
+DC_32x32 _top , pw_16, 5, a
+DC_32x32 _left, pw_16, 5, l
+%endif
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+cglobal vp9_ipred_v_32x32, 4, 4, 1, dst, stride, l, a
+    movu                    m0, [aq]
+    DC_STORE 32, 32
+    RET
+%endif
+
+;-----------------------------------------------------------------------------
+; void vp9_ipred_tm_NxN(uint8_t *dst, ptrdiff_t stride,
+;                       const uint8_t *left, const uint8_t *top)
+;-----------------------------------------------------------------------------
+
+; load top[-1] into all words of %1, using %2 as a temporary gpr
+%macro SPLAT_TOPLEFT 2
+    movzx                  %2d, byte [aq-1]
+    movd                  xm%1, %2d
+%if mmsize == 32
+    vpbroadcastw           m%1, xm%1
+%else
+    SPLATW                 m%1, m%1
+%endif
+%endmacro
+
+INIT_XMM ssse3
+cglobal vp9_ipred_tm_8x8, 4, 5, 7, dst, stride, l, a, tmp
+    pxor                    m1, m1
+    movq                    m0, [aq]
+    SPLAT_TOPLEFT            2, tmp
+    punpcklbw               m0, m1
+    psubw                   m0, m2              ; top - topleft
+    movq                    m3, [lq]
+    mova                    m5, [pb_7m1]
+    mova                    m6, [pw_m1]
+    DEFINE_ARGS dst, stride, l, a, cnt
+    mov                   cntd, 4
+.loop:
+    pshufb                  m1, m3, m5
+    paddw                   m5, m6
+    pshufb                  m2, m3, m5
+    paddw                   m5, m6
+    paddw                   m1, m0
+    paddw                   m2, m0
+    packuswb                m1, m2
+    movq      [dstq+strideq*0], m1
+    movhps    [dstq+strideq*1], m1
+    lea                   dstq, [dstq+strideq*2]
+    dec                   cntd
+    jg .loop
+    RET
+
+INIT_XMM ssse3
+cglobal vp9_ipred_tm_16x16, 4, 5, 8, dst, stride, l, a, tmp
+    pxor                    m3, m3
+    mova                    m0, [aq]
+    SPLAT_TOPLEFT            2, tmp
+    punpckhbw               m1, m0, m3
+    punpcklbw               m0, m3
+    psubw                   m0, m2
+    psubw                   m1, m2
+    mova                    m3, [lq]
+    mova                    m5, [pb_15m1]
+    mova                    m6, [pw_m1]
+    DEFINE_ARGS dst, stride, l, a, cnt
+    mov                   cntd, 16
+.loop:
+    pshufb                  m4, m3, m5
+    paddw                   m5, m6
+    paddw                   m2, m4, m1
+    paddw                   m4, m0
+    packuswb                m4, m2
+    mova                [dstq], m4
+    add                   dstq, strideq
+    dec                   cntd
+    jg .loop
+    RET
+
+; 16 rows, with m7 = left pixels (in both lanes for ymm)
+%macro TM_32_ROWS 0
+    mova                    m5, [pb_15m1]
+    mov                   cntd, 16
+%%loop:
+    pshufb                  m4, m7, m5
+    paddw                   m5, m6
+%if mmsize == 32
+    paddw                   m8, m4, m0
+    paddw                   m4, m1
+    packuswb                m8, m4
+    vpermq                  m8, m8, q3120
+    movu                [dstq], m8
+%else
+    paddw                   m8, m4, m0
+    paddw                   m9, m4, m1
+    packuswb                m8, m9
+    mova             [dstq+ 0], m8
+    paddw                   m8, m4, m2
+    paddw                   m4, m3
+    packuswb                m8, m4
+    mova             [dstq+16], m8
+%endif
+    add                   dstq, strideq
+    dec                   cntd
+    jg %%loop
+%endmacro
+
+%macro IPRED_TM_32 0
+cglobal vp9_ipred_tm_32x32, 4, 5, 10, dst, stride, l, a, tmp
+    pxor                    m4, m4
+    SPLAT_TOPLEFT            6, tmp
+%if mmsize == 32
+    pmovzxbw                m0, [aq]
+    pmovzxbw                m1, [aq+16]
+    psubw                   m0, m6
+    psubw                   m1, m6
+%else
+    mova                    m0, [aq]
+    mova                    m2, [aq+16]
+    punpckhbw               m1, m0, m4
+    punpcklbw               m0, m4
+    punpckhbw               m3, m2, m4
+    punpcklbw               m2, m4
+    psubw                   m0, m6
+    psubw                   m1, m6
+    psubw                   m2, m6
+    psubw                   m3, m6
+%endif
+    mova                    m6, [pw_m1]
+    DEFINE_ARGS dst, stride, l, a, cnt
+%if mmsize == 32
+    vbroadcasti128          m7, [lq+16]
+%else
+    mova                    m7, [lq+16]
+%endif
+    TM_32_ROWS
+%if mmsize == 32
+    vbroadcasti128          m7, [lq]
+%else
+    mova                    m7, [lq]
+%endif
+    TM_32_ROWS
+    RET
+%endmacro
+
+%if ARCH_X86_64
+INIT_XMM ssse3
+IPRED_TM_32
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+IPRED_TM_32
+%endif
+%endif
+
+INIT_MMX mmxext
+cglobal vp9_ipred_tm_4x4, 4, 5, 0, dst, stride, l, a, tmp
+    pxor                    m1, m1
+    movd                    m0, [aq]
+    movzx                 tmpd, byte [aq-1]
+    movd                    m2, tmpd
+    pshufw                  m2, m2, q0000
+    punpcklbw               m0, m1
+    psubw                   m0, m2              ; top - topleft
+    movd                    m3, [lq]
+    punpcklbw               m3, m1
+    pshufw                  m4, m3, q3333
+    pshufw                  m5, m3, q2222
+    paddw                   m4, m0
+    paddw                   m5, m0
+    packuswb                m4, m5
+    movd      [dstq+strideq*0], m4
+    psrlq                   m4, 32
+    movd      [dstq+strideq*1], m4
+    lea                   dstq, [dstq+strideq*2]
+    pshufw                  m4, m3, q1111
+    pshufw                  m5, m3, q0000
+    paddw                   m4, m0
+    paddw                   m5, m0
+    packuswb                m4, m5
+    movd      [dstq+strideq*0], m4
+    psrlq                   m4, 32
+    movd      [dstq+strideq*1], m4
+    RET
+
+;-----------------------------------------------------------------------------
+; void vp9_ipred_{dl,dr,vl,vr,hd,hu}_NxN(uint8_t *dst, ptrdiff_t stride,
+;                                       const uint8_t *left, const uint8_t *top)
+;-----------------------------------------------------------------------------
+
+; %1 = (%1 + 2 * %2 + %3 + 2) >> 2, using %4 as a temporary
+%macro LOWPASS 4
+    pxor                   m%4, m%1, m%3
+    pavgb                  m%1, m%3
+    pand                   m%4, [pb_1]
+    psubusb                m%1, m%4
+    pavgb                  m%1, m%2
+%endmacro
+
+; store %3 (and %4 at offset 16, for 32 pixel wide rows) with instruction %1
+; to row %2 of the current group of four rows; dstq moves on to the next
+; group after the last one
+%macro ROW_STORE 3-4
+%if %2 == 0
+    %1        [dstq+strideq*0], %3
+%if %0 == 4
+    %1     [dstq+strideq*0+16], %4
+%endif
+%elif %2 == 1
+    %1        [dstq+strideq*1], %3
+%if %0 == 4
+    %1     [dstq+strideq*1+16], %4
+%endif
+%elif %2 == 2
+    %1        [dstq+strideq*2], %3
+%if %0 == 4
+    %1     [dstq+strideq*2+16], %4
+%endif
+%else
+    %1        [dstq+stride3q ], %3
+%if %0 == 4
+    %1     [dstq+stride3q +16], %4
+%endif
+    lea                   dstq, [dstq+strideq*4]
+%endif
+%endmacro
+
+; load the edge left[0..3], top[-1..6] into m0 for the 4x4 predictors that
+; use both edges
+%macro LOAD_EDGE_4x4 0
+    movd                    m0, [lq]
+    movq                    m1, [aq-1]
+    pslldq                  m1, 4
+    por                     m0, m1
+%endmacro
+
+
+INIT_XMM ssse3
+cglobal vp9_ipred_dl_4x4, 4, 4, 4, dst, stride, l, a
+    movq                    m0, [aq]
+    pshufb                  m1, m0, [pb_1to7_9x7]
+    pshufb                  m2, m0, [pb_2to7_10x7]
+    pshufb                  m0, [pb_0to5_2x7]   ; the last pixel is not filtered
+    LOWPASS                  0, 1, 2, 3
+    DEFINE_ARGS dst, stride, stride3
+    lea               stride3q, [strideq*3]
+    movd      [dstq+strideq*0], m0
+    psrldq                  m0, 1
+    movd      [dstq+strideq*1], m0
+    psrldq                  m0, 1
+    movd      [dstq+strideq*2], m0
+    psrldq                  m0, 1
+    movd      [dstq+stride3q ], m0
+    RET
+
+cglobal vp9_ipred_dr_4x4, 4, 4, 4, dst, stride, l, a
+    LOAD_EDGE_4x4
+    psrldq                  m1, m0, 1
+    psrldq                  m2, m0, 2
+    LOWPASS                  0, 1, 2, 3
+    DEFINE_ARGS dst, stride, stride3
+    lea               stride3q, [strideq*3]
+    movd      [dstq+stride3q ], m0
+    psrldq                  m0, 1
+    movd      [dstq+strideq*2], m0
+    psrldq                  m0, 1
+    movd      [dstq+strideq*1], m0
+    psrldq                  m0, 1
+    movd      [dstq+strideq*0], m0
+    RET
+
+cglobal vp9_ipred_vl_4x4, 4, 4, 5, dst, stride, l, a
+    movq                    m0, [aq]
+    psrldq                  m1, m0, 1
+    psrldq                  m2, m0, 2
+    pavgb                   m4, m0, m1
+    LOWPASS                  0, 1, 2, 3
+    DEFINE_ARGS dst, stride, stride3
+    lea               stride3q, [strideq*3]
+    movd      [dstq+strideq*0], m4
+    movd      [dstq+strideq*1], m0
+    psrldq                  m4, 1
+    psrldq                  m0, 1
+    movd      [dstq+strideq*2], m4
+    movd      [dstq+stride3q ], m0
+    RET
+
+cglobal vp9_ipred_vr_4x4, 4, 4, 6, dst, stride, l, a
+    LOAD_EDGE_4x4
+    psrldq                  m1, m0, 3
+    psrldq                  m2, m0, 4
+    psrldq                  m3, m0, 5
+    pavgb                   m4, m2, m3          ; row 0
+    LOWPASS                  1, 2, 3, 5         ; row 1
+    psrldq                  m2, m0, 1
+    psrldq                  m3, m0, 2
+    LOWPASS                  0, 2, 3, 5         ; filtered left edge
+    mova                    m5, [pb_8x80_even]
+    pslldq                  m2, m0, 12
+    pslldq                  m0, 13
+    pshufb                  m2, m5
+    pshufb                  m0, m5
+    DEFINE_ARGS dst, stride, stride3
+    lea               stride3q, [strideq*3]
+    movd      [dstq+strideq*0], m4
+    movd      [dstq+strideq*1], m1
+    palignr                 m4, m2, 15
+    palignr                 m1, m0, 15
+    movd      [dstq+strideq*2], m4
+    movd      [dstq+stride3q ], m1
+    RET
+
+cglobal vp9_ipred_hd_4x4, 4, 4, 5, dst, stride, l, a
+    LOAD_EDGE_4x4
+    psrldq                  m1, m0, 1
+    psrldq                  m2, m0, 2
+    pavgb                   m3, m0, m1
+    LOWPASS                  0, 1, 2, 4
+    punpcklbw               m3, m0
+    psrldq                  m0, 4
+    punpcklqdq              m3, m0
+    DEFINE_ARGS dst, stride, stride3
+    lea               stride3q, [strideq*3]
+    movd      [dstq+stride3q ], m3
+    psrldq                  m3, 2
+    movd      [dstq+strideq*2], m3
+    psrldq                  m3, 2
+    movd      [dstq+strideq*1], m3
+    psrldq                  m3, 2
+    movd      [dstq+strideq*0], m3
+    RET
+
+cglobal vp9_ipred_hu_4x4, 3, 3, 5, dst, stride, l
+    movd                    m0, [lq]
+    pshufb                  m1, m0, [pb_2to0_13x0]
+    pshufb                  m2, m0, [pb_1to0_14x0]
+    pshufb                  m0, [pb_3to0_12x0]
+    pavgb                   m3, m0, m1
+    LOWPASS                  0, 1, 2, 4
+    punpcklbw               m3, m0
+    DEFINE_ARGS dst, stride, stride3
+    lea               stride3q, [strideq*3]
+    movd      [dstq+strideq*0], m3
+    psrldq                  m3, 2
+    movd      [dstq+strideq*1], m3
+    psrldq                  m3, 2
+    movd      [dstq+strideq*2], m3
+    psrldq                  m3, 2
+    movd      [dstq+stride3q ], m3
+    RET
+
+; load the edge left[0..7], top[-1..6] into m0 and top[7] into the low byte
+; of m2 for the 8x8 predictors that use both edges
+%macro LOAD_EDGE_8x8 0
+    movq                    m0, [lq]
+    movq                    m1, [aq-1]
+    movq                    m2, [aq]
+    psrldq                  m2, 7
+    punpcklqdq              m0, m1
+%endmacro
+
+%macro IPRED_DIR_8x8 0
+cglobal vp9_ipred_dl_8x8, 4, 4, 4, dst, stride, l, a
+    movq                    m0, [aq]
+    pshufb                  m1, m0, [pb_1to7_9x7]
+    pshufb                  m2, m0, [pb_2to7_10x7]
+    pshufb                  m0, [pb_0to7_8x7]
+    LOWPASS                  0, 1, 2, 3
+    DEFINE_ARGS dst, stride, stride3
+    lea               stride3q, [strideq*3]
+%assign %%i 0
+%rep 8
+    psrldq                  m1, m0, %%i
+    ROW_STORE             movq, %%i % 4, m1
+%assign %%i %%i+1
+%endrep
+    RET
+
+cglobal vp9_ipred_dr_8x8, 4, 4, 4, dst, stride, l, a
+    LOAD_EDGE_8x8
+    palignr                 m1, m2, m0, 1
+    palignr                 m2, m0, 2
+    LOWPASS                  0, 1, 2, 3
+    DEFINE_ARGS dst, stride, stride3
+    lea               stride3q, [strideq*3]
+%assign %%i 0
+%rep 8
+    psrldq                  m1, m0, 7-%%i
+    ROW_STORE             movq, %%i % 4, m1
+%assign %%i %%i+1
+%endrep
+    RET
+
+cglobal vp9_ipred_vl_8x8, 4, 4, 5, dst, stride, l, a
+    movq                    m0, [aq]
+    pshufb                  m1, m0, [pb_1to7_9x7]
+    pshufb                  m2, m0, [pb_2to7_10x7]
+    pshufb                  m0, [pb_0to7_8x7]
+    pavgb                   m4, m0, m1
+    LOWPASS                  0, 1, 2, 3
+    DEFINE_ARGS dst, stride, stride3
+    lea               stride3q, [strideq*3]
+%assign %%i 0
+%rep 4
+    psrldq                  m1, m4, %%i
+    psrldq                  m2, m0, %%i
+    ROW_STORE             movq, (%%i*2) % 4, m1
+    ROW_STORE             movq, (%%i*2+1) % 4, m2
+%assign %%i %%i+1
+%endrep
+    RET
+
+cglobal vp9_ipred_vr_8x8, 4, 4, 6, dst, stride, l, a
+    movq                    m0, [lq]
+    movq                    m1, [aq-1]
+    movq                    m2, [aq]
+    pavgb                   m3, m1, m2          ; row 0
+    pslldq                  m4, m0, 8
+    palignr                 m5, m1, m4, 15
+    LOWPASS                  5, 1, 2, 4         ; row 1
+    punpcklqdq              m0, m1
+    psrldq                  m1, m0, 1
+    psrldq                  m2, m0, 2
+    LOWPASS                  0, 1, 2, 4         ; filtered left edge
+    mova                    m2, [pb_8x80_even]
+    pslldq                  m1, m0, 8
+    pslldq                  m0, 9
+    pshufb                  m1, m2
+    pshufb                  m0, m2
+    DEFINE_ARGS dst, stride, stride3
+    lea               stride3q, [strideq*3]
+%assign %%i 0
+%rep 4
+    ROW_STORE             movq, (%%i*2) % 4, m3
+    ROW_STORE             movq, (%%i*2+1) % 4, m5
+%if %%i < 3
+    palignr                 m3, m1, 15
+    palignr                 m5, m0, 15
+    pslldq                  m1, 1
+    pslldq                  m0, 1
+%endif
+%assign %%i %%i+1
+%endrep
+    RET
+
+cglobal vp9_ipred_hd_8x8, 4, 4, 5, dst, stride, l, a
+    LOAD_EDGE_8x8
+    palignr                 m1, m2, m0, 1
+    palignr                 m2, m0, 2
+    pavgb                   m3, m0, m1
+    LOWPASS                  0, 1, 2, 4
+    punpcklbw               m1, m3, m0
+    psrldq                  m0, 8
+    DEFINE_ARGS dst, stride, stride3
+    lea               stride3q, [strideq*3]
+%assign %%i 0
+%rep 8
+    palignr                 m2, m0, m1, 14-%%i*2
+    ROW_STORE             movq, %%i % 4, m2
+%assign %%i %%i+1
+%endrep
+    RET
+
+cglobal vp9_ipred_hu_8x8, 3, 3, 5, dst, stride, l
+    movq                    m0, [lq]
+    pshufb                  m1, m0, [pb_6to0_9x0]
+    pshufb                  m2, m0, [pb_5to0_10x0]
+    pshufb                  m0, [pb_7to0_8x0]
+    pavgb                   m3, m0, m1
+    LOWPASS                  0, 1, 2, 4
+    punpckhbw               m1, m3, m0
+    punpcklbw               m3, m0
+    DEFINE_ARGS dst, stride, stride3
+    lea               stride3q, [strideq*3]
+%assign %%i 0
+%rep 8
+    palignr                 m2, m1, m3, %%i*2
+    ROW_STORE             movq, %%i % 4, m2
+%assign %%i %%i+1
+%endrep
+    RET
+%endmacro
+
+%macro IPRED_DIR_16x16 0
+cglobal vp9_ipred_dl_16x16, 4, 4, 6, dst, stride, l, a
+    mova                    m0, [aq]
+    pshufb                  m5, m0, [pb_15]
+    palignr                 m1, m5, m0, 1
+    palignr                 m2, m5, m0, 2
+    LOWPASS                  0, 1, 2, 3
+    DEFINE_ARGS dst, stride, cnt
+    mov                   cntd, 8
+.loop:
+    mova      [dstq+strideq*0], m0
+    palignr                 m1, m5, m0, 1
+    mova      [dstq+strideq*1], m1
+    palignr                 m0, m5, m1, 1
+    lea                   dstq, [dstq+strideq*2]
+    dec                   cntd
+    jg .loop
+    RET
+
+cglobal vp9_ipred_dr_16x16, 4, 4, 6, dst, stride, l, a
+    mova                    m0, [lq]
+    movu                    m1, [aq-1]
+    mova                    m2, [aq]
+    palignr                 m3, m1, m0, 1
+    palignr                 m4, m1, m0, 2
+    LOWPASS                  0, 3, 4, 5
+    psrldq                  m3, m2, 1
+    LOWPASS                  1, 2, 3, 4
+    DEFINE_ARGS dst, stride, stride3
+    lea               stride3q, [strideq*3]
+%assign %%i 0
+%rep 16
+    palignr                 m2, m1, m0, 15-%%i
+    ROW_STORE             mova, %%i % 4, m2
+%assign %%i %%i+1
+%endrep
+    RET
+
+cglobal vp9_ipred_vl_16x16, 4, 5, 6, dst, stride, l, a
+    mova                    m0, [aq]
+    pshufb                  m5, m0, [pb_15]
+    palignr                 m1, m5, m0, 1
+    palignr                 m2, m5, m0, 2
+    pavgb                   m4, m0, m1
+    LOWPASS                  0, 1, 2, 3
+    DEFINE_ARGS dst, stride, stride3, cnt
+    lea               stride3q, [strideq*3]
+    mov                   cntd, 4
+.loop:
+    palignr                 m1, m5, m4, 1
+    palignr                 m2, m5, m0, 1
+    mova      [dstq+strideq*0], m4
+    mova      [dstq+strideq*1], m0
+    mova      [dstq+strideq*2], m1
+    mova      [dstq+stride3q ], m2
+    palignr                 m4, m5, m1, 1
+    palignr                 m0, m5, m2, 1
+    lea                   dstq, [dstq+strideq*4]
+    dec                   cntd
+    jg .loop
+    RET
+
+cglobal vp9_ipred_vr_16x16, 4, 5, 6, dst, stride, l, a
+    mova                    m0, [lq]
+    movu                    m1, [aq-1]
+    mova                    m2, [aq]
+    pavgb                   m3, m1, m2          ; row 0
+    palignr                 m4, m1, m0, 15
+    LOWPASS                  4, 1, 2, 5         ; row 1
+    palignr                 m2, m1, m0, 1
+    palignr                 m1, m0, 2
+    LOWPASS                  0, 2, 1, 5         ; filtered left edge
+    mova                    m2, [pb_8x80_even]
+    pslldq                  m1, m0, 1
+    pshufb                  m0, m2
+    pshufb                  m1, m2
+    DEFINE_ARGS dst, stride, stride3, cnt
+    lea               stride3q, [strideq*3]
+    mov                   cntd, 4
+.loop:
+    mova      [dstq+strideq*0], m3
+    mova      [dstq+strideq*1], m4
+    palignr                 m3, m0, 15
+    palignr                 m4, m1, 15
+    pslldq                  m0, 1
+    pslldq                  m1, 1
+    mova      [dstq+strideq*2], m3
+    mova      [dstq+stride3q ], m4
+    palignr                 m3, m0, 15
+    palignr                 m4, m1, 15
+    pslldq                  m0, 1
+    pslldq                  m1, 1
+    lea                   dstq, [dstq+strideq*4]
+    dec                   cntd
+    jg .loop
+    RET
+
+cglobal vp9_ipred_hd_16x16, 4, 4, 7, dst, stride, l, a
+    mova                    m0, [lq]
+    movu                    m1, [aq-1]
+    mova                    m2, [aq]
+    palignr                 m3, m1, m0, 1
+    palignr                 m4, m1, m0, 2
+    pavgb                   m5, m0, m3
+    LOWPASS                  0, 3, 4, 6
+    psrldq                  m3, m2, 1
+    LOWPASS                  1, 2, 3, 4         ; filtered top edge
+    punpckhbw               m2, m5, m0
+    punpcklbw               m5, m0
+    DEFINE_ARGS dst, stride, stride3
+    lea               stride3q, [strideq*3]
+%assign %%i 0
+%rep 8
+    palignr                 m3, m1, m2, 14-%%i*2
+    ROW_STORE             mova, %%i % 4, m3
+%assign %%i %%i+1
+%endrep
+%assign %%i 0
+%rep 8
+    palignr                 m3, m2, m5, 14-%%i*2
+    ROW_STORE             mova, %%i % 4, m3
+%assign %%i %%i+1
+%endrep
+    RET
+
+cglobal vp9_ipred_hu_16x16, 3, 3, 6, dst, stride, l
+    mova                    m0, [lq]
+    pxor                    m1, m1
+    pshufb                  m5, m0, m1          ; left[0]
+    pshufb                  m0, [pb_15to0]
+    palignr                 m1, m5, m0, 1
+    palignr                 m2, m5, m0, 2
+    pavgb                   m3, m0, m1
+    LOWPASS                  0, 1, 2, 4
+    punpckhbw               m1, m3, m0
+    punpcklbw               m3, m0
+    DEFINE_ARGS dst, stride, stride3
+    lea               stride3q, [strideq*3]
+%assign %%i 0
+%rep 8
+    palignr                 m2, m1, m3, %%i*2
+    ROW_STORE             mova, %%i % 4, m2
+%assign %%i %%i+1
+%endrep
+%assign %%i 0
+%rep 8
+    palignr                 m2, m5, m1, %%i*2
+    ROW_STORE             mova, %%i % 4, m2
+%assign %%i %%i+1
+%endrep
+    RET
+%endmacro
+
+; %4 rows of 32 pixels; row i is made of the bytes %5+%6*i onwards of the
+; concatenation m%1:m%2:m%3 (low to high)
+%macro ROWS_32 6
+%assign %%i 0
+%rep %4
+    palignr                m14, m%2, m%1, %5+%6*%%i
+    palignr                m15, m%3, m%2, %5+%6*%%i
+    ROW_STORE             mova, %%i % 4, m14, m15
+%assign %%i %%i+1
+%endrep
+%endmacro
+
+%macro IPRED_DIR_32x32 0
+cglobal vp9_ipred_dl_32x32, 4, 5, 6, dst, stride, l, a
+    mova                    m0, [aq]
+    mova                    m1, [aq+16]
+    pshufb                  m5, m1, [pb_15]
+    palignr                 m2, m1, m0, 1
+    palignr                 m3, m1, m0, 2
+    LOWPASS                  0, 2, 3, 4
+    palignr                 m2, m5, m1, 1
+    palignr                 m3, m5, m1, 2
+    LOWPASS                  1, 2, 3, 4
+    DEFINE_ARGS dst, stride, l, a, cnt
+    mov                   cntd, 16
+.loop:
+    mova      [dstq+strideq*0+ 0], m0
+    mova      [dstq+strideq*0+16], m1
+    palignr                 m2, m1, m0, 1
+    palignr                 m3, m5, m1, 1
+    mova      [dstq+strideq*1+ 0], m2
+    mova      [dstq+strideq*1+16], m3
+    palignr                 m0, m3, m2, 1
+    palignr                 m1, m5, m3, 1
+    lea                   dstq, [dstq+strideq*2]
+    dec                   cntd
+    jg .loop
+    RET
+
+%if ARCH_X86_64
+cglobal vp9_ipred_dr_32x32, 4, 4, 16, dst, stride, l, a
+    mova                    m0, [lq]
+    mova                    m1, [lq+16]
+    movu                    m2, [aq-1]
+    movu                    m3, [aq+15]
+    mova                    m4, [aq]
+    mova                    m5, [aq+16]
+    palignr                 m6, m1, m0, 1
+    palignr                 m7, m1, m0, 2
+    palignr                 m8, m2, m1, 1
+    palignr                 m9, m2, m1, 2
+    palignr                m10, m5, m4, 1
+    psrldq                 m11, m5, 1
+    LOWPASS                  0, 6, 7, 12
+    LOWPASS                  1, 8, 9, 12
+    LOWPASS                  2, 4, 10, 12
+    LOWPASS                  3, 5, 11, 12
+    DEFINE_ARGS dst, stride, stride3
+    lea               stride3q, [strideq*3]
+    ROWS_32                  1, 2, 3, 16, 15, -1
+    ROWS_32                  0, 1, 2, 16, 15, -1
+    RET
+
+cglobal vp9_ipred_vl_32x32, 4, 5, 9, dst, stride, l, a
+    mova                    m2, [aq]
+    mova                    m3, [aq+16]
+    pshufb                  m7, m3, [pb_15]
+    palignr                 m4, m3, m2, 1
+    palignr                 m5, m3, m2, 2
+    pavgb                   m0, m2, m4          ; even rows
+    LOWPASS                  2, 4, 5, 6         ; odd rows
+    palignr                 m4, m7, m3, 1
+    palignr                 m5, m7, m3, 2
+    pavgb                   m1, m3, m4
+    LOWPASS                  3, 4, 5, 6
+    DEFINE_ARGS dst, stride, stride3, cnt
+    lea               stride3q, [strideq*3]
+    mov                   cntd, 8
+.loop:
+    palignr                 m4, m1, m0, 1
+    palignr                 m5, m7, m1, 1
+    palignr                 m6, m3, m2, 1
+    palignr                 m8, m7, m3, 1
+    mova   [dstq+strideq*0+ 0], m0
+    mova   [dstq+strideq*0+16], m1
+    mova   [dstq+strideq*1+ 0], m2
+    mova   [dstq+strideq*1+16], m3
+    mova   [dstq+strideq*2+ 0], m4
+    mova   [dstq+strideq*2+16], m5
+    mova   [dstq+stride3q + 0], m6
+    mova   [dstq+stride3q +16], m8
+    palignr                 m0, m5, m4, 1
+    palignr                 m1, m7, m5, 1
+    palignr                 m2, m8, m6, 1
+    palignr                 m3, m7, m8, 1
+    lea                   dstq, [dstq+strideq*4]
+    dec                   cntd
+    jg .loop
+    RET
+
+cglobal vp9_ipred_vr_32x32, 4, 5, 12, dst, stride, l, a
+    mova                    m0, [lq]
+    mova                    m1, [lq+16]
+    movu                    m2, [aq-1]
+    movu                    m3, [aq+15]
+    mova                    m4, [aq]
+    mova                    m5, [aq+16]
+    pavgb                   m6, m2, m4          ; row 0
+    pavgb                   m7, m3, m5
+    palignr                 m8, m2, m1, 15      ; row 1
+    LOWPASS                  8, 2, 4, 9
+    palignr                m10, m3, m2, 15
+    LOWPASS                 10, 3, 5, 9
+    palignr                 m4, m2, m1, 1       ; filtered left edge
+    palignr                 m5, m2, m1, 2
+    palignr                 m3, m1, m0, 1
+    palignr                m11, m1, m0, 2
+    LOWPASS                  0, 3, 11, 9
+    LOWPASS                  1, 4, 5, 9
+    mova                    m9, [pb_8x80_even]
+    palignr                 m2, m1, m0, 15
+    pslldq                  m3, m0, 1
+    pshufb                  m0, m9
+    pshufb                  m1, m9
+    punpckhqdq              m0, m1              ; even rows
+    pshufb                  m3, m9
+    pshufb                  m2, m9
+    punpckhqdq              m3, m2              ; odd rows
+    DEFINE_ARGS dst, stride, l, a, cnt
+    mov                   cntd, 16
+.loop:
+    mova   [dstq+strideq*0+ 0], m6
+    mova   [dstq+strideq*0+16], m7
+    mova   [dstq+strideq*1+ 0], m8
+    mova   [dstq+strideq*1+16], m10
+    palignr                 m7, m6, 15
+    palignr                 m6, m0, 15
+    palignr                m10, m8, 15
+    palignr                 m8, m3, 15
+    pslldq                  m0, 1
+    pslldq                  m3, 1
+    lea                   dstq, [dstq+strideq*2]
+    dec                   cntd
+    jg .loop
+    RET
+
+cglobal vp9_ipred_hd_32x32, 4, 4, 16, dst, stride, l, a
+    mova                    m0, [lq]
+    mova                    m1, [lq+16]
+    movu                    m2, [aq-1]
+    movu                    m3, [aq+15]
+    mova                    m4, [aq]
+    mova                    m5, [aq+16]
+    palignr                 m6, m2, m1, 1
+    palignr                 m7, m2, m1, 2
+    palignr                 m8, m1, m0, 1
+    palignr                 m9, m1, m0, 2
+    pavgb                  m10, m0, m8
+    pavgb                  m11, m1, m6
+    LOWPASS                  0, 8, 9, 12
+    LOWPASS                  1, 6, 7, 12
+    palignr                 m6, m5, m4, 1       ; filtered top edge
+    LOWPASS                  2, 4, 6, 12
+    psrldq                  m6, m5, 1
+    LOWPASS                  3, 5, 6, 12
+    punpcklbw               m4, m10, m0
+    punpckhbw              m10, m0
+    punpcklbw               m5, m11, m1
+    punpckhbw              m11, m1
+    DEFINE_ARGS dst, stride, stride3
+    lea               stride3q, [strideq*3]
+    ROWS_32                 11, 2, 3, 8, 14, -2
+    ROWS_32                  5, 11, 2, 8, 14, -2
+    ROWS_32                 10, 5, 11, 8, 14, -2
+    ROWS_32                  4, 10, 5, 8, 14, -2
+    RET
+
+cglobal vp9_ipred_hu_32x32, 3, 3, 16, dst, stride, l
+    mova                    m0, [lq]
+    mova                    m1, [lq+16]
+    pxor                    m2, m2
+    pshufb                  m6, m0, m2          ; left[0]
+    mova                    m2, [pb_15to0]
+    pshufb                  m1, m2
+    pshufb                  m0, m2
+    palignr                 m2, m0, m1, 1
+    palignr                 m3, m0, m1, 2
+    palignr                 m4, m6, m0, 1
+    palignr                 m5, m6, m0, 2
+    pavgb                   m7, m1, m2
+    pavgb                   m8, m0, m4
+    LOWPASS                  1, 2, 3, 9
+    LOWPASS                  0, 4, 5, 9
+    punpcklbw               m2, m7, m1
+    punpckhbw               m7, m1
+    punpcklbw               m3, m8, m0
+    punpckhbw               m8, m0
+    DEFINE_ARGS dst, stride, stride3
+    lea               stride3q, [strideq*3]
+    ROWS_32                  2, 7, 3, 8, 0, 2
+    ROWS_32                  7, 3, 8, 8, 0, 2
+    ROWS_32                  3, 8, 6, 8, 0, 2
+    ROWS_32                  8, 6, 6, 8, 0, 2
+    RET
+%endif
+%endmacro
+
+INIT_XMM ssse3
+IPRED_DIR_8x8
+IPRED_DIR_16x16
+IPRED_DIR_32x32
+INIT_XMM avx
+IPRED_DIR_8x8
+IPRED_DIR_16x16
+IPRED_DIR_32x32
@@ -23,22 +23,22 @@
  * @file
  * Audio Mix Filter
  *
- * Mixes audio from multiple sources into a single output. The channel layout,
- * sample rate, and sample format will be the same for all inputs and the
- * output.
+ * Mixes audio from multiple sources into a single output. The channel layout
+ * and sample rate will be the same for all inputs and the output. The inputs
+ * may be float, int16 or int32, packed or planar, the output is float.
  */
 
 #include "libavutil/attributes.h"
-#include "libavutil/audio_fifo.h"
 #include "libavutil/avassert.h"
 #include "libavutil/avstring.h"
 #include "libavutil/channel_layout.h"
 #include "libavutil/common.h"
-#include "libavutil/float_dsp.h"
+#include "libavutil/fifo.h"
 #include "libavutil/mathematics.h"
 #include "libavutil/opt.h"
 #include "libavutil/samplefmt.h"
 
+#include "af_amix.h"
 #include "audio.h"
 #include "avfilter.h"
 #include "formats.h"
@@ -52,6 +52,11 @@
 #define DURATION_SHORTEST 1
 #define DURATION_FIRST    2
 
+/**
+ * Maximum number of samples per channel mixed in one pass over the inputs,
+ * small enough for the output block to stay in the L1 cache.
+ */
+#define MIX_BLOCK_SIZE 256
 
 typedef struct FrameInfo {
     int nb_samples;
@@ -152,10 +157,66 @@ static int frame_list_add_frame(FrameList *frame_list, int nb_samples, int64_t p
     return 0;
 }
 
+/**
+ * Frames received on an input and not mixed yet. The samples are mixed
+ * directly from the frames, without copying them to a FIFO first.
+ */
+typedef struct InputQueue {
+    AVFifoBuffer *frames;       /**< queued AVFrame pointers */
+    int offset;                 /**< samples already mixed from the first frame */
+    int nb_samples;             /**< number of samples available */
+} InputQueue;
+
+static int input_queue_add_frame(InputQueue *queue, AVFrame *frame)
+{
+    if (av_fifo_space(queue->frames) < sizeof(frame)) {
+        int ret = av_fifo_grow(queue->frames, sizeof(frame));
+        if (ret < 0)
+            return ret;
+    }
+    av_fifo_generic_write(queue->frames, &frame, sizeof(frame), NULL);
+    queue->nb_samples += frame->nb_samples;
+
+    return 0;
+}
+
+static AVFrame *input_queue_peek(InputQueue *queue)
+{
+    if (!av_fifo_size(queue->frames))
+        return NULL;
+    return *(AVFrame **)av_fifo_peek2(queue->frames, 0);
+}
+
+static void input_queue_remove_samples(InputQueue *queue, int nb_samples)
+{
+    AVFrame *frame;
+
+    while (nb_samples > 0 && (frame = input_queue_peek(queue))) {
+        int n = FFMIN(nb_samples, frame->nb_samples - queue->offset);
+
+        queue->offset     += n;
+        queue->nb_samples -= n;
+        nb_samples        -= n;
+        if (queue->offset == frame->nb_samples) {
+            av_fifo_drain(queue->frames, sizeof(frame));
+            av_frame_free(&frame);
+            queue->offset = 0;
+        }
+    }
+}
+
+static void input_queue_free(InputQueue *queue)
+{
+    if (queue->frames) {
+        input_queue_remove_samples(queue, queue->nb_samples);
+        av_fifo_free(queue->frames);
+        queue->frames = NULL;
+    }
+}
 
 typedef struct MixContext {
     const AVClass *class;       /**< class for AVOptions */
-    AVFloatDSPContext fdsp;
+    AMixDSPContext dsp;
 
     int nb_inputs;              /**< number of inputs */
     int active_inputs;          /**< number of input currently active */
@@ -165,7 +226,8 @@ typedef struct MixContext {
     int nb_channels;            /**< number of channels */
     int sample_rate;            /**< sample rate */
     int planar;
-    AVAudioFifo **fifos;        /**< audio fifo for each input */
+    InputQueue *queues;         /**< queued frames for each input */
+    float *conv_buf;            /**< input samples converted to the output format */
     uint8_t *input_state;       /**< current state of each input */
     float *input_scale;         /**< mixing scale factor for each input */
     float scale_norm;           /**< normalization factor for all inputs */
@@ -178,7 +240,7 @@ typedef struct MixContext {
 #define F AV_OPT_FLAG_FILTERING_PARAM
 static const AVOption amix_options[] = {
     { "inputs", "Number of inputs.",
-            OFFSET(nb_inputs), AV_OPT_TYPE_INT, { .i64 = 2 }, 1, 32, A|F },
+            OFFSET(nb_inputs), AV_OPT_TYPE_INT, { .i64 = 2 }, 1, 1024, A|F },
     { "duration", "How to determine the end-of-stream.",
             OFFSET(duration_mode), AV_OPT_TYPE_INT, { .i64 = DURATION_LONGEST }, 0,  2, A|F, "duration" },
         { "longest",  "Duration of longest input.",  0, AV_OPT_TYPE_CONST, { .i64 = DURATION_LONGEST  }, INT_MIN, INT_MAX, A|F, "duration" },
@@ -232,17 +294,21 @@ static int config_output(AVFilterLink *outlink)
     if (!s->frame_list)
         return AVERROR(ENOMEM);
 
-    s->fifos = av_mallocz(s->nb_inputs * sizeof(*s->fifos));
-    if (!s->fifos)
+    s->queues = av_mallocz(s->nb_inputs * sizeof(*s->queues));
+    if (!s->queues)
         return AVERROR(ENOMEM);
 
     s->nb_channels = av_get_channel_layout_nb_channels(outlink->channel_layout);
     for (i = 0; i < s->nb_inputs; i++) {
-        s->fifos[i] = av_audio_fifo_alloc(outlink->format, s->nb_channels, 1024);
-        if (!s->fifos[i])
+        s->queues[i].frames = av_fifo_alloc(8 * sizeof(AVFrame *));
+        if (!s->queues[i].frames)
             return AVERROR(ENOMEM);
     }
 
+    s->conv_buf = av_malloc(4 * MIX_BLOCK_SIZE * s->nb_channels * sizeof(*s->conv_buf));
+    if (!s->conv_buf)
+        return AVERROR(ENOMEM);
+
     s->input_state = av_malloc(s->nb_inputs);
     if (!s->input_state)
         return AVERROR(ENOMEM);
@@ -264,15 +330,120 @@ static int config_output(AVFilterLink *outlink)
     return 0;
 }
 
+static void mix_4_float_c(float *dst, const float **src, const float *scale,
+                          int len)
+{
+    const float *src0 = src[0], *src1 = src[1], *src2 = src[2], *src3 = src[3];
+    const float scale0 = scale[0], scale1 = scale[1], scale2 = scale[2], scale3 = scale[3];
+    int i;
+
+    for (i = 0; i < len; i++) {
+        float v = dst[i];
+        v += src0[i] * scale0;
+        v += src1[i] * scale1;
+        v += src2[i] * scale2;
+        v += src3[i] * scale3;
+        dst[i] = v;
+    }
+}
+
+static void mix_float(MixContext *s, float *dst, const float **src,
+                      const float *scale, int nb_src, int len)
+{
+    int i, j;
+
+    if (nb_src == 4) {
+        int len4 = len & ~3;
+
+        if (len4)
+            s->dsp.mix_4_float(dst, src, scale, len4);
+        for (i = 0; i < 4; i++)
+            for (j = len4; j < len; j++)
+                dst[j] += src[i][j] * scale[i];
+        return;
+    }
+    for (i = 0; i < nb_src; i++)
+        for (j = 0; j < len; j++)
+            dst[j] += src[i][j] * scale[i];
+}
+
+#define CONVERT(type, expr)                                                 \
+    for (c = 0; c < s->nb_channels; c++) {                                  \
+        const type *src = in_planar ? (const type *)frame->extended_data[c] + offset : \
+                                      (const type *)frame->data[0] + offset * s->nb_channels + c; \
+        float *dst = s->planar ? buf + c * MIX_BLOCK_SIZE : buf + c;         \
+        for (i = 0; i < len; i++) {                                         \
+            *dst = expr;                                                    \
+            src += src_step;                                                \
+            dst += dst_step;                                                \
+        }                                                                   \
+    }
+
+/**
+ * Convert len samples of frame, starting at offset, to the output sample
+ * format, using the same conversions as libswresample.
+ */
+static void convert_samples(MixContext *s, float *buf, const AVFrame *frame,
+                            int offset, int len)
+{
+    const int in_planar = av_sample_fmt_is_planar(frame->format);
+    const int src_step  = in_planar ? 1 : s->nb_channels;
+    const int dst_step  = s->planar ? 1 : s->nb_channels;
+    int c, i;
+
+    switch (av_get_packed_sample_fmt(frame->format)) {
+    case AV_SAMPLE_FMT_S16: CONVERT(int16_t, *src * (1.0f / (1  << 15))); break;
+    case AV_SAMPLE_FMT_S32: CONVERT(int32_t, *src * (1.0f / (1U << 31))); break;
+    case AV_SAMPLE_FMT_FLT: CONVERT(float,   *src);                       break;
+    }
+}
+
 /**
- * Read samples from the input FIFOs, mix, and write to the output link.
+ * Add len samples of up to four inputs to the output frame, starting at
+ * position pos, in a single pass over each output plane. Inputs which are not
+ * in the output sample format are converted first.
+ */
+static void mix_inputs(MixContext *s, AVFrame *out, int pos, int len,
+                       AVFrame **frames, const int *offsets, const float *scale,
+                       int nb_src)
+{
+    const int planes     = s->planar ? s->nb_channels : 1;
+    const int plane_size = s->planar ? len : len * s->nb_channels;
+    const int out_offset = s->planar ? pos : pos * s->nb_channels;
+    const float *src[4];
+    int i, p;
+
+    for (i = 0; i < nb_src; i++)
+        if (frames[i]->format != out->format)
+            convert_samples(s, s->conv_buf + i * MIX_BLOCK_SIZE * s->nb_channels,
+                            frames[i], offsets[i], len);
+
+    for (p = 0; p < planes; p++) {
+        for (i = 0; i < nb_src; i++) {
+            if (frames[i]->format != out->format)
+                src[i] = s->conv_buf + i * MIX_BLOCK_SIZE * s->nb_channels +
+                         p * MIX_BLOCK_SIZE;
+            else
+                src[i] = (const float *)frames[i]->extended_data[p] +
+                         (s->planar ? offsets[i] : offsets[i] * s->nb_channels);
+        }
+        mix_float(s, (float *)out->extended_data[p] + out_offset, src, scale,
+                  nb_src, plane_size);
+    }
+}
+
+/**
+ * Read samples from the input queues, mix, and write to the output link.
  */
 static int output_frame(AVFilterLink *outlink, int nb_samples)
 {
     AVFilterContext *ctx = outlink->src;
     MixContext      *s = ctx->priv;
-    AVFrame *out_buf, *in_buf;
-    int i;
+    AVFrame *out_buf;
+    AVFrame *frames[4];
+    int offsets[4];
+    float scale[4];
+    int i, pos, len, nb_src;
 
     calculate_scales(s, nb_samples);
 
@@ -280,31 +451,36 @@ static int output_frame(AVFilterLink *outlink, int nb_samples)
     if (!out_buf)
         return AVERROR(ENOMEM);
 
-    in_buf = ff_get_audio_buffer(outlink, nb_samples);
-    if (!in_buf) {
-        av_frame_free(&out_buf);
-        return AVERROR(ENOMEM);
-    }
-
-    for (i = 0; i < s->nb_inputs; i++) {
-        if (s->input_state[i] == INPUT_ON) {
-            int planes, plane_size, p;
-
-            av_audio_fifo_read(s->fifos[i], (void **)in_buf->extended_data,
-                               nb_samples);
-
-            planes     = s->planar ? s->nb_channels : 1;
-            plane_size = nb_samples * (s->planar ? 1 : s->nb_channels);
-            plane_size = FFALIGN(plane_size, 16);
+    /* Mix block by block, so that the output block stays in the cache while
+     * all the inputs are added to it. A block does not cross a frame
+     * boundary on any input, so the input samples are read in place. */
+    for (pos = 0; pos < nb_samples; pos += len) {
+        len = FFMIN(nb_samples - pos, MIX_BLOCK_SIZE);
+        for (i = 0; i < s->nb_inputs; i++) {
+            AVFrame *frame = input_queue_peek(&s->queues[i]);
+            if (s->input_state[i] == INPUT_ON && frame)
+                len = FFMIN(len, frame->nb_samples - s->queues[i].offset);
+        }
 
-            for (p = 0; p < planes; p++) {
-                s->fdsp.vector_fmac_scalar((float *)out_buf->extended_data[p],
-                                           (float *) in_buf->extended_data[p],
-                                           s->input_scale[i], plane_size);
+        nb_src = 0;
+        for (i = 0; i < s->nb_inputs; i++) {
+            if (s->input_state[i] != INPUT_ON ||
+                !(frames[nb_src] = input_queue_peek(&s->queues[i])))
+                continue;
+            offsets[nb_src] = s->queues[i].offset;
+            scale[nb_src]   = s->input_scale[i];
+            if (++nb_src == 4) {
+                mix_inputs(s, out_buf, pos, len, frames, offsets, scale, nb_src);
+                nb_src = 0;
             }
         }
+        if (nb_src)
+            mix_inputs(s, out_buf, pos, len, frames, offsets, scale, nb_src);
+
+        for (i = 0; i < s->nb_inputs; i++)
+            if (s->input_state[i] == INPUT_ON)
+                input_queue_remove_samples(&s->queues[i], len);
     }
-    av_frame_free(&in_buf);
 
     out_buf->pts = s->next_pts;
     if (s->next_pts != AV_NOPTS_VALUE)
@@ -328,7 +504,7 @@ static int get_available_samples(MixContext *s)
         int nb_samples;
         if (s->input_state[i] == INPUT_OFF)
             continue;
-        nb_samples = av_audio_fifo_size(s->fifos[i]);
+        nb_samples = s->queues[i].nb_samples;
         available_samples = FFMIN(available_samples, nb_samples);
     }
     if (available_samples == INT_MAX)
@@ -350,10 +526,10 @@ static int request_samples(AVFilterContext *ctx, int min_samples)
         ret = 0;
         if (s->input_state[i] == INPUT_OFF)
             continue;
-        while (!ret && av_audio_fifo_size(s->fifos[i]) < min_samples)
+        while (!ret && s->queues[i].nb_samples < min_samples)
             ret = ff_request_frame(ctx->inputs[i]);
         if (ret == AVERROR_EOF) {
-            if (av_audio_fifo_size(s->fifos[i]) == 0) {
+            if (s->queues[i].nb_samples == 0) {
                 s->input_state[i] = INPUT_OFF;
                 continue;
             }
@@ -456,16 +632,11 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *buf)
     AVFilterContext  *ctx = inlink->dst;
     MixContext       *s = ctx->priv;
     AVFilterLink *outlink = ctx->outputs[0];
-    int i, ret = 0;
+    int i = FF_INLINK_IDX(inlink);
+    int ret = 0;
 
-    for (i = 0; i < ctx->nb_inputs; i++)
-        if (ctx->inputs[i] == inlink)
-            break;
-    if (i >= ctx->nb_inputs) {
-        av_log(ctx, AV_LOG_ERROR, "unknown input link\n");
-        ret = AVERROR(EINVAL);
+    if (!buf->nb_samples)
         goto fail;
-    }
 
     if (i == 0) {
         int64_t pts = av_rescale_q(buf->pts, inlink->time_base,
@@ -475,8 +646,11 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *buf)
             goto fail;
     }
 
-    ret = av_audio_fifo_write(s->fifos[i], (void **)buf->extended_data,
-                              buf->nb_samples);
+    ret = input_queue_add_frame(&s->queues[i], buf);
+    if (ret < 0)
+        goto fail;
+
+    return 0;
 
 fail:
     av_frame_free(&buf);
@@ -501,7 +675,9 @@ static av_cold int init(AVFilterContext *ctx)
         ff_insert_inpad(ctx, i, &pad);
     }
 
-    avpriv_float_dsp_init(&s->fdsp, 0);
+    s->dsp.mix_4_float = mix_4_float_c;
+    if (ARCH_X86)
+        ff_amix_init_x86(&s->dsp);
 
     return 0;
 }
@@ -511,11 +687,12 @@ static av_cold void uninit(AVFilterContext *ctx)
     int i;
     MixContext *s = ctx->priv;
 
-    if (s->fifos) {
+    if (s->queues) {
         for (i = 0; i < s->nb_inputs; i++)
-            av_audio_fifo_free(s->fifos[i]);
-        av_freep(&s->fifos);
+            input_queue_free(&s->queues[i]);
+        av_freep(&s->queues);
     }
+    av_freep(&s->conv_buf);
     frame_list_clear(s->frame_list);
     av_freep(&s->frame_list);
     av_freep(&s->input_state);
@@ -527,10 +704,30 @@ static av_cold void uninit(AVFilterContext *ctx)
 
 static int query_formats(AVFilterContext *ctx)
 {
-    AVFilterFormats *formats = NULL;
-    ff_add_format(&formats, AV_SAMPLE_FMT_FLT);
-    ff_add_format(&formats, AV_SAMPLE_FMT_FLTP);
-    ff_set_common_formats(ctx, formats);
+    static const enum AVSampleFormat in_sample_fmts[] = {
+        AV_SAMPLE_FMT_FLT, AV_SAMPLE_FMT_FLTP,
+        AV_SAMPLE_FMT_S16, AV_SAMPLE_FMT_S16P,
+        AV_SAMPLE_FMT_S32, AV_SAMPLE_FMT_S32P,
+        AV_SAMPLE_FMT_NONE
+    };
+    static const enum AVSampleFormat out_sample_fmts[] = {
+        AV_SAMPLE_FMT_FLT, AV_SAMPLE_FMT_FLTP,
+        AV_SAMPLE_FMT_NONE
+    };
+    AVFilterFormats *formats;
+    int i;
+
+    for (i = 0; i < ctx->nb_inputs; i++) {
+        formats = ff_make_format_list(in_sample_fmts);
+        if (!formats)
+            return AVERROR(ENOMEM);
+        ff_formats_ref(formats, &ctx->inputs[i]->out_formats);
+    }
+    formats = ff_make_format_list(out_sample_fmts);
+    if (!formats)
+        return AVERROR(ENOMEM);
+    ff_formats_ref(formats, &ctx->outputs[0]->in_formats);
+
     ff_set_common_channel_layouts(ctx, ff_all_channel_layouts());
     ff_set_common_samplerates(ctx, ff_all_samplerates());
     return 0;
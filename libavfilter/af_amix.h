@@ -0,0 +1,39 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_AF_AMIX_H
+#define AVFILTER_AF_AMIX_H
+
+typedef struct AMixDSPContext {
+    /**
+     * Add the samples of four inputs, multiplied by their scale factors, to
+     * dst. The products are added one input after the other, in order, so
+     * that the result does not depend on how many inputs are mixed at once.
+     *
+     * @param dst   mixed samples, not necessarily aligned
+     * @param src   samples of the four inputs, not necessarily aligned
+     * @param scale scale factor of each input
+     * @param len   number of samples, must be a positive multiple of 4
+     */
+    void (*mix_4_float)(float *dst, const float **src, const float *scale,
+                        int len);
+} AMixDSPContext;
+
+void ff_amix_init_x86(AMixDSPContext *dsp);
+
+#endif /* AVFILTER_AF_AMIX_H */
@@ -440,6 +440,13 @@ enum AVMediaType avfilter_pad_get_type(const AVFilterPad *pads, int pad_idx);
  * and processing them concurrently.
  */
 #define AVFILTER_FLAG_SLICE_THREADS         (1 << 2)
+/**
+ * The config_props() callbacks of the filter can be called again on a
+ * configured and running instance, as avfilter_graph_relink() does, and
+ * only update what depends on the link properties, keeping the filter
+ * state valid for the new properties.
+ */
+#define AVFILTER_FLAG_SUPPORT_RELINK        (1 << 3)
 /**
  * Some filters support a generic "enable" expression option that can be used
  * to enable or disable a filter in the timeline. Filters supporting this
@@ -860,6 +867,13 @@ struct AVFilterLink {
      * Number of past frames sent through the link.
      */
     int64_t frame_count;
+
+    /**
+     * A pointer to a FFVideoFramePool struct, used to allocate the frames
+     * of ff_default_get_video_buffer().
+     * Used internally by the framework.
+     */
+    void *video_frame_pool;
 };
 
 /**
@@ -1329,6 +1343,28 @@ enum {
  */
 int avfilter_graph_config(AVFilterGraph *graphctx, void *log_ctx);
 
+/**
+ * Configure again the links downstream of a filter in a configured graph,
+ * e.g. after the video size set on a buffer source changed.
+ *
+ * The output links of filter and all links after them are reconfigured by
+ * calling the config_props() callbacks of the filters involved. The formats
+ * negotiated for the links are kept and the filters are not reinitialized.
+ * Other links are left untouched.
+ *
+ * filter and all filters downstream of it must have
+ * AVFILTER_FLAG_SUPPORT_RELINK set, and the formats negotiated for the
+ * outputs of filter must still be supported by it, e.g. the pixel format of
+ * a buffer source must not have changed. The graph is left unchanged and
+ * AVERROR(ENOSYS) returned otherwise.
+ *
+ * @param graph  the filter graph
+ * @param filter the filter whose outputs changed
+ * @return >= 0 in case of success, a negative AVERROR code otherwise, in
+ *         which case the graph must be configured from scratch
+ */
+int avfilter_graph_relink(AVFilterGraph *graph, AVFilterContext *filter);
+
 /**
  * Free a graph, destroy its links, and set *graph to NULL.
  * If *graph is NULL, do nothing.
@@ -307,6 +307,29 @@ static void sanitize_channel_layouts(void *log, AVFilterChannelLayouts *l)
     }
 }
 
+static int formats_declared(AVFilterContext *f)
+{
+    int i;
+
+    for (i = 0; i < f->nb_inputs; i++) {
+        if (!f->inputs[i]->out_formats)
+            return 0;
+        if (f->inputs[i]->type == AVMEDIA_TYPE_AUDIO &&
+            !(f->inputs[i]->out_samplerates &&
+              f->inputs[i]->out_channel_layouts))
+            return 0;
+    }
+    for (i = 0; i < f->nb_outputs; i++) {
+        if (!f->outputs[i]->in_formats)
+            return 0;
+        if (f->outputs[i]->type == AVMEDIA_TYPE_AUDIO &&
+            !(f->outputs[i]->in_samplerates &&
+              f->outputs[i]->in_channel_layouts))
+            return 0;
+    }
+    return 1;
+}
+
 static int filter_query_formats(AVFilterContext *ctx)
 {
     int ret, i;
@@ -329,6 +352,10 @@ static int filter_query_formats(AVFilterContext *ctx)
     for (i = 0; i < ctx->nb_outputs; i++)
         sanitize_channel_layouts(ctx, ctx->outputs[i]->in_channel_layouts);
 
+    /* most filters set all their lists, do not build the defaults then */
+    if (formats_declared(ctx))
+        return 0;
+
     formats = ff_all_formats(type);
     if (!formats)
         return AVERROR(ENOMEM);
@@ -346,84 +373,6 @@ static int filter_query_formats(AVFilterContext *ctx)
     return 0;
 }
 
-static int formats_declared(AVFilterContext *f)
-{
-    int i;
-
-    for (i = 0; i < f->nb_inputs; i++) {
-        if (!f->inputs[i]->out_formats)
-            return 0;
-        if (f->inputs[i]->type == AVMEDIA_TYPE_AUDIO &&
-            !(f->inputs[i]->out_samplerates &&
-              f->inputs[i]->out_channel_layouts))
-            return 0;
-    }
-    for (i = 0; i < f->nb_outputs; i++) {
-        if (!f->outputs[i]->in_formats)
-            return 0;
-        if (f->outputs[i]->type == AVMEDIA_TYPE_AUDIO &&
-            !(f->outputs[i]->in_samplerates &&
-              f->outputs[i]->in_channel_layouts))
-            return 0;
-    }
-    return 1;
-}
-
-static AVFilterFormats *clone_filter_formats(AVFilterFormats *arg)
-{
-    AVFilterFormats *a = av_memdup(arg, sizeof(*arg));
-    if (a) {
-        a->refcount = 0;
-        a->refs     = NULL;
-        a->formats  = av_memdup(a->formats, sizeof(*a->formats) * a->nb_formats);
-        if (!a->formats && arg->formats)
-            av_freep(&a);
-    }
-    return a;
-}
-
-static int can_merge_formats(AVFilterFormats *a_arg,
-                             AVFilterFormats *b_arg,
-                             enum AVMediaType type,
-                             int is_sample_rate)
-{
-    AVFilterFormats *a, *b, *ret;
-    if (a_arg == b_arg)
-        return 1;
-    a = clone_filter_formats(a_arg);
-    b = clone_filter_formats(b_arg);
-
-    if (!a || !b) {
-        if (a)
-            av_freep(&a->formats);
-        if (b)
-            av_freep(&b->formats);
-
-        av_freep(&a);
-        av_freep(&b);
-
-        return 0;
-    }
-
-    if (is_sample_rate) {
-        ret = ff_merge_samplerates(a, b);
-    } else {
-        ret = ff_merge_formats(a, b, type);
-    }
-    if (ret) {
-        av_freep(&ret->formats);
-        av_freep(&ret->refs);
-        av_freep(&ret);
-        return 1;
-    } else {
-        av_freep(&a->formats);
-        av_freep(&b->formats);
-        av_freep(&a);
-        av_freep(&b);
-        return 0;
-    }
-}
-
 /**
  * Perform one round of query_formats() and merging formats lists on the
  * filter graph.
@@ -470,15 +419,14 @@ static int query_formats(AVFilterGraph *graph, AVClass *log_ctx)
 
             if (link->in_formats != link->out_formats
                 && link->in_formats && link->out_formats)
-                if (!can_merge_formats(link->in_formats, link->out_formats,
-                                      link->type, 0))
+                if (!ff_can_merge_formats(link->in_formats, link->out_formats,
+                                          link->type))
                     convert_needed = 1;
             if (link->type == AVMEDIA_TYPE_AUDIO) {
                 if (link->in_samplerates != link->out_samplerates
                     && link->in_samplerates && link->out_samplerates)
-                    if (!can_merge_formats(link->in_samplerates,
-                                           link->out_samplerates,
-                                           0, 1))
+                    if (!ff_can_merge_samplerates(link->in_samplerates,
+                                                  link->out_samplerates))
                         convert_needed = 1;
             }
 
@@ -1202,6 +1150,168 @@ int avfilter_graph_config(AVFilterGraph *graphctx, void *log_ctx)
     return 0;
 }
 
+/**
+ * Mark the output links of filter and all links downstream of them as not
+ * configured and clear the properties that are derived during configuration.
+ */
+static void reset_links_downstream(AVFilterContext *filter)
+{
+    int i;
+
+    for (i = 0; i < filter->nb_outputs; i++) {
+        AVFilterLink *link = filter->outputs[i];
+
+        if (!link || link->init_state == AVLINK_UNINIT)
+            continue;
+        link->init_state          = AVLINK_UNINIT;
+        link->time_base           = (AVRational){ 0, 0 };
+        if (link->type == AVMEDIA_TYPE_VIDEO) {
+            link->w                   = 0;
+            link->h                   = 0;
+            link->sample_aspect_ratio = (AVRational){ 0, 0 };
+            link->frame_rate          = (AVRational){ 0, 0 };
+        }
+        reset_links_downstream(link->dst);
+    }
+}
+
+/**
+ * Check that filter and all filters downstream of it can be relinked.
+ */
+static int relink_supported(AVFilterContext *filter)
+{
+    int i;
+
+    if (!(filter->filter->flags & AVFILTER_FLAG_SUPPORT_RELINK))
+        return 0;
+    for (i = 0; i < filter->nb_outputs; i++)
+        if (filter->outputs[i] && !relink_supported(filter->outputs[i]->dst))
+            return 0;
+    return 1;
+}
+
+static int format_listed(const AVFilterFormats *list, int format)
+{
+    int i;
+
+    if (!list)
+        return 1;
+    for (i = 0; i < list->nb_formats; i++)
+        if (list->formats[i] == format)
+            return 1;
+    return 0;
+}
+
+static int channel_layout_listed(const AVFilterChannelLayouts *list,
+                                 uint64_t layout)
+{
+    int i;
+
+    if (!list || list->all_counts ||
+        (list->all_layouts && !FF_LAYOUT2COUNT(layout)))
+        return 1;
+    for (i = 0; i < list->nb_channel_layouts; i++)
+        if (list->channel_layouts[i] == layout)
+            return 1;
+    return 0;
+}
+
+/**
+ * Query the formats filter supports now, and check that the formats
+ * negotiated for its output links are still among them.
+ *
+ * @return 1 if they are, 0 if not, a negative AVERROR code on error
+ */
+static int relink_formats_unchanged(AVFilterContext *filter)
+{
+    int i, ret, unchanged = 1;
+
+    if (!filter->filter->query_formats)
+        return 1;
+    if ((ret = filter->filter->query_formats(filter)) >= 0) {
+        for (i = 0; i < filter->nb_outputs; i++) {
+            AVFilterLink *link = filter->outputs[i];
+
+            if (!link)
+                continue;
+            unchanged &= format_listed(link->in_formats, link->format);
+            if (link->type == AVMEDIA_TYPE_AUDIO) {
+                uint64_t layout = link->channel_layout ? link->channel_layout :
+                                  FF_COUNT2LAYOUT(link->channels);
+                unchanged &= format_listed(link->in_samplerates, link->sample_rate);
+                unchanged &= channel_layout_listed(link->in_channel_layouts, layout);
+            }
+        }
+    }
+
+    for (i = 0; i < filter->nb_inputs + filter->nb_outputs; i++) {
+        AVFilterLink *link = i < filter->nb_inputs ? filter->inputs[i] :
+                             filter->outputs[i - filter->nb_inputs];
+
+        if (!link)
+            continue;
+        ff_formats_unref(&link->in_formats);
+        ff_formats_unref(&link->out_formats);
+        ff_formats_unref(&link->in_samplerates);
+        ff_formats_unref(&link->out_samplerates);
+        ff_channel_layouts_unref(&link->in_channel_layouts);
+        ff_channel_layouts_unref(&link->out_channel_layouts);
+    }
+
+    return ret < 0 ? ret : unchanged;
+}
+
+int avfilter_graph_relink(AVFilterGraph *graph, AVFilterContext *filter)
+{
+    int64_t *pts;
+    int i, j, k, nb_links = 0, ret = 0;
+
+    if (!relink_supported(filter)) {
+        av_log(filter, AV_LOG_VERBOSE,
+               "Filters downstream do not support relinking\n");
+        return AVERROR(ENOSYS);
+    }
+    if ((ret = relink_formats_unchanged(filter)) <= 0) {
+        if (!ret)
+            av_log(filter, AV_LOG_VERBOSE,
+                   "Output formats changed, formats cannot be renegotiated by relinking\n");
+        return ret < 0 ? ret : AVERROR(ENOSYS);
+    }
+
+    for (i = 0; i < graph->nb_filters; i++)
+        nb_links += graph->filters[i]->nb_inputs;
+    pts = av_malloc_array(nb_links, sizeof(*pts));
+    if (nb_links && !pts)
+        return AVERROR(ENOMEM);
+
+    /* avfilter_config_links() resets the timestamps of the links it visits,
+     * which must survive so the oldest sink keeps being requested first */
+    for (i = k = 0; i < graph->nb_filters; i++)
+        for (j = 0; j < graph->filters[i]->nb_inputs; j++, k++)
+            if (graph->filters[i]->inputs[j])
+                pts[k] = graph->filters[i]->inputs[j]->current_pts;
+
+    reset_links_downstream(filter);
+
+    for (i = 0; i < graph->nb_filters && ret >= 0; i++) {
+        AVFilterContext *filt = graph->filters[i];
+
+        for (j = 0; j < filt->nb_inputs; j++)
+            if (filt->inputs[j] && filt->inputs[j]->init_state == AVLINK_UNINIT)
+                break;
+        if (j < filt->nb_inputs)
+            ret = avfilter_config_links(filt);
+    }
+
+    for (i = k = 0; i < graph->nb_filters; i++)
+        for (j = 0; j < graph->filters[i]->nb_inputs; j++, k++)
+            if (graph->filters[i]->inputs[j])
+                graph->filters[i]->inputs[j]->current_pts = pts[k];
+
+    av_free(pts);
+    return ret;
+}
+
 int avfilter_graph_send_command(AVFilterGraph *graph, const char *target, const char *cmd, const char *arg, char *res, int res_len, int flags)
 {
     int i, r = AVERROR(ENOSYS);
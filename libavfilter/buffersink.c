@@ -538,6 +538,7 @@ AVFilter ff_vsink_ffbuffersink = {
     .uninit    = uninit,
 
     .query_formats = vsink_query_formats,
+    .flags         = AVFILTER_FLAG_SUPPORT_RELINK,
     .inputs        = ffbuffersink_inputs,
     .outputs       = NULL,
 };
@@ -582,6 +583,7 @@ AVFilter ff_vsink_buffer = {
     .uninit      = uninit,
 
     .query_formats = vsink_query_formats,
+    .flags       = AVFILTER_FLAG_SUPPORT_RELINK,
     .inputs      = avfilter_vsink_buffer_inputs,
     .outputs     = NULL,
 };
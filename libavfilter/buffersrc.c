@@ -529,6 +529,7 @@ AVFilter ff_vsrc_buffer = {
     .init      = init_video,
     .uninit    = uninit,
 
+    .flags     = AVFILTER_FLAG_SUPPORT_RELINK,
     .inputs    = NULL,
     .outputs   = avfilter_vsrc_buffer_outputs,
     .priv_class = &buffer_class,
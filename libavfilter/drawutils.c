@@ -21,6 +21,7 @@
 
 #include <string.h>
 
+#include "config.h"
 #include "libavutil/avutil.h"
 #include "libavutil/colorspace.h"
 #include "libavutil/mem.h"
@@ -185,6 +186,10 @@ int ff_draw_init(FFDrawContext *draw, enum AVPixelFormat format, unsigned flags)
     for (i = 0; i < ((desc->nb_components - 1) | 1); i++)
         draw->comp_mask[desc->comp[i].plane] |=
             1 << (desc->comp[i].offset_plus1 - 1);
+    draw->blend_row8     = ff_blend_row8_c;
+    draw->blend_row8_420 = ff_blend_row8_420_c;
+    if (ARCH_X86)
+        ff_draw_init_x86(draw);
     return 0;
 }
 
@@ -418,7 +423,69 @@ static void blend_pixel(uint8_t *dst, unsigned src, unsigned alpha,
     *dst = ((0x1010101 - alpha) * *dst + alpha * src) >> 24;
 }
 
-static void blend_line_hv(uint8_t *dst, int dst_delta,
+void ff_blend_row8_c(uint8_t *dst, const uint8_t *mask, int w,
+                     unsigned src, unsigned alpha)
+{
+    unsigned a;
+    int x;
+
+    for (x = 0; x < w; x++) {
+        a = mask[x] * alpha;
+        dst[x] = ((0x1010101 - a) * dst[x] + a * src) >> 24;
+    }
+}
+
+void ff_blend_row8_420_c(uint8_t *dst, const uint8_t *mask,
+                         ptrdiff_t mask_linesize, int w,
+                         unsigned src, unsigned alpha)
+{
+    unsigned a;
+    int x;
+
+    for (x = 0; x < w; x++) {
+        a = ((mask[2 * x]                 + mask[2 * x + 1] +
+              mask[2 * x + mask_linesize] + mask[2 * x + mask_linesize + 1]) >> 2) * alpha;
+        dst[x] = ((0x1010101 - a) * dst[x] + a * src) >> 24;
+    }
+}
+
+/* Same as blend_line_hv() for the full blocks of an 8-bit mask. */
+static void blend_line_hv8(FFDrawContext *draw, uint8_t *dst, int dst_delta,
+                           unsigned src, unsigned alpha,
+                           const uint8_t *mask, int mask_linesize, int w,
+                           unsigned hsub, unsigned vsub, int hband)
+{
+    unsigned a, t;
+    int x, xm, y;
+
+    if (dst_delta == 1 && !hsub && !vsub) {
+        draw->blend_row8(dst, mask, w, src, alpha);
+        return;
+    }
+    if (dst_delta == 1 && hsub == 1 && vsub == 1 && hband == 2) {
+        draw->blend_row8_420(dst, mask, mask_linesize, w, src, alpha);
+        return;
+    }
+    if (!hsub && !vsub) {
+        for (x = 0; x < w; x++) {
+            a = mask[x] * alpha;
+            dst[x * dst_delta] = ((0x1010101 - a) * dst[x * dst_delta] + a * src) >> 24;
+        }
+        return;
+    }
+    for (x = 0; x < w; x++) {
+        t = 0;
+        for (y = 0; y < hband; y++)
+            for (xm = 0; xm < 1 << hsub; xm++)
+                t += mask[y * mask_linesize + xm];
+        a = (t >> (hsub + vsub)) * alpha;
+        *dst = ((0x1010101 - a) * *dst + a * src) >> 24;
+        dst  += dst_delta;
+        mask += 1 << hsub;
+    }
+}
+
+static void blend_line_hv(FFDrawContext *draw, uint8_t *dst, int dst_delta,
                           unsigned src, unsigned alpha,
                           uint8_t *mask, int mask_linesize, int l2depth, int w,
                           unsigned hsub, unsigned vsub,
@@ -426,6 +493,21 @@ static void blend_line_hv(uint8_t *dst, int dst_delta,
 {
     int x;
 
+    if (l2depth == 3) {
+        if (left) {
+            blend_pixel(dst, src, alpha, mask, mask_linesize, l2depth,
+                        left, hband, hsub + vsub, xm);
+            dst += dst_delta;
+            xm += left;
+        }
+        blend_line_hv8(draw, dst, dst_delta, src, alpha, mask + xm, mask_linesize,
+                       w, hsub, vsub, hband);
+        if (right)
+            blend_pixel(dst + w * dst_delta, src, alpha, mask, mask_linesize,
+                        l2depth, right, hband, hsub + vsub, xm + (w << hsub));
+        return;
+    }
+
     if (left) {
         blend_pixel(dst, src, alpha, mask, mask_linesize, l2depth,
                     left, hband, hsub + vsub, xm);
@@ -476,7 +558,7 @@ void ff_blend_mask(FFDrawContext *draw, FFDrawColor *color,
             p = p0 + comp;
             m = mask;
             if (top) {
-                blend_line_hv(p, draw->pixelstep[plane],
+                blend_line_hv(draw, p, draw->pixelstep[plane],
                               color->comp[plane].u8[comp], alpha,
                               m, mask_linesize, l2depth, w_sub,
                               draw->hsub[plane], draw->vsub[plane],
@@ -485,7 +567,7 @@ void ff_blend_mask(FFDrawContext *draw, FFDrawColor *color,
                 m += top * mask_linesize;
             }
             for (y = 0; y < h_sub; y++) {
-                blend_line_hv(p, draw->pixelstep[plane],
+                blend_line_hv(draw, p, draw->pixelstep[plane],
                               color->comp[plane].u8[comp], alpha,
                               m, mask_linesize, l2depth, w_sub,
                               draw->hsub[plane], draw->vsub[plane],
@@ -494,7 +576,7 @@ void ff_blend_mask(FFDrawContext *draw, FFDrawColor *color,
                 m += mask_linesize << draw->vsub[plane];
             }
             if (bottom)
-                blend_line_hv(p, draw->pixelstep[plane],
+                blend_line_hv(draw, p, draw->pixelstep[plane],
                               color->comp[plane].u8[comp], alpha,
                               m, mask_linesize, l2depth, w_sub,
                               draw->hsub[plane], draw->vsub[plane],
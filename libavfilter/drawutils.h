@@ -24,6 +24,7 @@
  * misc drawing utilities
  */
 
+#include <stddef.h>
 #include <stdint.h>
 #include "avfilter.h"
 #include "libavutil/pixfmt.h"
@@ -55,6 +56,21 @@ typedef struct FFDrawContext {
     uint8_t vsub[MAX_PLANES];  /*< vertical subsampling */
     uint8_t hsub_max;
     uint8_t vsub_max;
+
+    /**
+     * Blend w consecutive bytes of dst with src, using the 8-bit coverage
+     * mask scaled by alpha as in ff_blend_mask().
+     */
+    void (*blend_row8)(uint8_t *dst, const uint8_t *mask, int w,
+                       unsigned src, unsigned alpha);
+
+    /**
+     * Same as blend_row8 for a plane subsampled 2x2 relative to the mask:
+     * the coverage of each byte is the average of a 2x2 block of mask.
+     */
+    void (*blend_row8_420)(uint8_t *dst, const uint8_t *mask,
+                           ptrdiff_t mask_linesize, int w,
+                           unsigned src, unsigned alpha);
 } FFDrawContext;
 
 typedef struct FFDrawColor {
@@ -152,4 +168,12 @@ int ff_draw_round_to_sub(FFDrawContext *draw, int sub_dir, int round_dir,
  */
 AVFilterFormats *ff_draw_supported_pixel_formats(unsigned flags);
 
+void ff_blend_row8_c(uint8_t *dst, const uint8_t *mask, int w,
+                     unsigned src, unsigned alpha);
+void ff_blend_row8_420_c(uint8_t *dst, const uint8_t *mask,
+                         ptrdiff_t mask_linesize, int w,
+                         unsigned src, unsigned alpha);
+
+void ff_draw_init_x86(FFDrawContext *draw);
+
 #endif /* AVFILTER_DRAWUTILS_H */
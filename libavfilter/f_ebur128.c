@@ -36,9 +36,9 @@
 #include "libavutil/xga_font_data.h"
 #include "libavutil/opt.h"
 #include "libavutil/timestamp.h"
-#include "libswresample/swresample.h"
 #include "audio.h"
 #include "avfilter.h"
+#include "f_ebur128.h"
 #include "formats.h"
 #include "internal.h"
 
@@ -58,6 +58,11 @@
 #define RLB_A1 -1.99004745483398
 #define RLB_A2  0.99007225036621
 
+/* true-peak over-sampling: 4x polyphase FIR interpolation with 12 taps per
+ * phase, as recommended by ITU-R BS.1770-3 Annex 2 */
+#define TP_PHASES 4
+#define TP_TAPS  12
+
 #define ABS_THRES    -70            ///< silence gate: we discard anything below this absolute (LUFS) threshold
 #define ABS_UP_THRES  10            ///< upper loud limit to consider (ABS_THRES being the minimum)
 #define HIST_GRAIN   100            ///< defines histogram precision
@@ -97,11 +102,8 @@ typedef struct {
     double *true_peaks;             ///< true peaks per channel
     double *sample_peaks;           ///< sample peaks per channel
     double *true_peaks_per_frame;   ///< true peaks in a frame per channel
-#if CONFIG_SWRESAMPLE
-    SwrContext *swr_ctx;            ///< over-sampling context for true peak metering
-    double *swr_buf;                ///< resampled audio data for true peak metering
-    int swr_linesize;
-#endif
+    double *tp_buf;                 ///< last TP_TAPS-1 samples followed by the current frame
+    double tp_coeffs[TP_PHASES - 1][TP_TAPS]; ///< interpolation filter for each non-zero phase
 
     /* video  */
     int do_video;                   ///< 1 if video output enabled, 0 otherwise
@@ -120,11 +122,10 @@ typedef struct {
     double *ch_weighting;           ///< channel weighting mapping
     int sample_count;               ///< sample count used for refresh frequency, reset at refresh
 
-    /* Filter caches.
-     * The mult by 3 in the following is for X[i], X[i-1] and X[i-2] */
-    double x[MAX_CHANNELS * 3];     ///< 3 input samples cache for each channel
-    double y[MAX_CHANNELS * 3];     ///< 3 pre-filter samples cache for each channel
-    double z[MAX_CHANNELS * 3];     ///< 3 RLB-filter samples cache for each channel
+    /* K-weighting filter history, EBUR128_STATE_SIZE entries per channel pair */
+    double kstate[(MAX_CHANNELS + 1) / 2 * EBUR128_STATE_SIZE];
+    double *bins;                   ///< squared K-weighted samples of the current block
+    EBUR128DSPContext dsp;
 
 #define I400_BINS  (48000 * 4 / 10)
 #define I3000_BINS (48000 * 3)
@@ -349,10 +350,8 @@ static int config_audio_input(AVFilterLink *inlink)
 
     /* Force 100ms framing in case of metadata injection: the frames must have
      * a granularity of the window overlap to be accurately exploited.
-     * As for the true peaks mode, it just simplifies the resampling buffer
-     * allocation and the lookup in it (since sample buffers differ in size, it
-     * can be more complex to integrate in the one-sample loop of
-     * filter_frame()). */
+     * As for the true peaks mode, it just simplifies the over-sampling buffer
+     * allocation. */
     if (ebur128->metadata || (ebur128->peak_mode & PEAK_MODE_TRUE_PEAKS))
         inlink->min_samples =
         inlink->max_samples =
@@ -375,7 +374,8 @@ static int config_audio_output(AVFilterLink *outlink)
 
     ebur128->nb_channels  = nb_channels;
     ebur128->ch_weighting = av_calloc(nb_channels, sizeof(*ebur128->ch_weighting));
-    if (!ebur128->ch_weighting)
+    ebur128->bins         = av_malloc(4800 * nb_channels * sizeof(*ebur128->bins));
+    if (!ebur128->ch_weighting || !ebur128->bins)
         return AVERROR(ENOMEM);
 
     for (i = 0; i < nb_channels; i++) {
@@ -408,31 +408,14 @@ static int config_audio_output(AVFilterLink *outlink)
 
     outlink->flags |= FF_LINK_FLAG_REQUEST_LOOP;
 
-#if CONFIG_SWRESAMPLE
     if (ebur128->peak_mode & PEAK_MODE_TRUE_PEAKS) {
-        int ret;
-
-        ebur128->swr_buf    = av_malloc(19200 * nb_channels * sizeof(double));
+        ebur128->tp_buf     = av_calloc((TP_TAPS - 1 + 4800) * nb_channels, sizeof(*ebur128->tp_buf));
         ebur128->true_peaks = av_calloc(nb_channels, sizeof(*ebur128->true_peaks));
         ebur128->true_peaks_per_frame = av_calloc(nb_channels, sizeof(*ebur128->true_peaks_per_frame));
-        ebur128->swr_ctx    = swr_alloc();
-        if (!ebur128->swr_buf || !ebur128->true_peaks ||
-            !ebur128->true_peaks_per_frame || !ebur128->swr_ctx)
+        if (!ebur128->tp_buf || !ebur128->true_peaks ||
+            !ebur128->true_peaks_per_frame)
             return AVERROR(ENOMEM);
-
-        av_opt_set_int(ebur128->swr_ctx, "in_channel_layout",    outlink->channel_layout, 0);
-        av_opt_set_int(ebur128->swr_ctx, "in_sample_rate",       outlink->sample_rate, 0);
-        av_opt_set_sample_fmt(ebur128->swr_ctx, "in_sample_fmt", outlink->format, 0);
-
-        av_opt_set_int(ebur128->swr_ctx, "out_channel_layout",    outlink->channel_layout, 0);
-        av_opt_set_int(ebur128->swr_ctx, "out_sample_rate",       192000, 0);
-        av_opt_set_sample_fmt(ebur128->swr_ctx, "out_sample_fmt", outlink->format, 0);
-
-        ret = swr_init(ebur128->swr_ctx);
-        if (ret < 0)
-            return ret;
     }
-#endif
 
     if (ebur128->peak_mode & PEAK_MODE_SAMPLES_PEAKS) {
         ebur128->sample_peaks = av_calloc(nb_channels, sizeof(*ebur128->sample_peaks));
@@ -461,6 +444,81 @@ static struct hist_entry *get_histogram(void)
     return h;
 }
 
+/* Y[i] = X[i]*b0 + X[i-1]*b1 + X[i-2]*b2 - Y[i-1]*a1 - Y[i-2]*a2
+ * Both channels of a pair are filtered in the same loop since each filter is
+ * bound by the latency of its recursion. */
+static av_always_inline void kweight(double *dst, const double *src,
+                                     ptrdiff_t stride, int len,
+                                     double *state, int nb_ch)
+{
+    double x1[2], x2[2], y1[2], y2[2], z1[2], z2[2];
+    int i, c;
+
+    for (c = 0; c < nb_ch; c++) {
+        x1[c] = state[c    ]; x2[c] = state[c + 2];
+        y1[c] = state[c + 4]; y2[c] = state[c + 6];
+        z1[c] = state[c + 8]; z2[c] = state[c + 10];
+    }
+
+    for (i = 0; i < len; i++) {
+        for (c = 0; c < nb_ch; c++) {
+            const double x0 = src[c];
+            const double y0 = x0*PRE_B0 + x1[c]*PRE_B1 + x2[c]*PRE_B2
+                                        - y1[c]*PRE_A1 - y2[c]*PRE_A2;
+            const double z0 = y0*RLB_B0 + y1[c]*RLB_B1 + y2[c]*RLB_B2
+                                        - z1[c]*RLB_A1 - z2[c]*RLB_A2;
+
+            x2[c] = x1[c]; x1[c] = x0;
+            y2[c] = y1[c]; y1[c] = y0;
+            z2[c] = z1[c]; z1[c] = z0;
+            dst[c] = z0 * z0;
+        }
+        src += stride;
+        dst += stride;
+    }
+
+    for (c = 0; c < nb_ch; c++) {
+        state[c    ] = x1[c]; state[c + 2]  = x2[c];
+        state[c + 4] = y1[c]; state[c + 6]  = y2[c];
+        state[c + 8] = z1[c]; state[c + 10] = z2[c];
+    }
+}
+
+static void kweight_1ch_c(double *dst, const double *src, ptrdiff_t stride,
+                          int len, double *state)
+{
+    kweight(dst, src, stride, len, state, 1);
+}
+
+static void kweight_2ch_c(double *dst, const double *src, ptrdiff_t stride,
+                          int len, double *state)
+{
+    kweight(dst, src, stride, len, state, 2);
+}
+
+static av_cold void init_tp_coeffs(EBUR128Context *ebur128)
+{
+    int p, j;
+
+    /* Blackman windowed sinc, phase p interpolating between the input samples
+     * i-TP_TAPS/2 and i-TP_TAPS/2+1 at p/TP_PHASES from the first one */
+    for (p = 1; p < TP_PHASES; p++) {
+        double *c = ebur128->tp_coeffs[p - 1];
+        double sum = 0;
+
+        for (j = 0; j < TP_TAPS; j++) {
+            const double d = TP_TAPS / 2 - j - p / (double)TP_PHASES;
+            const double w = 0.42 + 0.5  * cos(    M_PI * d / (TP_TAPS / 2))
+                                  + 0.08 * cos(2 * M_PI * d / (TP_TAPS / 2));
+            c[j] = w * sin(M_PI * d) / (M_PI * d);
+            sum += c[j];
+        }
+        /* unity gain at DC for each phase */
+        for (j = 0; j < TP_TAPS; j++)
+            c[j] /= sum;
+    }
+}
+
 static av_cold int init(AVFilterContext *ctx)
 {
     EBUR128Context *ebur128 = ctx->priv;
@@ -474,11 +532,12 @@ static av_cold int init(AVFilterContext *ctx)
             ebur128->loglevel = AV_LOG_INFO;
     }
 
-    if (!CONFIG_SWRESAMPLE && (ebur128->peak_mode & PEAK_MODE_TRUE_PEAKS)) {
-        av_log(ctx, AV_LOG_ERROR,
-               "True-peak mode requires libswresample to be performed\n");
-        return AVERROR(EINVAL);
-    }
+    if (ebur128->peak_mode & PEAK_MODE_TRUE_PEAKS)
+        init_tp_coeffs(ebur128);
+
+    ebur128->dsp.kweight_2ch = kweight_2ch_c;
+    if (ARCH_X86)
+        ff_ebur128_init_x86(&ebur128->dsp);
 
     // if meter is  +9 scale, scale range is from -18 LU to  +9 LU (or 3*9)
     // if meter is +18 scale, scale range is from -36 LU to +18 LU (or 3*18)
@@ -545,80 +604,76 @@ static int gate_update(struct integrator *integ, double power,
     return gate_hist_pos;
 }
 
-static int filter_frame(AVFilterLink *inlink, AVFrame *insamples)
+static double true_peak(const EBUR128Context *ebur128, const double *src,
+                        ptrdiff_t stride, int nb_samples)
+{
+    double peak = 0;
+    int i, j, p;
+
+    /* src is preceded by TP_TAPS-1 samples of history; the phase 0 of the
+     * over-sampled signal is the input itself */
+    for (i = 0; i < nb_samples; i++) {
+        peak = FFMAX(peak, FFABS(src[i * stride]));
+        for (p = 0; p < TP_PHASES - 1; p++) {
+            const double *c = ebur128->tp_coeffs[p];
+            double v = 0;
+
+            for (j = 0; j < TP_TAPS; j++)
+                v += c[j] * src[(i - j) * stride];
+            peak = FFMAX(peak, FFABS(v));
+        }
+    }
+    return peak;
+}
+
+typedef struct ThreadData {
+    const double *samples;          ///< first sample of the block
+    const double *tp_samples;       ///< first sample of the block in tp_buf
+    int nb_samples;                 ///< number of samples per channel in the block
+} ThreadData;
+
+/* Channels are independent up to the gating, so each job handles a range of
+ * channel pairs for the whole block. */
+static int filter_channels(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    int i, ch, idx_insample;
-    AVFilterContext *ctx = inlink->dst;
     EBUR128Context *ebur128 = ctx->priv;
+    ThreadData *td = arg;
     const int nb_channels = ebur128->nb_channels;
-    const int nb_samples  = insamples->nb_samples;
-    const double *samples = (double *)insamples->data[0];
-    AVFrame *pic = ebur128->outpicref;
-
-#if CONFIG_SWRESAMPLE
-    if (ebur128->peak_mode & PEAK_MODE_TRUE_PEAKS) {
-        const double *swr_samples = ebur128->swr_buf;
-        int ret = swr_convert(ebur128->swr_ctx, (uint8_t**)&ebur128->swr_buf, 19200,
-                              (const uint8_t **)insamples->data, nb_samples);
-        if (ret < 0)
-            return ret;
-        for (ch = 0; ch < nb_channels; ch++)
-            ebur128->true_peaks_per_frame[ch] = 0.0;
-        for (idx_insample = 0; idx_insample < ret; idx_insample++) {
-            for (ch = 0; ch < nb_channels; ch++) {
-                ebur128->true_peaks[ch] = FFMAX(ebur128->true_peaks[ch], FFABS(*swr_samples));
-                ebur128->true_peaks_per_frame[ch] = FFMAX(ebur128->true_peaks_per_frame[ch],
-                                                          FFABS(*swr_samples));
-                swr_samples++;
-            }
-        }
+    const int nb_pairs    = (nb_channels + 1) / 2;
+    const int ch_start    = 2 * (nb_pairs *  jobnr     / nb_jobs);
+    const int ch_end      = FFMIN(2 * (nb_pairs * (jobnr + 1) / nb_jobs), nb_channels);
+    const int nb_samples  = td->nb_samples;
+    int bin_id_400  = ebur128->i400.cache_pos;
+    int bin_id_3000 = ebur128->i3000.cache_pos;
+    int i, ch;
+
+    for (ch = ch_start; ch < ch_end; ch += 2) {
+        double *state = ebur128->kstate + ch / 2 * EBUR128_STATE_SIZE;
+
+        if (ch + 1 < nb_channels)
+            ebur128->dsp.kweight_2ch(ebur128->bins + ch, td->samples + ch,
+                                     nb_channels, nb_samples, state);
+        else
+            kweight_1ch_c(ebur128->bins + ch, td->samples + ch,
+                          nb_channels, nb_samples, state);
     }
-#endif
-
-    for (idx_insample = 0; idx_insample < nb_samples; idx_insample++) {
-        const int bin_id_400  = ebur128->i400.cache_pos;
-        const int bin_id_3000 = ebur128->i3000.cache_pos;
-
-#define MOVE_TO_NEXT_CACHED_ENTRY(time) do {                \
-    ebur128->i##time.cache_pos++;                           \
-    if (ebur128->i##time.cache_pos == I##time##_BINS) {     \
-        ebur128->i##time.filled    = 1;                     \
-        ebur128->i##time.cache_pos = 0;                     \
-    }                                                       \
-} while (0)
 
-        MOVE_TO_NEXT_CACHED_ENTRY(400);
-        MOVE_TO_NEXT_CACHED_ENTRY(3000);
+    for (i = 0; i < nb_samples; i++) {
+        const double *src  = td->samples  + i * nb_channels;
+        const double *bins = ebur128->bins + i * nb_channels;
 
-        for (ch = 0; ch < nb_channels; ch++) {
-            double bin;
+        if (++bin_id_400  == I400_BINS)  bin_id_400  = 0;
+        if (++bin_id_3000 == I3000_BINS) bin_id_3000 = 0;
 
-            if (ebur128->peak_mode & PEAK_MODE_SAMPLES_PEAKS)
-                ebur128->sample_peaks[ch] = FFMAX(ebur128->sample_peaks[ch], FFABS(*samples));
+        for (ch = ch_start; ch < ch_end; ch++) {
+            const double bin = bins[ch];
 
-            ebur128->x[ch * 3] = *samples++; // set X[i]
+            if (ebur128->peak_mode & PEAK_MODE_SAMPLES_PEAKS)
+                ebur128->sample_peaks[ch] = FFMAX(ebur128->sample_peaks[ch], FFABS(src[ch]));
 
             if (!ebur128->ch_weighting[ch])
                 continue;
 
-            /* Y[i] = X[i]*b0 + X[i-1]*b1 + X[i-2]*b2 - Y[i-1]*a1 - Y[i-2]*a2 */
-#define FILTER(Y, X, name) do {                                                 \
-            double *dst = ebur128->Y + ch*3;                                    \
-            double *src = ebur128->X + ch*3;                                    \
-            dst[2] = dst[1];                                                    \
-            dst[1] = dst[0];                                                    \
-            dst[0] = src[0]*name##_B0 + src[1]*name##_B1 + src[2]*name##_B2     \
-                                      - dst[1]*name##_A1 - dst[2]*name##_A2;    \
-} while (0)
-
-            // TODO: merge both filters in one?
-            FILTER(y, x, PRE);  // apply pre-filter
-            ebur128->x[ch * 3 + 2] = ebur128->x[ch * 3 + 1];
-            ebur128->x[ch * 3 + 1] = ebur128->x[ch * 3    ];
-            FILTER(z, y, RLB);  // apply RLB-filter
-
-            bin = ebur128->z[ch * 3] * ebur128->z[ch * 3];
-
             /* add the new value, and limit the sum to the cache size (400ms or 3s)
              * by removing the oldest one */
             ebur128->i400.sum [ch] = ebur128->i400.sum [ch] + bin - ebur128->i400.cache [ch][bin_id_400];
@@ -628,16 +683,70 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *insamples)
             ebur128->i400.cache [ch][bin_id_400 ] = bin;
             ebur128->i3000.cache[ch][bin_id_3000] = bin;
         }
+    }
+
+    if (ebur128->peak_mode & PEAK_MODE_TRUE_PEAKS) {
+        for (ch = ch_start; ch < ch_end; ch++) {
+            const double peak = true_peak(ebur128, td->tp_samples + ch,
+                                          nb_channels, nb_samples);
+
+            ebur128->true_peaks[ch] = FFMAX(ebur128->true_peaks[ch], peak);
+            ebur128->true_peaks_per_frame[ch] = FFMAX(ebur128->true_peaks_per_frame[ch], peak);
+        }
+    }
+    return 0;
+}
+
+static int filter_frame(AVFilterLink *inlink, AVFrame *insamples)
+{
+    int i, ch, idx_insample, n;
+    AVFilterContext *ctx = inlink->dst;
+    EBUR128Context *ebur128 = ctx->priv;
+    const int nb_channels = ebur128->nb_channels;
+    const int nb_samples  = insamples->nb_samples;
+    const double *samples = (double *)insamples->data[0];
+    const int tp_history  = (TP_TAPS - 1) * nb_channels;
+    const int nb_jobs     = FFMIN((nb_channels + 1) / 2, ctx->graph->nb_threads);
+    AVFrame *pic = ebur128->outpicref;
+
+    if (ebur128->peak_mode & PEAK_MODE_TRUE_PEAKS) {
+        memcpy(ebur128->tp_buf + tp_history, samples,
+               nb_samples * nb_channels * sizeof(*ebur128->tp_buf));
+        for (ch = 0; ch < nb_channels; ch++)
+            ebur128->true_peaks_per_frame[ch] = 0.0;
+    }
+
+    /* The samples are processed in blocks ending at the next refresh point */
+    for (idx_insample = 0; idx_insample < nb_samples; idx_insample += n) {
+        ThreadData td;
+
+        n = FFMIN(nb_samples - idx_insample, 4800 - ebur128->sample_count);
+        td.samples    = samples + idx_insample * nb_channels;
+        td.tp_samples = ebur128->tp_buf + tp_history + idx_insample * nb_channels;
+        td.nb_samples = n;
+        ctx->internal->execute(ctx, filter_channels, &td, NULL, nb_jobs);
+
+#define MOVE_CACHE_POS(time) do {                                   \
+    ebur128->i##time.cache_pos += n;                                \
+    if (ebur128->i##time.cache_pos >= I##time##_BINS) {             \
+        ebur128->i##time.filled     = 1;                            \
+        ebur128->i##time.cache_pos -= I##time##_BINS;               \
+    }                                                               \
+} while (0)
+
+        MOVE_CACHE_POS(400);
+        MOVE_CACHE_POS(3000);
+        ebur128->sample_count += n;
 
         /* For integrated loudness, gating blocks are 400ms long with 75%
          * overlap (see BS.1770-2 p5), so a re-computation is needed each 100ms
          * (4800 samples at 48kHz). */
-        if (++ebur128->sample_count == 4800) {
+        if (ebur128->sample_count == 4800) {
             double loudness_400, loudness_3000;
             double power_400 = 1e-12, power_3000 = 1e-12;
             AVFilterLink *outlink = ctx->outputs[0];
             const int64_t pts = insamples->pts +
-                av_rescale_q(idx_insample, (AVRational){ 1, inlink->sample_rate },
+                av_rescale_q(idx_insample + n - 1, (AVRational){ 1, inlink->sample_rate },
                              outlink->time_base);
 
             ebur128->sample_count = 0;
@@ -814,6 +923,11 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *insamples)
         }
     }
 
+    /* keep the end of the frame as history for the next true-peak lookup */
+    if (ebur128->peak_mode & PEAK_MODE_TRUE_PEAKS)
+        memmove(ebur128->tp_buf, ebur128->tp_buf + nb_samples * nb_channels,
+                tp_history * sizeof(*ebur128->tp_buf));
+
     return ff_filter_frame(ctx->outputs[ebur128->do_video], insamples);
 }
 
@@ -899,6 +1013,8 @@ static av_cold void uninit(AVFilterContext *ctx)
 
     av_freep(&ebur128->y_line_ref);
     av_freep(&ebur128->ch_weighting);
+    av_freep(&ebur128->bins);
+    av_freep(&ebur128->tp_buf);
     av_freep(&ebur128->true_peaks);
     av_freep(&ebur128->sample_peaks);
     av_freep(&ebur128->true_peaks_per_frame);
@@ -911,10 +1027,6 @@ static av_cold void uninit(AVFilterContext *ctx)
     for (i = 0; i < ctx->nb_outputs; i++)
         av_freep(&ctx->output_pads[i].name);
     av_frame_free(&ebur128->outpicref);
-#if CONFIG_SWRESAMPLE
-    av_freep(&ebur128->swr_buf);
-    swr_free(&ebur128->swr_ctx);
-#endif
 }
 
 static const AVFilterPad ebur128_inputs[] = {
@@ -937,5 +1049,5 @@ AVFilter ff_af_ebur128 = {
     .inputs        = ebur128_inputs,
     .outputs       = NULL,
     .priv_class    = &ebur128_class,
-    .flags         = AVFILTER_FLAG_DYNAMIC_OUTPUTS,
+    .flags         = AVFILTER_FLAG_DYNAMIC_OUTPUTS | AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -0,0 +1,49 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef AVFILTER_EBUR128_H
+#define AVFILTER_EBUR128_H
+
+#include <stddef.h>
+
+/**
+ * Number of doubles of filter history for a pair of channels: the last two
+ * input, pre-filter and RLB-filter samples, each stored as
+ * { channel 0, channel 1 }.
+ */
+#define EBUR128_STATE_SIZE 12
+
+typedef struct EBUR128DSPContext {
+    /**
+     * Apply the K-weighting filter (pre-filter followed by RLB-filter) to
+     * two adjacent channels of interleaved samples and store the squared
+     * filter output.
+     *
+     * @param dst    squared K-weighted samples, same layout as src
+     * @param src    samples of the first channel of the pair
+     * @param stride distance between two samples of a channel, in doubles
+     * @param len    number of samples per channel, must be positive
+     * @param state  filter history of the channel pair, updated on return
+     */
+    void (*kweight_2ch)(double *dst, const double *src, ptrdiff_t stride,
+                        int len, double *state);
+} EBUR128DSPContext;
+
+void ff_ebur128_init_x86(EBUR128DSPContext *dsp);
+
+#endif /* AVFILTER_EBUR128_H */
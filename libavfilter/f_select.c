@@ -32,12 +32,9 @@
 #include "audio.h"
 #include "formats.h"
 #include "internal.h"
+#include "scene_sad.h"
 #include "video.h"
 
-#if CONFIG_AVCODEC
-#include "libavcodec/dsputil.h"
-#endif
-
 static const char *const var_names[] = {
     "TB",                ///< timebase
 
@@ -144,11 +141,10 @@ typedef struct {
     AVExpr *expr;
     double var_values[VAR_VARS_NB];
     int do_scene_detect;            ///< 1 if the expression requires scene detection variables, 0 otherwise
-#if CONFIG_AVCODEC
-    AVCodecContext *avctx;          ///< codec context required for the DSPContext (scene detect only)
-    DSPContext c;                   ///< context providing optimized SAD methods   (scene detect only)
+    int scene_luma;                 ///< compute the scene score on the luma plane
+    ff_scene_sad_fn sad;            ///< sum of absolute differences function     (scene detect only)
+    uint64_t *sad_sums;             ///< SAD of each slice                        (scene detect only)
     double prev_mafd;               ///< previous MAFD                             (scene detect only)
-#endif
     AVFrame *prev_picref; ///< previous frame                            (scene detect only)
     double select;
     int select_out;                 ///< mark the selected output pad index
@@ -156,14 +152,11 @@ typedef struct {
 } SelectContext;
 
 #define OFFSET(x) offsetof(SelectContext, x)
-#define DEFINE_OPTIONS(filt_name, FLAGS)                            \
-static const AVOption filt_name##_options[] = {                     \
+#define COMMON_OPTIONS(FLAGS)                                       \
     { "expr", "set an expression to use for selecting frames", OFFSET(expr_str), AV_OPT_TYPE_STRING, { .str = "1" }, .flags=FLAGS }, \
     { "e",    "set an expression to use for selecting frames", OFFSET(expr_str), AV_OPT_TYPE_STRING, { .str = "1" }, .flags=FLAGS }, \
     { "outputs", "set the number of outputs", OFFSET(nb_outputs), AV_OPT_TYPE_INT, {.i64 = 1}, 1, INT_MAX, .flags=FLAGS }, \
-    { "n",       "set the number of outputs", OFFSET(nb_outputs), AV_OPT_TYPE_INT, {.i64 = 1}, 1, INT_MAX, .flags=FLAGS }, \
-    { NULL }                                                            \
-}
+    { "n",       "set the number of outputs", OFFSET(nb_outputs), AV_OPT_TYPE_INT, {.i64 = 1}, 1, INT_MAX, .flags=FLAGS },
 
 static int request_frame(AVFilterLink *outlink);
 
@@ -240,18 +233,37 @@ static int config_input(AVFilterLink *inlink)
     select->var_values[VAR_SAMPLE_RATE] =
         inlink->type == AVMEDIA_TYPE_AUDIO ? inlink->sample_rate : NAN;
 
-#if CONFIG_AVCODEC
     if (select->do_scene_detect) {
-        select->avctx = avcodec_alloc_context3(NULL);
-        if (!select->avctx)
+        select->sad = ff_scene_sad_get_fn();
+        av_freep(&select->sad_sums);
+        select->sad_sums = av_malloc_array(FFMAX(inlink->dst->graph->nb_threads, 1),
+                                           sizeof(*select->sad_sums));
+        if (!select->sad_sums)
             return AVERROR(ENOMEM);
-        avpriv_dsputil_init(&select->c, select->avctx);
     }
-#endif
     return 0;
 }
 
-#if CONFIG_AVCODEC
+typedef struct ThreadData {
+    const uint8_t *p1, *p2;
+    int linesize1, linesize2;
+    int width, height;              ///< size in bytes and rows, multiples of 8
+} ThreadData;
+
+static int scene_sad_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    SelectContext *select = ctx->priv;
+    ThreadData *td = arg;
+    int nb_blocks = td->height >> 3;
+    int start = (nb_blocks *  jobnr   ) / nb_jobs << 3;
+    int end   = (nb_blocks * (jobnr+1)) / nb_jobs << 3;
+
+    select->sad(td->p1 + start * td->linesize1, td->linesize1,
+                td->p2 + start * td->linesize2, td->linesize2,
+                td->width, end - start, &select->sad_sums[jobnr]);
+    return 0;
+}
+
 static double get_scene_score(AVFilterContext *ctx, AVFrame *frame)
 {
     double ret = 0;
@@ -260,25 +272,31 @@ static double get_scene_score(AVFilterContext *ctx, AVFrame *frame)
 
     if (prev_picref &&
         frame->height    == prev_picref->height &&
-        frame->width    == prev_picref->width &&
-        frame->linesize[0] == prev_picref->linesize[0]) {
-        int x, y, nb_sad = 0;
-        int64_t sad = 0;
+        frame->width     == prev_picref->width) {
+        int i, nb_jobs;
+        int64_t nb_sad;
+        uint64_t sad = 0;
         double mafd, diff;
-        uint8_t *p1 =      frame->data[0];
-        uint8_t *p2 = prev_picref->data[0];
-        const int linesize = frame->linesize[0];
-
-        for (y = 0; y < frame->height - 8; y += 8) {
-            for (x = 0; x < frame->width*3 - 8; x += 8) {
-                sad += select->c.sad[1](select, p1 + x, p2 + x,
-                                        linesize, 8);
-                nb_sad += 8 * 8;
-            }
-            p1 += 8 * linesize;
-            p2 += 8 * linesize;
+        ThreadData td;
+        int bytes = select->scene_luma ? frame->width : frame->width * 3;
+
+        /* whole 8x8 blocks, leaving out the last column and row of blocks
+         * even if complete, as the block based computation always did */
+        td.p1        =       frame->data[0];
+        td.p2        = prev_picref->data[0];
+        td.linesize1 =       frame->linesize[0];
+        td.linesize2 = prev_picref->linesize[0];
+        td.width     = FFMAX(bytes         - 1, 0) & ~7;
+        td.height    = FFMAX(frame->height - 1, 0) & ~7;
+        nb_sad       = (int64_t)td.width * td.height;
+
+        nb_jobs = FFMIN(td.height >> 3, ctx->graph->nb_threads);
+        if (nb_sad) {
+            ctx->internal->execute(ctx, scene_sad_slice, &td, NULL, nb_jobs);
+            for (i = 0; i < nb_jobs; i++)
+                sad += select->sad_sums[i];
         }
-        emms_c();
+
         mafd = nb_sad ? sad / nb_sad : 0;
         diff = fabs(mafd - select->prev_mafd);
         ret  = av_clipf(FFMIN(mafd, diff) / 100., 0, 1);
@@ -288,7 +306,6 @@ static double get_scene_score(AVFilterContext *ctx, AVFrame *frame)
     select->prev_picref = av_frame_clone(frame);
     return ret;
 }
-#endif
 
 #define D2TS(d)  (isnan(d) ? AV_NOPTS_VALUE : (int64_t)(d))
 #define TS2D(ts) ((ts) == AV_NOPTS_VALUE ? NAN : (double)(ts))
@@ -319,15 +336,21 @@ static void select_frame(AVFilterContext *ctx, AVFrame *frame)
             !frame->interlaced_frame ? INTERLACE_TYPE_P :
         frame->top_field_first ? INTERLACE_TYPE_T : INTERLACE_TYPE_B;
         select->var_values[VAR_PICT_TYPE] = frame->pict_type;
-#if CONFIG_AVCODEC
         if (select->do_scene_detect) {
+            AVDictionaryEntry *e = av_dict_get(av_frame_get_metadata(frame),
+                                               "lavfi.scene_score", NULL, 0);
             char buf[32];
-            select->var_values[VAR_SCENE] = get_scene_score(ctx, frame);
-            // TODO: document metadata
-            snprintf(buf, sizeof(buf), "%f", select->var_values[VAR_SCENE]);
-            av_dict_set(avpriv_frame_get_metadatap(frame), "lavfi.scene_score", buf, 0);
+
+            /* reuse the score exported by a previous scene detection */
+            if (e) {
+                select->var_values[VAR_SCENE] = av_strtod(e->value, NULL);
+                av_frame_free(&select->prev_picref);
+            } else {
+                select->var_values[VAR_SCENE] = get_scene_score(ctx, frame);
+                snprintf(buf, sizeof(buf), "%f", select->var_values[VAR_SCENE]);
+                av_dict_set(avpriv_frame_get_metadatap(frame), "lavfi.scene_score", buf, 0);
+            }
         }
-#endif
         break;
     }
 
@@ -418,15 +441,8 @@ static av_cold void uninit(AVFilterContext *ctx)
     for (i = 0; i < ctx->nb_outputs; i++)
         av_freep(&ctx->output_pads[i].name);
 
-#if CONFIG_AVCODEC
-    if (select->do_scene_detect) {
-        av_frame_free(&select->prev_picref);
-        if (select->avctx) {
-            avcodec_close(select->avctx);
-            av_freep(&select->avctx);
-        }
-    }
-#endif
+    av_frame_free(&select->prev_picref);
+    av_freep(&select->sad_sums);
 }
 
 static int query_formats(AVFilterContext *ctx)
@@ -435,6 +451,17 @@ static int query_formats(AVFilterContext *ctx)
 
     if (!select->do_scene_detect) {
         return ff_default_query_formats(ctx);
+    } else if (select->scene_luma) {
+        static const enum AVPixelFormat pix_fmts[] = {
+            AV_PIX_FMT_GRAY8,
+            AV_PIX_FMT_YUV420P,  AV_PIX_FMT_YUV422P,  AV_PIX_FMT_YUV444P,
+            AV_PIX_FMT_YUV410P,  AV_PIX_FMT_YUV411P,  AV_PIX_FMT_YUV440P,
+            AV_PIX_FMT_YUVJ420P, AV_PIX_FMT_YUVJ422P, AV_PIX_FMT_YUVJ444P,
+            AV_PIX_FMT_YUVJ440P, AV_PIX_FMT_NV12,     AV_PIX_FMT_NV21,
+            AV_PIX_FMT_YUVA420P, AV_PIX_FMT_YUVA422P, AV_PIX_FMT_YUVA444P,
+            AV_PIX_FMT_NONE
+        };
+        ff_set_common_formats(ctx, ff_make_format_list(pix_fmts));
     } else {
         static const enum AVPixelFormat pix_fmts[] = {
             AV_PIX_FMT_RGB24, AV_PIX_FMT_BGR24,
@@ -447,7 +474,10 @@ static int query_formats(AVFilterContext *ctx)
 
 #if CONFIG_ASELECT_FILTER
 
-DEFINE_OPTIONS(aselect, AV_OPT_FLAG_AUDIO_PARAM|AV_OPT_FLAG_FILTERING_PARAM);
+static const AVOption aselect_options[] = {
+    COMMON_OPTIONS(AV_OPT_FLAG_AUDIO_PARAM|AV_OPT_FLAG_FILTERING_PARAM)
+    { NULL }
+};
 AVFILTER_DEFINE_CLASS(aselect);
 
 static av_cold int aselect_init(AVFilterContext *ctx)
@@ -490,25 +520,13 @@ AVFilter ff_af_aselect = {
 
 #if CONFIG_SELECT_FILTER
 
-DEFINE_OPTIONS(select, AV_OPT_FLAG_VIDEO_PARAM|AV_OPT_FLAG_FILTERING_PARAM);
+static const AVOption select_options[] = {
+    COMMON_OPTIONS(AV_OPT_FLAG_VIDEO_PARAM|AV_OPT_FLAG_FILTERING_PARAM)
+    { "scene_luma", "compute the scene score on the luma plane", OFFSET(scene_luma), AV_OPT_TYPE_INT, {.i64 = 0}, 0, 1, .flags=AV_OPT_FLAG_VIDEO_PARAM|AV_OPT_FLAG_FILTERING_PARAM },
+    { NULL }
+};
 AVFILTER_DEFINE_CLASS(select);
 
-static av_cold int select_init(AVFilterContext *ctx)
-{
-    SelectContext *select = ctx->priv;
-    int ret;
-
-    if ((ret = init(ctx)) < 0)
-        return ret;
-
-    if (select->do_scene_detect && !CONFIG_AVCODEC) {
-        av_log(ctx, AV_LOG_ERROR, "Scene detection is not available without libavcodec.\n");
-        return AVERROR(EINVAL);
-    }
-
-    return 0;
-}
-
 static const AVFilterPad avfilter_vf_select_inputs[] = {
     {
         .name         = "default",
@@ -522,12 +540,12 @@ static const AVFilterPad avfilter_vf_select_inputs[] = {
 AVFilter ff_vf_select = {
     .name          = "select",
     .description   = NULL_IF_CONFIG_SMALL("Select video frames to pass in output."),
-    .init          = select_init,
+    .init          = init,
     .uninit        = uninit,
     .query_formats = query_formats,
     .priv_size     = sizeof(SelectContext),
     .priv_class    = &select_class,
     .inputs        = avfilter_vf_select_inputs,
-    .flags         = AVFILTER_FLAG_DYNAMIC_OUTPUTS,
+    .flags         = AVFILTER_FLAG_DYNAMIC_OUTPUTS | AVFILTER_FLAG_SLICE_THREADS,
 };
 #endif /* CONFIG_SELECT_FILTER */
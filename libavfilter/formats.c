@@ -32,17 +32,24 @@
 #define KNOWN(l) (!FF_LAYOUT2COUNT(l)) /* for readability */
 
 /**
- * Add all refs from a to ret and destroy a.
+ * Make room in ret for n more refs, leaving ret untouched on failure.
  */
-#define MERGE_REF(ret, a, fmts, type, fail)                                \
+#define GROW_REFS(ret, n, type, fail)                                      \
 do {                                                                       \
     type ***tmp;                                                           \
-    int i;                                                                 \
                                                                            \
     if (!(tmp = av_realloc(ret->refs,                                      \
-                           sizeof(*tmp) * (ret->refcount + a->refcount)))) \
+                           sizeof(*tmp) * (ret->refcount + (n)))))         \
         goto fail;                                                         \
     ret->refs = tmp;                                                       \
+} while (0)
+
+/**
+ * Add all refs from a to ret, which must have room for them, and destroy a.
+ */
+#define MOVE_REFS(ret, a, fmts)                                            \
+do {                                                                       \
+    int i;                                                                 \
                                                                            \
     for (i = 0; i < a->refcount; i ++) {                                   \
         ret->refs[ret->refcount] = a->refs[i];                             \
@@ -55,50 +62,79 @@ do {                                                                       \
 } while (0)
 
 /**
- * Add all formats common for a and b to ret, copy the refs and destroy
- * a and b.
+ * Add all refs from a to ret and destroy a.
  */
-#define MERGE_FORMATS(ret, a, b, fmts, nb, type, fail)                          \
-do {                                                                            \
-    int i, j, k = 0, count = FFMIN(a->nb, b->nb);                               \
-                                                                                \
-    if (!(ret = av_mallocz(sizeof(*ret))))                                      \
-        goto fail;                                                              \
-                                                                                \
-    if (count) {                                                                \
-        if (!(ret->fmts = av_malloc(sizeof(*ret->fmts) * count)))               \
-            goto fail;                                                          \
-        for (i = 0; i < a->nb; i++)                                             \
-            for (j = 0; j < b->nb; j++)                                         \
-                if (a->fmts[i] == b->fmts[j]) {                                 \
-                    if(k >= FFMIN(a->nb, b->nb)){                               \
-                        av_log(NULL, AV_LOG_ERROR, "Duplicate formats in avfilter_merge_formats() detected\n"); \
-                        av_free(ret->fmts);                                     \
-                        av_free(ret);                                           \
-                        return NULL;                                            \
-                    }                                                           \
-                    ret->fmts[k++] = a->fmts[i];                                \
-                }                                                               \
-    }                                                                           \
-    ret->nb = k;                                                                \
-    /* check that there was at least one common format */                       \
-    if (!ret->nb)                                                               \
-        goto fail;                                                              \
-                                                                                \
-    MERGE_REF(ret, a, fmts, type, fail);                                        \
-    MERGE_REF(ret, b, fmts, type, fail);                                        \
+#define MERGE_REF(ret, a, fmts, type, fail)                                \
+do {                                                                       \
+    GROW_REFS(ret, a->refcount, type, fail);                               \
+    MOVE_REFS(ret, a, fmts);                                               \
 } while (0)
 
-AVFilterFormats *ff_merge_formats(AVFilterFormats *a, AVFilterFormats *b,
-                                  enum AVMediaType type)
+/* pixel and sample formats are small enough to be looked up in a bitset */
+#define FMT_SET_BITS  FFMAX(AV_PIX_FMT_NB, AV_SAMPLE_FMT_NB)
+#define FMT_SET_WORDS ((FMT_SET_BITS + 63) / 64)
+
+/**
+ * Check if f contains a pixel format with the given flag, or with chroma
+ * if flag is 0.
+ */
+static int has_format_with(const AVFilterFormats *f, int flag)
 {
-    AVFilterFormats *ret = NULL;
-    int i, j;
-    int alpha1=0, alpha2=0;
-    int chroma1=0, chroma2=0;
+    int i;
 
-    if (a == b)
-        return a;
+    for (i = 0; i < f->nb_formats; i++) {
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(f->formats[i]);
+        if (flag ? desc->flags & flag : desc->nb_components > 1)
+            return 1;
+    }
+    return 0;
+}
+
+/**
+ * Find the formats of a which are also in b, in the order of a.
+ * If common is not NULL they are written there, which may alias a->formats.
+ * For video, merging is refused if it would lose chroma or alpha.
+ *
+ * @return the number of common formats, 0 if a and b cannot be merged
+ */
+static int common_formats(const AVFilterFormats *a, const AVFilterFormats *b,
+                          enum AVMediaType type, int *common)
+{
+    uint64_t set[FMT_SET_WORDS] = { 0 };
+    int use_set = 1, alpha = 0, chroma = 0;
+    int i, j, k = 0;
+
+    for (j = 0; j < b->nb_formats && use_set; j++) {
+        unsigned fmt = b->formats[j];
+        if (fmt < FMT_SET_BITS)
+            set[fmt >> 6] |= 1ULL << (fmt & 63);
+        else
+            use_set = 0;
+    }
+
+    for (i = 0; i < a->nb_formats; i++) {
+        int fmt = a->formats[i];
+
+        if (use_set) {
+            uint64_t bit = 1ULL << (fmt & 63);
+            if ((unsigned)fmt >= FMT_SET_BITS || !(set[fmt >> 6] & bit))
+                continue;
+            set[fmt >> 6] &= ~bit; /* drop duplicates */
+        } else {
+            for (j = 0; j < b->nb_formats && b->formats[j] != fmt; j++)
+                ;
+            if (j == b->nb_formats)
+                continue;
+        }
+        if (type == AVMEDIA_TYPE_VIDEO) {
+            const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(fmt);
+            alpha  |= !!(desc->flags & AV_PIX_FMT_FLAG_ALPHA);
+            chroma |= desc->nb_components > 1;
+        }
+        if (common)
+            common[k] = fmt;
+        k++;
+    }
 
     /* Do not lose chroma or alpha in merging.
        It happens if both lists have formats with chroma (resp. alpha), but
@@ -107,62 +143,74 @@ AVFilterFormats *ff_merge_formats(AVFilterFormats *a, AVFilterFormats *b,
        possibly causing a lossy conversion elsewhere in the graph.
        To avoid that, pretend that there are no common formats to force the
        insertion of a conversion filter. */
-    if (type == AVMEDIA_TYPE_VIDEO)
-        for (i = 0; i < a->nb_formats; i++)
-            for (j = 0; j < b->nb_formats; j++) {
-                const AVPixFmtDescriptor *adesc = av_pix_fmt_desc_get(a->formats[i]);
-                const AVPixFmtDescriptor *bdesc = av_pix_fmt_desc_get(b->formats[j]);
-                alpha2 |= adesc->flags & bdesc->flags & AV_PIX_FMT_FLAG_ALPHA;
-                chroma2|= adesc->nb_components > 1 && bdesc->nb_components > 1;
-                if (a->formats[i] == b->formats[j]) {
-                    alpha1 |= adesc->flags & AV_PIX_FMT_FLAG_ALPHA;
-                    chroma1|= adesc->nb_components > 1;
-                }
-            }
+    if (type == AVMEDIA_TYPE_VIDEO && k &&
+        ((!alpha  && has_format_with(a, AV_PIX_FMT_FLAG_ALPHA) &&
+                     has_format_with(b, AV_PIX_FMT_FLAG_ALPHA)) ||
+         (!chroma && has_format_with(a, 0) && has_format_with(b, 0))))
+        return 0;
 
-    // If chroma or alpha can be lost through merging then do not merge
-    if (alpha2 > alpha1 || chroma2 > chroma1)
-        return NULL;
+    return k;
+}
 
-    MERGE_FORMATS(ret, a, b, formats, nb_formats, AVFilterFormats, fail);
+/**
+ * Reduce a to the formats common with b in place, move the refs of b to a
+ * and destroy b.
+ */
+static AVFilterFormats *merge_formats_internal(AVFilterFormats *a,
+                                               AVFilterFormats *b,
+                                               enum AVMediaType type)
+{
+    if (!common_formats(a, b, type, NULL))
+        return NULL;
+    /* allocate before reducing a, so that a failure leaves it intact */
+    GROW_REFS(a, b->refcount, AVFilterFormats, fail);
+    a->nb_formats = common_formats(a, b, type, a->formats);
 
-    return ret;
+    MOVE_REFS(a, b, formats);
+    return a;
 fail:
-    if (ret) {
-        av_freep(&ret->refs);
-        av_freep(&ret->formats);
-    }
-    av_freep(&ret);
     return NULL;
 }
 
+AVFilterFormats *ff_merge_formats(AVFilterFormats *a, AVFilterFormats *b,
+                                  enum AVMediaType type)
+{
+    if (a == b)
+        return a;
+
+    return merge_formats_internal(a, b, type);
+}
+
 AVFilterFormats *ff_merge_samplerates(AVFilterFormats *a,
                                       AVFilterFormats *b)
 {
-    AVFilterFormats *ret = NULL;
-
     if (a == b) return a;
 
     if (a->nb_formats && b->nb_formats) {
-        MERGE_FORMATS(ret, a, b, formats, nb_formats, AVFilterFormats, fail);
+        return merge_formats_internal(a, b, AVMEDIA_TYPE_UNKNOWN);
     } else if (a->nb_formats) {
         MERGE_REF(a, b, formats, AVFilterFormats, fail);
-        ret = a;
+        return a;
     } else {
         MERGE_REF(b, a, formats, AVFilterFormats, fail);
-        ret = b;
+        return b;
     }
-
-    return ret;
 fail:
-    if (ret) {
-        av_freep(&ret->refs);
-        av_freep(&ret->formats);
-    }
-    av_freep(&ret);
     return NULL;
 }
 
+int ff_can_merge_formats(const AVFilterFormats *a, const AVFilterFormats *b,
+                         enum AVMediaType type)
+{
+    return a == b || common_formats(a, b, type, NULL) > 0;
+}
+
+int ff_can_merge_samplerates(const AVFilterFormats *a, const AVFilterFormats *b)
+{
+    return a == b || !a->nb_formats || !b->nb_formats ||
+           common_formats(a, b, AVMEDIA_TYPE_UNKNOWN, NULL) > 0;
+}
+
 AVFilterChannelLayouts *ff_merge_channel_layouts(AVFilterChannelLayouts *a,
                                                  AVFilterChannelLayouts *b)
 {
@@ -179,6 +227,8 @@ AVFilterChannelLayouts *ff_merge_channel_layouts(AVFilterChannelLayouts *a,
         FFSWAP(unsigned, a_all, b_all);
     }
     if (a_all) {
+        /* allocate before reducing b, so that a failure leaves it intact */
+        GROW_REFS(b, a->refcount, AVFilterChannelLayouts, fail);
         if (a_all == 1 && !b_all) {
             /* keep only known layouts in b; works also for b_all = 1 */
             for (i = j = 0; i < b->nb_channel_layouts; i++)
@@ -190,7 +240,7 @@ AVFilterChannelLayouts *ff_merge_channel_layouts(AVFilterChannelLayouts *a,
                 return NULL;
             b->nb_channel_layouts = j;
         }
-        MERGE_REF(b, a, channel_layouts, AVFilterChannelLayouts, fail);
+        MOVE_REFS(b, a, channel_layouts);
         return b;
     }
 
@@ -199,6 +249,8 @@ AVFilterChannelLayouts *ff_merge_channel_layouts(AVFilterChannelLayouts *a,
         !(ret->channel_layouts = av_malloc(sizeof(*ret->channel_layouts) *
                                            ret_max)))
         goto fail;
+    /* the intersection below clears entries of a and b */
+    GROW_REFS(ret, a->refcount + b->refcount, AVFilterChannelLayouts, fail);
 
     /* a[known] intersect b[known] */
     for (i = 0; i < a->nb_channel_layouts; i++) {
@@ -238,8 +290,8 @@ AVFilterChannelLayouts *ff_merge_channel_layouts(AVFilterChannelLayouts *a,
     ret->nb_channel_layouts = ret_nb;
     if (!ret->nb_channel_layouts)
         goto fail;
-    MERGE_REF(ret, a, channel_layouts, AVFilterChannelLayouts, fail);
-    MERGE_REF(ret, b, channel_layouts, AVFilterChannelLayouts, fail);
+    MOVE_REFS(ret, a, channel_layouts);
+    MOVE_REFS(ret, b, channel_layouts);
     return ret;
 
 fail:
@@ -342,16 +394,25 @@ int ff_add_channel_layout(AVFilterChannelLayouts **l, uint64_t channel_layout)
 
 AVFilterFormats *ff_all_formats(enum AVMediaType type)
 {
-    AVFilterFormats *ret = NULL;
+    AVFilterFormats *ret;
     int fmt;
     int num_formats = type == AVMEDIA_TYPE_VIDEO ? AV_PIX_FMT_NB    :
                       type == AVMEDIA_TYPE_AUDIO ? AV_SAMPLE_FMT_NB : 0;
 
+    /* allocate the whole list at once, this is called for every filter */
+    if (!(ret = av_mallocz(sizeof(*ret))))
+        return NULL;
+    if (num_formats &&
+        !(ret->formats = av_malloc(sizeof(*ret->formats) * num_formats))) {
+        av_free(ret);
+        return NULL;
+    }
+
     for (fmt = 0; fmt < num_formats; fmt++) {
         const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(fmt);
         if ((type != AVMEDIA_TYPE_VIDEO) ||
             (type == AVMEDIA_TYPE_VIDEO && !(desc->flags & AV_PIX_FMT_FLAG_HWACCEL)))
-            ff_add_format(&ret, fmt);
+            ret->formats[ret->nb_formats++] = fmt;
     }
 
     return ret;
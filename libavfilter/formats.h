@@ -111,7 +111,8 @@ typedef struct AVFilterChannelLayouts {
 /**
  * Return a channel layouts/samplerates list which contains the intersection of
  * the layouts/samplerates of a and b. Also, all the references of a, all the
- * references of b, and a and b themselves will be deallocated.
+ * references of b, and a and b themselves will be deallocated. The returned
+ * list may be a or b reduced in place.
  *
  * If a and b do not share any common elements, neither is modified, and NULL
  * is returned.
@@ -212,8 +213,8 @@ AVFilterFormats *ff_planar_sample_fmts(void);
 
 /**
  * Return a format list which contains the intersection of the formats of
- * a and b. Also, all the references of a, all the references of b, and
- * a and b themselves will be deallocated.
+ * a and b, in the order of a. The list of a is reduced in place and returned,
+ * and all the references of b are moved to it before b is deallocated.
  *
  * If a and b do not share any common formats, neither is modified, and NULL
  * is returned.
@@ -221,6 +222,16 @@ AVFilterFormats *ff_planar_sample_fmts(void);
 AVFilterFormats *ff_merge_formats(AVFilterFormats *a, AVFilterFormats *b,
                                   enum AVMediaType type);
 
+/**
+ * Check if ff_merge_formats()/ff_merge_samplerates() would succeed on a and b,
+ * without modifying or allocating anything.
+ *
+ * @return 1 if the lists can be merged, 0 otherwise
+ */
+int ff_can_merge_formats(const AVFilterFormats *a, const AVFilterFormats *b,
+                         enum AVMediaType type);
+int ff_can_merge_samplerates(const AVFilterFormats *a, const AVFilterFormats *b);
+
 /**
  * Add *ref as a new reference to formats.
  * That is the pointers will point like in the ascii art below:
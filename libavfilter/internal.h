@@ -159,6 +159,11 @@ struct AVFilterGraphInternal {
 
 struct AVFilterInternal {
     avfilter_execute_func *execute;
+
+    /**
+     * Lookup tables of a point operation filter, see pointop.h.
+     */
+    struct FFPointOp *point_op;
 };
 
 #if FF_API_AVFILTERBUFFER
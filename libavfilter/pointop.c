@@ -0,0 +1,323 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/dict.h"
+#include "libavutil/frame.h"
+#include "libavutil/mem.h"
+#include "libavutil/pixdesc.h"
+#include "avfilter.h"
+#include "internal.h"
+#include "pointop.h"
+#include "video.h"
+
+/* frame metadata holding the number of filters following the current one
+ * whose tables have already been applied to the frame */
+#define FUSED_KEY "lavfi.point_op.fused"
+
+typedef struct ThreadData {
+    AVFrame *in, *out;
+    const uint8_t (*lut)[256];
+    const uint8_t *lut_u;       ///< joint chroma tables, 256x256, or NULL
+    const uint8_t *lut_v;
+    const uint8_t *pre_u;       ///< per-plane chroma tables applied before them
+    const uint8_t *pre_v;
+} ThreadData;
+
+FFPointOp *ff_point_op_init(AVFilterContext *ctx)
+{
+    FFPointOp *op = ctx->internal->point_op;
+    int i, j;
+
+    if (!op) {
+        op = ctx->internal->point_op = av_mallocz(sizeof(*op));
+        if (!op)
+            return NULL;
+    }
+
+    for (i = 0; i < 4; i++)
+        for (j = 0; j < 256; j++)
+            op->lut[i][j] = j;
+    op->version++;
+
+    return op;
+}
+
+void ff_point_op_uninit(AVFilterContext *ctx)
+{
+    FFPointOp *op = ctx->internal->point_op;
+
+    if (op)
+        av_freep(&op->fused_uv);
+    av_freep(&ctx->internal->point_op);
+}
+
+/**
+ * Return the filter following ctx if it is a point operation which can be
+ * applied together with ctx to frame, NULL otherwise.
+ */
+static AVFilterContext *next_point_op(AVFilterContext *ctx, const AVFrame *frame)
+{
+    AVFilterLink *link;
+    AVFilterContext *next;
+    const AVFilterCommand *cmd;
+
+    if (ctx->nb_outputs != 1 || !(link = ctx->outputs[0]) || link->closed)
+        return NULL;
+
+    next = link->dst;
+    if (next->nb_inputs != 1 || !next->internal->point_op ||
+        link->dstpad->filter_frame != ff_point_op_filter_frame)
+        return NULL;
+
+    /* the timeline and the commands of the next filter are evaluated when
+     * the frame reaches it, too late to leave its tables out */
+    if (next->enable_str)
+        return NULL;
+    cmd = next->command_queue;
+    if (cmd && cmd->time <= frame->pts * av_q2d(link->time_base))
+        return NULL;
+
+    return next;
+}
+
+static int apply_lut_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    const ThreadData *td = arg;
+    const AVFrame *in  = td->in;
+    const AVFrame *out = td->out;
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(in->format);
+    const int nb_planes = av_pix_fmt_count_planes(in->format);
+    const int step = nb_planes == 1 ? av_get_padded_bits_per_pixel(desc) >> 3 : 1;
+    int plane, x, y;
+
+    for (plane = 0; plane < nb_planes; plane++) {
+        const int hsub = plane == 1 || plane == 2 ? desc->log2_chroma_w : 0;
+        const int vsub = plane == 1 || plane == 2 ? desc->log2_chroma_h : 0;
+        const int w = FF_CEIL_RSHIFT(in->width,  hsub) * step;
+        const int h = FF_CEIL_RSHIFT(in->height, vsub);
+        const int slice_start = (h *  jobnr   ) / nb_jobs;
+        const int slice_end   = (h * (jobnr+1)) / nb_jobs;
+        const uint8_t *src = in ->data[plane] + slice_start * in ->linesize[plane];
+        uint8_t       *dst = out->data[plane] + slice_start * out->linesize[plane];
+        const uint8_t *tab0 = td->lut[step == 1 ? plane : 0];
+        const uint8_t *tab1 = td->lut[1];
+        const uint8_t *tab2 = td->lut[2];
+        const uint8_t *tab3 = td->lut[3];
+
+        if (plane == 1 && td->lut_u) {
+            const uint8_t *srcv = in ->data[2] + slice_start * in ->linesize[2];
+            uint8_t       *dstv = out->data[2] + slice_start * out->linesize[2];
+            const uint8_t *tabu = td->lut_u, *preu = td->pre_u;
+            const uint8_t *tabv = td->lut_v, *prev = td->pre_v;
+
+            for (y = slice_start; y < slice_end; y++) {
+                for (x = 0; x < w; x++) {
+                    const int uv = preu[src[x]] << 8 | prev[srcv[x]];
+                    dst [x] = tabu[uv];
+                    dstv[x] = tabv[uv];
+                }
+                src  += in ->linesize[1];
+                dst  += out->linesize[1];
+                srcv += in ->linesize[2];
+                dstv += out->linesize[2];
+            }
+            plane++;
+            continue;
+        }
+
+        for (y = slice_start; y < slice_end; y++) {
+            switch (step) {
+            case 4:
+                for (x = 0; x < w; x += 4) {
+                    dst[x    ] = tab0[src[x    ]];
+                    dst[x + 1] = tab1[src[x + 1]];
+                    dst[x + 2] = tab2[src[x + 2]];
+                    dst[x + 3] = tab3[src[x + 3]];
+                }
+                break;
+            case 3:
+                for (x = 0; x < w; x += 3) {
+                    dst[x    ] = tab0[src[x    ]];
+                    dst[x + 1] = tab1[src[x + 1]];
+                    dst[x + 2] = tab2[src[x + 2]];
+                }
+                break;
+            default:
+                for (x = 0; x < w; x++)
+                    dst[x] = tab0[src[x]];
+            }
+            src += in ->linesize[plane];
+            dst += out->linesize[plane];
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Compose the chroma tables of the point operations ctx to last, already
+ * updated for the frame, into joint tables indexed by the chroma values
+ * after the per-plane tables of ctx. The tables are kept until the run or
+ * the tables of one of its filters change.
+ */
+static int compose_uv(AVFilterContext *ctx, AVFilterContext *last)
+{
+    FFPointOp *first = ctx->internal->point_op;
+    AVFilterContext *cur = ctx;
+    unsigned version = 0;
+    uint8_t *tabu, *tabv;
+    int u, v;
+
+    while (1) {
+        version += cur->internal->point_op->version;
+        if (cur == last)
+            break;
+        cur = cur->outputs[0]->dst;
+    }
+    if (first->fused_uv && first->fused_last == last &&
+        first->fused_version == version)
+        return 0;
+
+    if (!first->fused_uv &&
+        !(first->fused_uv = av_malloc(2 * 256 * 256)))
+        return AVERROR(ENOMEM);
+    tabu = first->fused_uv;
+    tabv = first->fused_uv + 256 * 256;
+
+    for (u = 0; u < 256; u++) {
+        for (v = 0; v < 256; v++) {
+            int cu = u, cv = v;
+
+            cur = ctx;
+            while (1) {
+                const FFPointOp *op = cur->internal->point_op;
+                if (cur != ctx) {
+                    cu = op->lut[1][cu];
+                    cv = op->lut[2][cv];
+                }
+                if (op->lut_u) {
+                    const int nu = op->lut_u[cu][cv];
+                    cv = op->lut_v[cu][cv];
+                    cu = nu;
+                }
+                if (cur == last)
+                    break;
+                cur = cur->outputs[0]->dst;
+            }
+            tabu[u << 8 | v] = cu;
+            tabv[u << 8 | v] = cv;
+        }
+    }
+    first->fused_last    = last;
+    first->fused_version = version;
+
+    return 0;
+}
+
+int ff_point_op_filter_frame(AVFilterLink *inlink, AVFrame *in)
+{
+    AVFilterContext *ctx = inlink->dst;
+    AVFilterLink *outlink = ctx->outputs[0];
+    FFPointOp *op = ctx->internal->point_op;
+    AVDictionary **metadata = avpriv_frame_get_metadatap(in);
+    AVDictionaryEntry *e = av_dict_get(*metadata, FUSED_KEY, NULL, 0);
+    const uint8_t (*lut)[256] = (const uint8_t (*)[256])op->lut;
+    uint8_t fused[4][256];
+    AVFilterContext *next, *last = ctx;
+    int joint_uv = !!op->lut_u;
+    int nb_fused = 0;
+    AVFrame *out;
+    ThreadData td;
+    int i, j, ret;
+
+    if (e) {
+        char buf[16];
+
+        /* already applied by a preceding filter */
+        nb_fused = strtol(e->value, NULL, 10) - 1;
+        snprintf(buf, sizeof(buf), "%d", nb_fused);
+        av_dict_set(metadata, FUSED_KEY, nb_fused > 0 ? buf : NULL, 0);
+        return ff_filter_frame(outlink, in);
+    }
+
+    if (op->update)
+        op->update(ctx, inlink, in);
+
+    for (next = next_point_op(ctx, in); next; next = next_point_op(next, in)) {
+        FFPointOp *next_op = next->internal->point_op;
+        const uint8_t (*next_lut)[256] = (const uint8_t (*)[256])next_op->lut;
+
+        if (next_op->update)
+            next_op->update(next, next->inputs[0], in);
+        for (i = 0; i < 4; i++)
+            for (j = 0; j < 256; j++)
+                fused[i][j] = next_lut[i][lut[i][j]];
+        lut = (const uint8_t (*)[256])fused;
+        joint_uv |= !!next_op->lut_u;
+        last = next;
+        nb_fused++;
+    }
+
+    td.lut_u = td.lut_v = NULL;
+    td.pre_u = op->lut[1];
+    td.pre_v = op->lut[2];
+    if (joint_uv && last == ctx) {
+        td.lut_u = op->lut_u[0];
+        td.lut_v = op->lut_v[0];
+    } else if (joint_uv) {
+        if ((ret = compose_uv(ctx, last)) < 0) {
+            av_frame_free(&in);
+            return ret;
+        }
+        td.lut_u = op->fused_uv;
+        td.lut_v = op->fused_uv + 256 * 256;
+    }
+
+    if (av_frame_is_writable(in)) {
+        out = in;
+    } else {
+        out = ff_get_video_buffer(outlink, outlink->w, outlink->h);
+        if (!out) {
+            av_frame_free(&in);
+            return AVERROR(ENOMEM);
+        }
+        av_frame_copy_props(out, in);
+    }
+
+    td.in  = in;
+    td.out = out;
+    td.lut = lut;
+    ctx->internal->execute(ctx, apply_lut_slice, &td, NULL, FFMIN(outlink->h, ctx->graph->nb_threads));
+
+    if (out != in)
+        av_frame_free(&in);
+
+    if (nb_fused) {
+        char buf[16];
+
+        snprintf(buf, sizeof(buf), "%d", nb_fused);
+        av_dict_set(avpriv_frame_get_metadatap(out), FUSED_KEY, buf, 0);
+    }
+
+    return ff_filter_frame(outlink, out);
+}
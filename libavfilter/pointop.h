@@ -0,0 +1,95 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_POINTOP_H
+#define AVFILTER_POINTOP_H
+
+/**
+ * @file
+ * point operations on 8-bit video
+ *
+ * A point operation maps every byte of a frame through a lookup table which
+ * only depends on the plane (planar formats) or on the position of the byte
+ * in the pixel (packed formats), optionally followed, for planar YUV, by a
+ * joint mapping of the U and V values of each chroma sample. Such operations
+ * compose, so consecutive point operation filters are applied together in a
+ * single pass over the frame by the first one of them.
+ */
+
+#include <stdint.h>
+
+#include "libavutil/frame.h"
+#include "avfilter.h"
+
+typedef struct FFPointOp {
+    /**
+     * Lookup table for each plane of a planar format, or for each byte of a
+     * pixel of a packed format.
+     */
+    uint8_t lut[4][256];
+
+    /**
+     * If set, the chroma planes of a planar YUV format are mapped jointly
+     * after lut: (u, v) becomes (lut_u[u][v], lut_v[u][v]).
+     */
+    const uint8_t (*lut_u)[256];
+    const uint8_t (*lut_v)[256];
+
+    /**
+     * If set, called once for each frame reaching the filter, before the
+     * tables are used for it, for filters whose tables depend on the frame.
+     * inlink->frame_count does not count the frame yet.
+     */
+    void (*update)(AVFilterContext *ctx, AVFilterLink *inlink, const AVFrame *frame);
+
+    /**
+     * Incremented by ff_point_op_init(), and by the filter each time it
+     * changes lut[1], lut[2], lut_u or lut_v afterwards.
+     */
+    unsigned version;
+
+    uint8_t *fused_uv;          ///< joint chroma tables of a fused run, 2x256x256
+    AVFilterContext *fused_last;///< last filter of the run fused_uv was built for
+    unsigned fused_version;     ///< sum of the versions of that run when built
+} FFPointOp;
+
+/**
+ * Declare the filter as a point operation and return its lookup tables,
+ * reset to the identity, for the filter to fill. To be called from a
+ * config_props callback once the format is known. The filter must then use
+ * ff_point_op_filter_frame() as the filter_frame callback of its only input.
+ *
+ * @return the lookup tables of the filter, NULL on allocation failure
+ */
+FFPointOp *ff_point_op_init(AVFilterContext *ctx);
+
+/**
+ * filter_frame callback of the point operation filters: apply the lookup
+ * tables of the filter, composed with the ones of the point operation
+ * filters directly following it, in one slice threaded pass. The frame is
+ * marked with the number of following filters applied, which then pass it
+ * through.
+ */
+int ff_point_op_filter_frame(AVFilterLink *inlink, AVFrame *in);
+
+/**
+ * Free the tables of the filter, if any.
+ */
+void ff_point_op_uninit(AVFilterContext *ctx);
+
+#endif /* AVFILTER_POINTOP_H */
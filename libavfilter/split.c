@@ -70,17 +70,29 @@ static av_cold void split_uninit(AVFilterContext *ctx)
 static int filter_frame(AVFilterLink *inlink, AVFrame *frame)
 {
     AVFilterContext *ctx = inlink->dst;
-    int i, ret = AVERROR_EOF;
+    int i, last, ret = AVERROR_EOF;
 
-    for (i = 0; i < ctx->nb_outputs; i++) {
+    for (last = ctx->nb_outputs - 1; last >= 0; last--)
+        if (!ctx->outputs[last]->closed)
+            break;
+
+    for (i = 0; i <= last; i++) {
         AVFrame *buf_out;
 
         if (ctx->outputs[i]->closed)
             continue;
-        buf_out = av_frame_clone(frame);
-        if (!buf_out) {
-            ret = AVERROR(ENOMEM);
-            break;
+
+        /* the last output gets the input frame itself, so that it is
+         * writable there once the other outputs are done with it */
+        if (i == last) {
+            buf_out = frame;
+            frame   = NULL;
+        } else {
+            buf_out = av_frame_clone(frame);
+            if (!buf_out) {
+                ret = AVERROR(ENOMEM);
+                break;
+            }
         }
 
         ret = ff_filter_frame(ctx->outputs[i], buf_out);
@@ -234,6 +234,7 @@ AVFilter ff_vf_trim = {
     .init        = init,
     .priv_size   = sizeof(TrimContext),
     .priv_class  = &trim_class,
+    .flags       = AVFILTER_FLAG_SUPPORT_RELINK,
     .inputs      = trim_inputs,
     .outputs     = trim_outputs,
 };
@@ -224,6 +224,7 @@ AVFilter ff_vf_setdar = {
     .init        = init,
     .priv_size   = sizeof(AspectContext),
     .priv_class  = &setdar_class,
+    .flags       = AVFILTER_FLAG_SUPPORT_RELINK,
     .inputs      = avfilter_vf_setdar_inputs,
     .outputs     = avfilter_vf_setdar_outputs,
 };
@@ -296,6 +297,7 @@ AVFilter ff_vf_setsar = {
     .init        = init,
     .priv_size   = sizeof(AspectContext),
     .priv_class  = &setsar_class,
+    .flags       = AVFILTER_FLAG_SUPPORT_RELINK,
     .inputs      = avfilter_vf_setsar_inputs,
     .outputs     = avfilter_vf_setsar_outputs,
 };
@@ -24,6 +24,7 @@
 #include "drawutils.h"
 #include "formats.h"
 #include "internal.h"
+#include "pointop.h"
 #include "video.h"
 
 #define R 0
@@ -42,11 +43,6 @@ typedef struct {
     Range cyan_red;
     Range magenta_green;
     Range yellow_blue;
-
-    uint8_t lut[3][256];
-
-    uint8_t rgba_map[4];
-    int step;
 } ColorBalanceContext;
 
 #define OFFSET(x) offsetof(ColorBalanceContext, x)
@@ -85,10 +81,15 @@ static int config_output(AVFilterLink *outlink)
 {
     AVFilterContext *ctx = outlink->src;
     ColorBalanceContext *cb = ctx->priv;
-    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(outlink->format);
+    FFPointOp *op = ff_point_op_init(ctx);
     double *shadows, *midtones, *highlights, *buffer;
+    uint8_t rgba_map[4];
     int i, r, g, b;
 
+    if (!op)
+        return AVERROR(ENOMEM);
+    ff_fill_rgba_map(rgba_map, outlink->format);
+
     buffer = av_malloc(256 * 3 * sizeof(*buffer));
     if (!buffer)
         return AVERROR(ENOMEM);
@@ -122,72 +123,21 @@ static int config_output(AVFilterLink *outlink)
         b = av_clip_uint8(b + cb->yellow_blue.midtones     * midtones[b]);
         b = av_clip_uint8(b + cb->yellow_blue.highlights   * highlights[b]);
 
-        cb->lut[R][i] = r;
-        cb->lut[G][i] = g;
-        cb->lut[B][i] = b;
+        op->lut[rgba_map[R]][i] = r;
+        op->lut[rgba_map[G]][i] = g;
+        op->lut[rgba_map[B]][i] = b;
     }
 
     av_free(buffer);
 
-    ff_fill_rgba_map(cb->rgba_map, outlink->format);
-    cb->step = av_get_padded_bits_per_pixel(desc) >> 3;
-
     return 0;
 }
 
-static int filter_frame(AVFilterLink *inlink, AVFrame *in)
-{
-    AVFilterContext *ctx = inlink->dst;
-    ColorBalanceContext *cb = ctx->priv;
-    AVFilterLink *outlink = ctx->outputs[0];
-    const uint8_t roffset = cb->rgba_map[R];
-    const uint8_t goffset = cb->rgba_map[G];
-    const uint8_t boffset = cb->rgba_map[B];
-    const uint8_t aoffset = cb->rgba_map[A];
-    const int step = cb->step;
-    const uint8_t *srcrow = in->data[0];
-    uint8_t *dstrow;
-    AVFrame *out;
-    int i, j;
-
-    if (av_frame_is_writable(in)) {
-        out = in;
-    } else {
-        out = ff_get_video_buffer(outlink, outlink->w, outlink->h);
-        if (!out) {
-            av_frame_free(&in);
-            return AVERROR(ENOMEM);
-        }
-        av_frame_copy_props(out, in);
-    }
-
-    dstrow = out->data[0];
-    for (i = 0; i < outlink->h; i++) {
-        const uint8_t *src = srcrow;
-        uint8_t *dst = dstrow;
-
-        for (j = 0; j < outlink->w * step; j += step) {
-            dst[j + roffset] = cb->lut[R][src[j + roffset]];
-            dst[j + goffset] = cb->lut[G][src[j + goffset]];
-            dst[j + boffset] = cb->lut[B][src[j + boffset]];
-            if (in != out && step == 4)
-                dst[j + aoffset] = src[j + aoffset];
-        }
-
-        srcrow += in->linesize[0];
-        dstrow += out->linesize[0];
-    }
-
-    if (in != out)
-        av_frame_free(&in);
-    return ff_filter_frame(ctx->outputs[0], out);
-}
-
 static const AVFilterPad colorbalance_inputs[] = {
     {
         .name         = "default",
         .type         = AVMEDIA_TYPE_VIDEO,
-        .filter_frame = filter_frame,
+        .filter_frame = ff_point_op_filter_frame,
     },
     { NULL }
 };
@@ -209,5 +159,5 @@ AVFilter ff_vf_colorbalance = {
     .query_formats = query_formats,
     .inputs        = colorbalance_inputs,
     .outputs       = colorbalance_outputs,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -29,6 +29,7 @@
 #include "drawutils.h"
 #include "formats.h"
 #include "internal.h"
+#include "pointop.h"
 #include "video.h"
 
 #define R 0
@@ -65,14 +66,8 @@ typedef struct {
     char *comp_points_str_all;
     uint8_t graph[NB_COMP + 1][256];
     char *psfile;
-    uint8_t rgba_map[4];
-    int step;
 } CurvesContext;
 
-typedef struct ThreadData {
-    AVFrame *in, *out;
-} ThreadData;
-
 #define OFFSET(x) offsetof(CurvesContext, x)
 #define FLAGS AV_OPT_FLAG_FILTERING_PARAM|AV_OPT_FLAG_VIDEO_PARAM
 static const AVOption curves_options[] = {
@@ -469,79 +464,25 @@ static int query_formats(AVFilterContext *ctx)
 static int config_input(AVFilterLink *inlink)
 {
     CurvesContext *curves = inlink->dst->priv;
-    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(inlink->format);
+    FFPointOp *op = ff_point_op_init(inlink->dst);
+    uint8_t rgba_map[4];
+    int i;
 
-    ff_fill_rgba_map(curves->rgba_map, inlink->format);
-    curves->step = av_get_padded_bits_per_pixel(desc) >> 3;
+    if (!op)
+        return AVERROR(ENOMEM);
 
-    return 0;
-}
+    ff_fill_rgba_map(rgba_map, inlink->format);
+    for (i = 0; i < NB_COMP; i++)
+        memcpy(op->lut[rgba_map[i]], curves->graph[i], sizeof(curves->graph[i]));
 
-static int filter_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
-{
-    int x, y;
-    const CurvesContext *curves = ctx->priv;
-    const ThreadData *td = arg;
-    const AVFrame *in  = td->in;
-    const AVFrame *out = td->out;
-    const int direct = out == in;
-    const int step = curves->step;
-    const uint8_t r = curves->rgba_map[R];
-    const uint8_t g = curves->rgba_map[G];
-    const uint8_t b = curves->rgba_map[B];
-    const uint8_t a = curves->rgba_map[A];
-    const int slice_start = (in->height *  jobnr   ) / nb_jobs;
-    const int slice_end   = (in->height * (jobnr+1)) / nb_jobs;
-    uint8_t       *dst = out->data[0] + slice_start * out->linesize[0];
-    const uint8_t *src =  in->data[0] + slice_start *  in->linesize[0];
-
-    for (y = slice_start; y < slice_end; y++) {
-        for (x = 0; x < in->width * step; x += step) {
-            dst[x + r] = curves->graph[R][src[x + r]];
-            dst[x + g] = curves->graph[G][src[x + g]];
-            dst[x + b] = curves->graph[B][src[x + b]];
-            if (!direct && step == 4)
-                dst[x + a] = src[x + a];
-        }
-        dst += out->linesize[0];
-        src += in ->linesize[0];
-    }
     return 0;
 }
 
-static int filter_frame(AVFilterLink *inlink, AVFrame *in)
-{
-    AVFilterContext *ctx = inlink->dst;
-    AVFilterLink *outlink = ctx->outputs[0];
-    AVFrame *out;
-    ThreadData td;
-
-    if (av_frame_is_writable(in)) {
-        out = in;
-    } else {
-        out = ff_get_video_buffer(outlink, outlink->w, outlink->h);
-        if (!out) {
-            av_frame_free(&in);
-            return AVERROR(ENOMEM);
-        }
-        av_frame_copy_props(out, in);
-    }
-
-    td.in  = in;
-    td.out = out;
-    ctx->internal->execute(ctx, filter_slice, &td, NULL, FFMIN(outlink->h, ctx->graph->nb_threads));
-
-    if (out != in)
-        av_frame_free(&in);
-
-    return ff_filter_frame(outlink, out);
-}
-
 static const AVFilterPad curves_inputs[] = {
     {
         .name         = "default",
         .type         = AVMEDIA_TYPE_VIDEO,
-        .filter_frame = filter_frame,
+        .filter_frame = ff_point_op_filter_frame,
         .config_props = config_input,
     },
     { NULL }
@@ -121,6 +121,24 @@ enum expansion_mode {
     EXP_STRFTIME,
 };
 
+/**
+ * 8-bit coverage bitmap of a whole rendered text, the linesize is w.
+ */
+typedef struct {
+    uint8_t *buf;
+    unsigned int buf_size;
+    int x, y;                       ///< position relative to the text origin
+    int w, h;
+} TextBitmap;
+
+/**
+ * Glyph of a rendered text, newlines and tabs excluded.
+ */
+typedef struct {
+    uint32_t code;
+    int x, y;                       ///< position relative to the text origin
+} TextGlyph;
+
 typedef struct {
     const AVClass *class;
     enum expansion_mode exp_mode;   ///< expansion mode to use for the text
@@ -173,6 +191,17 @@ typedef struct {
     int reload;                     ///< reload text file for each frame
     int start_number;               ///< starting frame number for n/frame_num var
     AVDictionary *metadata;
+
+    char *rendered_text;            ///< text the positions and bitmaps were computed for
+    unsigned int rendered_text_size;
+    TextBitmap text_bitmap;         ///< glyphs of the rendered text
+    TextBitmap border_bitmap;       ///< glyph borders of the rendered text
+    TextGlyph *text_glyphs;         ///< glyphs of the rendered text
+    unsigned int text_glyphs_size;
+    int nb_text_glyphs;
+    TextGlyph *prev_text_glyphs;    ///< glyphs of the previously rendered text
+    unsigned int prev_text_glyphs_size;
+    int nb_prev_text_glyphs;
 } DrawTextContext;
 
 #define OFFSET(x) offsetof(DrawTextContext, x)
@@ -568,6 +597,18 @@ static av_cold void uninit(AVFilterContext *ctx)
     av_freep(&s->positions);
     s->nb_positions = 0;
 
+    av_freep(&s->rendered_text);
+    s->rendered_text_size = 0;
+    av_freep(&s->text_bitmap.buf);
+    s->text_bitmap.buf_size = 0;
+    av_freep(&s->border_bitmap.buf);
+    s->border_bitmap.buf_size = 0;
+    av_freep(&s->text_glyphs);
+    s->text_glyphs_size = 0;
+    s->nb_text_glyphs = 0;
+    av_freep(&s->prev_text_glyphs);
+    s->prev_text_glyphs_size = 0;
+    s->nb_prev_text_glyphs = 0;
 
     av_tree_enumerate(s->glyphs, NULL, NULL, glyph_enu_free);
     av_tree_destroy(s->glyphs);
@@ -843,59 +884,144 @@ static int expand_text(AVFilterContext *ctx)
     return 0;
 }
 
-static int draw_glyphs(DrawTextContext *s, AVFrame *frame,
-                       int width, int height, const uint8_t rgbcolor[4],
-                       FFDrawColor *color, int x, int y, int borderw)
+/**
+ * Get the bitmap of g and the rectangle it covers in the text, as
+ * x0, y0, x1, y1.
+ */
+static int get_glyph_rect(DrawTextContext *s, const TextGlyph *g, int borderw,
+                          FT_Bitmap *bitmap, int rect[4])
 {
-    char *text = s->expanded_text.str;
-    uint32_t code = 0;
-    int i, x1, y1;
-    uint8_t *p;
-    Glyph *glyph = NULL;
+    Glyph dummy = { 0 }, *glyph;
 
-    for (i = 0, p = text; *p; i++) {
-        FT_Bitmap bitmap;
-        Glyph dummy = { 0 };
-        GET_UTF8(code, *p++, continue;);
+    dummy.code = g->code;
+    glyph = av_tree_find(s->glyphs, &dummy, (void *)glyph_cmp, NULL);
 
-        /* skip new line chars, just go to new line */
-        if (code == '\n' || code == '\r' || code == '\t')
-            continue;
+    if (glyph->bitmap.pixel_mode != FT_PIXEL_MODE_MONO &&
+        glyph->bitmap.pixel_mode != FT_PIXEL_MODE_GRAY)
+        return AVERROR(EINVAL);
 
-        dummy.code = code;
-        glyph = av_tree_find(s->glyphs, &dummy, (void *)glyph_cmp, NULL);
+    *bitmap = borderw ? glyph->border_bitmap : glyph->bitmap;
+    rect[0] = g->x - borderw;
+    rect[1] = g->y - borderw;
+    rect[2] = rect[0] + bitmap->width;
+    rect[3] = rect[1] + bitmap->rows;
+    return 0;
+}
 
-        bitmap = borderw ? glyph->border_bitmap : glyph->bitmap;
+static void merge_rect(int dst[4], const int rect[4])
+{
+    dst[0] = FFMIN(dst[0], rect[0]);
+    dst[1] = FFMIN(dst[1], rect[1]);
+    dst[2] = FFMAX(dst[2], rect[2]);
+    dst[3] = FFMAX(dst[3], rect[3]);
+}
 
-        if (glyph->bitmap.pixel_mode != FT_PIXEL_MODE_MONO &&
-            glyph->bitmap.pixel_mode != FT_PIXEL_MODE_GRAY)
-            return AVERROR(EINVAL);
+/**
+ * Merge the bitmaps of the glyphs of the rendered text into tb.
+ *
+ * If tb holds the previous text with the same extent, only the area of the
+ * glyphs which changed is redrawn, so a text where a few characters change
+ * at each frame, like a timecode, is not rendered again as a whole.
+ */
+static int render_text_bitmap(DrawTextContext *s, TextBitmap *tb, int borderw)
+{
+    int bbox[4]  = { INT_MAX, INT_MAX, INT_MIN, INT_MIN };
+    int dirty[4] = { INT_MAX, INT_MAX, INT_MIN, INT_MIN };
+    int rect[4];
+    int i, x, y, ret;
+    FT_Bitmap bitmap;
+
+    for (i = 0; i < s->nb_text_glyphs; i++) {
+        if ((ret = get_glyph_rect(s, &s->text_glyphs[i], borderw, &bitmap, rect)) < 0)
+            return ret;
+        merge_rect(bbox, rect);
+    }
+    if (bbox[0] >= bbox[2] || bbox[1] >= bbox[3]) {
+        tb->w = tb->h = 0;
+        return 0;
+    }
 
-        x1 = s->positions[i].x+s->x+x - borderw;
-        y1 = s->positions[i].y+s->y+y - borderw;
+    if (tb->buf && tb->x == bbox[0] && tb->y == bbox[1] &&
+        tb->w == bbox[2] - bbox[0] && tb->h == bbox[3] - bbox[1]) {
+        for (i = 0; i < FFMAX(s->nb_text_glyphs, s->nb_prev_text_glyphs); i++) {
+            const TextGlyph *g    = &s->text_glyphs[i];
+            const TextGlyph *prev = &s->prev_text_glyphs[i];
+
+            if (i < s->nb_text_glyphs && i < s->nb_prev_text_glyphs &&
+                g->code == prev->code && g->x == prev->x && g->y == prev->y)
+                continue;
+            if (i < s->nb_prev_text_glyphs) {
+                if ((ret = get_glyph_rect(s, prev, borderw, &bitmap, rect)) < 0)
+                    return ret;
+                merge_rect(dirty, rect);
+            }
+            if (i < s->nb_text_glyphs) {
+                if ((ret = get_glyph_rect(s, g, borderw, &bitmap, rect)) < 0)
+                    return ret;
+                merge_rect(dirty, rect);
+            }
+        }
+        dirty[0] = FFMAX(dirty[0], bbox[0]);
+        dirty[1] = FFMAX(dirty[1], bbox[1]);
+        dirty[2] = FFMIN(dirty[2], bbox[2]);
+        dirty[3] = FFMIN(dirty[3], bbox[3]);
+        if (dirty[0] >= dirty[2] || dirty[1] >= dirty[3])
+            return 0;
+    } else {
+        tb->x = bbox[0];
+        tb->y = bbox[1];
+        tb->w = bbox[2] - bbox[0];
+        tb->h = bbox[3] - bbox[1];
+        av_fast_malloc(&tb->buf, &tb->buf_size, tb->w * tb->h);
+        if (!tb->buf) {
+            tb->w = tb->h = 0;
+            return AVERROR(ENOMEM);
+        }
+        memcpy(dirty, bbox, sizeof(dirty));
+    }
 
-        ff_blend_mask(&s->dc, color,
-                      frame->data, frame->linesize, width, height,
-                      bitmap.buffer, bitmap.pitch,
-                      bitmap.width, bitmap.rows,
-                      bitmap.pixel_mode == FT_PIXEL_MODE_MONO ? 0 : 3,
-                      0, x1, y1);
+    for (y = dirty[1]; y < dirty[3]; y++)
+        memset(tb->buf + (y - tb->y) * tb->w + dirty[0] - tb->x, 0,
+               dirty[2] - dirty[0]);
+
+    for (i = 0; i < s->nb_text_glyphs; i++) {
+        int x0, y0, x1, y1;
+
+        get_glyph_rect(s, &s->text_glyphs[i], borderw, &bitmap, rect);
+        x0 = FFMAX(rect[0], dirty[0]);
+        y0 = FFMAX(rect[1], dirty[1]);
+        x1 = FFMIN(rect[2], dirty[2]);
+        y1 = FFMIN(rect[3], dirty[3]);
+
+        for (y = y0; y < y1; y++) {
+            const uint8_t *src = bitmap.buffer + (y - rect[1]) * bitmap.pitch;
+            uint8_t *dst = tb->buf + (y - tb->y) * tb->w + rect[0] - tb->x;
+
+            if (bitmap.pixel_mode == FT_PIXEL_MODE_MONO) {
+                for (x = x0 - rect[0]; x < x1 - rect[0]; x++)
+                    if (src[x >> 3] & (0x80 >> (x & 7)))
+                        dst[x] = 255;
+            } else {
+                for (x = x0 - rect[0]; x < x1 - rect[0]; x++)
+                    dst[x] = FFMAX(dst[x], src[x]);
+            }
+        }
     }
 
     return 0;
 }
 
-static int draw_text(AVFilterContext *ctx, AVFrame *frame,
-                     int width, int height)
+/**
+ * Compute the position of each glyph of the expanded text and the text
+ * metrics, and render the text bitmaps.
+ */
+static int layout_text(AVFilterContext *ctx)
 {
     DrawTextContext *s = ctx->priv;
-    AVFilterLink *inlink = ctx->inputs[0];
-
     uint32_t code = 0, prev_code = 0;
     int x = 0, y = 0, i = 0, ret;
     int max_text_line_w = 0, len;
-    int box_w, box_h;
-    char *text;
+    char *text = s->expanded_text.str;
     uint8_t *p;
     int y_min = 32000, y_max = -32000;
     int x_min = 32000, x_max = -32000;
@@ -903,39 +1029,6 @@ static int draw_text(AVFilterContext *ctx, AVFrame *frame,
     Glyph *glyph = NULL, *prev_glyph = NULL;
     Glyph dummy = { 0 };
 
-    time_t now = time(0);
-    struct tm ltime;
-    AVBPrint *bp = &s->expanded_text;
-
-    av_bprint_clear(bp);
-
-    if(s->basetime != AV_NOPTS_VALUE)
-        now= frame->pts*av_q2d(ctx->inputs[0]->time_base) + s->basetime/1000000;
-
-    switch (s->exp_mode) {
-    case EXP_NONE:
-        av_bprintf(bp, "%s", s->text);
-        break;
-    case EXP_NORMAL:
-        if ((ret = expand_text(ctx)) < 0)
-            return ret;
-        break;
-    case EXP_STRFTIME:
-        localtime_r(&now, &ltime);
-        av_bprint_strftime(bp, s->text, &ltime);
-        break;
-    }
-
-    if (s->tc_opt_string) {
-        char tcbuf[AV_TIMECODE_STR_SIZE];
-        av_timecode_make_string(&s->tc, tcbuf, inlink->frame_count);
-        av_bprint_clear(bp);
-        av_bprintf(bp, "%s%s", s->text, tcbuf);
-    }
-
-    if (!av_bprint_is_complete(bp))
-        return AVERROR(ENOMEM);
-    text = s->expanded_text.str;
     if ((len = s->expanded_text.len) > s->nb_positions) {
         if (!(s->positions =
               av_realloc(s->positions, len*sizeof(*s->positions))))
@@ -943,9 +1036,6 @@ static int draw_text(AVFilterContext *ctx, AVFrame *frame,
         s->nb_positions = len;
     }
 
-    x = 0;
-    y = 0;
-
     /* load and cache glyphs */
     for (i = 0, p = text; *p; i++) {
         GET_UTF8(code, *p++, continue;);
@@ -1014,6 +1104,163 @@ static int draw_text(AVFilterContext *ctx, AVFrame *frame,
 
     s->var_values[VAR_LINE_H] = s->var_values[VAR_LH] = s->max_glyph_h;
 
+    /* the glyphs of the last text are kept to only redraw the changed ones */
+    FFSWAP(TextGlyph *,   s->text_glyphs,      s->prev_text_glyphs);
+    FFSWAP(unsigned int,  s->text_glyphs_size, s->prev_text_glyphs_size);
+    FFSWAP(int,           s->nb_text_glyphs,   s->nb_prev_text_glyphs);
+    av_fast_malloc(&s->text_glyphs, &s->text_glyphs_size,
+                   len * sizeof(*s->text_glyphs));
+    if (!s->text_glyphs && len)
+        return AVERROR(ENOMEM);
+    s->nb_text_glyphs = 0;
+    for (i = 0, p = text; *p; i++) {
+        TextGlyph *g = &s->text_glyphs[s->nb_text_glyphs];
+        GET_UTF8(code, *p++, continue;);
+
+        if (is_newline(code) || code == '\t')
+            continue;
+        g->code = code;
+        g->x    = s->positions[i].x;
+        g->y    = s->positions[i].y;
+        s->nb_text_glyphs++;
+    }
+
+    if ((ret = render_text_bitmap(s, &s->text_bitmap, 0)) < 0)
+        return ret;
+    if (s->borderw &&
+        (ret = render_text_bitmap(s, &s->border_bitmap, s->borderw)) < 0)
+        return ret;
+
+    av_fast_malloc(&s->rendered_text, &s->rendered_text_size, len + 1);
+    if (!s->rendered_text)
+        return AVERROR(ENOMEM);
+    memcpy(s->rendered_text, text, len + 1);
+
+    return 0;
+}
+
+typedef struct ThreadData {
+    AVFrame *frame;
+    int box_w, box_h;
+    int start, end;                 ///< rows covered by the text
+} ThreadData;
+
+static void blend_bitmap(DrawTextContext *s, AVFrame *frame, FFDrawColor *color,
+                         const TextBitmap *tb, int x, int y, int start, int end)
+{
+    int top    = FFMAX(y + tb->y, start);
+    int bottom = FFMIN(y + tb->y + tb->h, end);
+
+    if (top >= bottom)
+        return;
+    ff_blend_mask(&s->dc, color, frame->data, frame->linesize,
+                  frame->width, frame->height,
+                  tb->buf + (top - y - tb->y) * tb->w, tb->w,
+                  tb->w, bottom - top, 3, 0, x + tb->x, top);
+}
+
+/**
+ * Draw the rows of the text belonging to slice jobnr. The slices are
+ * aligned on chroma rows, so each one can be blended independently.
+ */
+static int draw_text_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    DrawTextContext *s = ctx->priv;
+    ThreadData *td = arg;
+    AVFrame *frame = td->frame;
+    int vsub = s->dc.vsub_max;
+    int nb_blocks = (td->end - td->start + (1 << vsub) - 1) >> vsub;
+    int start = td->start + ((nb_blocks *  jobnr   ) / nb_jobs << vsub);
+    int end   = td->start + ((nb_blocks * (jobnr+1)) / nb_jobs << vsub);
+
+    end = FFMIN(end, td->end);
+
+    /* draw box */
+    if (s->draw_box) {
+        int top    = FFMAX(s->y, start);
+        int bottom = FFMIN(s->y + td->box_h, end);
+        if (top < bottom)
+            ff_blend_rectangle(&s->dc, &s->boxcolor,
+                               frame->data, frame->linesize,
+                               frame->width, frame->height,
+                               s->x, top, td->box_w, bottom - top);
+    }
+
+    if (s->shadowx || s->shadowy)
+        blend_bitmap(s, frame, &s->shadowcolor, &s->text_bitmap,
+                     s->x + s->shadowx, s->y + s->shadowy, start, end);
+
+    if (s->borderw)
+        blend_bitmap(s, frame, &s->bordercolor, &s->border_bitmap,
+                     s->x, s->y, start, end);
+
+    blend_bitmap(s, frame, &s->fontcolor, &s->text_bitmap,
+                 s->x, s->y, start, end);
+
+    return 0;
+}
+
+static void update_text_rows(ThreadData *td, const TextBitmap *tb, int y)
+{
+    if (!tb->h)
+        return;
+    td->start = FFMIN(td->start, y + tb->y);
+    td->end   = FFMAX(td->end,   y + tb->y + tb->h);
+}
+
+static int draw_text(AVFilterContext *ctx, AVFrame *frame,
+                     int width, int height)
+{
+    DrawTextContext *s = ctx->priv;
+    AVFilterLink *inlink = ctx->inputs[0];
+    ThreadData td;
+    int ret, nb_jobs;
+
+    time_t now = time(0);
+    struct tm ltime;
+    AVBPrint *bp = &s->expanded_text;
+
+    av_bprint_clear(bp);
+
+    if(s->basetime != AV_NOPTS_VALUE)
+        now= frame->pts*av_q2d(ctx->inputs[0]->time_base) + s->basetime/1000000;
+
+    switch (s->exp_mode) {
+    case EXP_NONE:
+        av_bprintf(bp, "%s", s->text);
+        break;
+    case EXP_NORMAL:
+        if ((ret = expand_text(ctx)) < 0)
+            return ret;
+        break;
+    case EXP_STRFTIME:
+        localtime_r(&now, &ltime);
+        av_bprint_strftime(bp, s->text, &ltime);
+        break;
+    }
+
+    if (s->tc_opt_string) {
+        char tcbuf[AV_TIMECODE_STR_SIZE];
+        av_timecode_make_string(&s->tc, tcbuf, inlink->frame_count);
+        av_bprint_clear(bp);
+        av_bprintf(bp, "%s%s", s->text, tcbuf);
+    }
+
+    if (!av_bprint_is_complete(bp))
+        return AVERROR(ENOMEM);
+
+    /* the layout and the bitmaps only depend on the text, so they are
+     * reused as long as it does not change */
+    if (!s->rendered_text || strcmp(s->rendered_text, bp->str)) {
+        if ((ret = layout_text(ctx)) < 0) {
+            av_freep(&s->rendered_text);
+            s->rendered_text_size = 0;
+            s->text_bitmap.w   = s->text_bitmap.h   = 0;
+            s->border_bitmap.w = s->border_bitmap.h = 0;
+            return ret;
+        }
+    }
+
     s->x = s->var_values[VAR_X] = av_expr_eval(s->x_pexpr, s->var_values, &s->prng);
     s->y = s->var_values[VAR_Y] = av_expr_eval(s->y_pexpr, s->var_values, &s->prng);
     s->x = s->var_values[VAR_X] = av_expr_eval(s->x_pexpr, s->var_values, &s->prng);
@@ -1028,29 +1275,31 @@ static int draw_text(AVFilterContext *ctx, AVFrame *frame,
         return 0;
 #endif
 
-    box_w = FFMIN(width - 1 , max_text_line_w);
-    box_h = FFMIN(height - 1, y + s->max_glyph_h);
+    td.frame = frame;
+    td.box_w = FFMIN(width - 1 , (int)s->var_values[VAR_TEXT_W]);
+    td.box_h = FFMIN(height - 1, (int)s->var_values[VAR_TEXT_H]);
+    td.start = INT_MAX;
+    td.end   = INT_MIN;
 
-    /* draw box */
-    if (s->draw_box)
-        ff_blend_rectangle(&s->dc, &s->boxcolor,
-                           frame->data, frame->linesize, width, height,
-                           s->x, s->y, box_w, box_h);
-
-    if (s->shadowx || s->shadowy) {
-        if ((ret = draw_glyphs(s, frame, width, height, s->shadowcolor.rgba,
-                               &s->shadowcolor, s->shadowx, s->shadowy, 0)) < 0)
-            return ret;
+    if (s->draw_box && td.box_h > 0) {
+        td.start = s->y;
+        td.end   = s->y + td.box_h;
     }
+    if (s->shadowx || s->shadowy)
+        update_text_rows(&td, &s->text_bitmap, s->y + s->shadowy);
+    if (s->borderw)
+        update_text_rows(&td, &s->border_bitmap, s->y);
+    update_text_rows(&td, &s->text_bitmap, s->y);
+
+    td.start = FFMAX(td.start, 0);
+    td.end   = FFMIN(td.end, height);
+    if (td.start >= td.end)
+        return 0;
+    td.start &= ~((1 << s->dc.vsub_max) - 1);
 
-    if (s->borderw) {
-        if ((ret = draw_glyphs(s, frame, width, height, s->bordercolor.rgba,
-                               &s->bordercolor, 0, 0, s->borderw)) < 0)
-            return ret;
-    }
-    if ((ret = draw_glyphs(s, frame, width, height, s->fontcolor.rgba,
-                           &s->fontcolor, 0, 0, 0)) < 0)
-        return ret;
+    nb_jobs = (td.end - td.start + (1 << s->dc.vsub_max) - 1) >> s->dc.vsub_max;
+    ctx->internal->execute(ctx, draw_text_slice, &td, NULL,
+                           FFMIN(nb_jobs, ctx->graph->nb_threads));
 
     return 0;
 }
@@ -1114,8 +1363,8 @@ AVFilter ff_vf_drawtext = {
     .outputs       = avfilter_vf_drawtext_outputs,
     .process_command = command,
 #if FF_API_DRAWTEXT_OLD_TIMELINE
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_INTERNAL,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_INTERNAL | AVFILTER_FLAG_SLICE_THREADS,
 #else
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
 #endif
 };
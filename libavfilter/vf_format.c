@@ -138,6 +138,7 @@ AVFilter ff_vf_format = {
     .query_formats = query_formats_format,
     .priv_size     = sizeof(FormatContext),
     .priv_class    = &format_class,
+    .flags         = AVFILTER_FLAG_SUPPORT_RELINK,
     .inputs        = avfilter_vf_format_inputs,
     .outputs       = avfilter_vf_format_outputs,
 };
@@ -177,6 +178,7 @@ AVFilter ff_vf_noformat = {
     .query_formats = query_formats_noformat,
     .priv_size     = sizeof(FormatContext),
     .priv_class    = &noformat_class,
+    .flags         = AVFILTER_FLAG_SUPPORT_RELINK,
     .inputs        = avfilter_vf_noformat_inputs,
     .outputs       = avfilter_vf_noformat_outputs,
 };
@@ -27,14 +27,12 @@
 
 #include <float.h>
 #include "libavutil/eval.h"
-#include "libavutil/imgutils.h"
 #include "libavutil/opt.h"
-#include "libavutil/pixdesc.h"
 
 #include "avfilter.h"
 #include "formats.h"
 #include "internal.h"
-#include "video.h"
+#include "pointop.h"
 
 #define SAT_MIN_VAL -10
 #define SAT_MAX_VAL 10
@@ -71,8 +69,6 @@ typedef struct {
     float    brightness;
     char     *brightness_expr;
     AVExpr   *brightness_pexpr;
-    int      hsub;
-    int      vsub;
     int is_first;
     int32_t hue_sin;
     int32_t hue_cos;
@@ -239,84 +235,19 @@ static int query_formats(AVFilterContext *ctx)
     return 0;
 }
 
-static int config_props(AVFilterLink *inlink)
-{
-    HueContext *hue = inlink->dst->priv;
-    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(inlink->format);
-
-    hue->hsub = desc->log2_chroma_w;
-    hue->vsub = desc->log2_chroma_h;
-
-    hue->var_values[VAR_N]  = 0;
-    hue->var_values[VAR_TB] = av_q2d(inlink->time_base);
-    hue->var_values[VAR_R]  = inlink->frame_rate.num == 0 || inlink->frame_rate.den == 0 ?
-        NAN : av_q2d(inlink->frame_rate);
-
-    return 0;
-}
-
-static void apply_luma_lut(HueContext *s,
-                           uint8_t *ldst, const int dst_linesize,
-                           uint8_t *lsrc, const int src_linesize,
-                           int w, int h)
-{
-    int i;
-
-    while (h--) {
-        for (i = 0; i < w; i++)
-            ldst[i] = s->lut_l[lsrc[i]];
-
-        lsrc += src_linesize;
-        ldst += dst_linesize;
-    }
-}
-
-static void apply_lut(HueContext *s,
-                      uint8_t *udst, uint8_t *vdst, const int dst_linesize,
-                      uint8_t *usrc, uint8_t *vsrc, const int src_linesize,
-                      int w, int h)
-{
-    int i;
-
-    while (h--) {
-        for (i = 0; i < w; i++) {
-            const int u = usrc[i];
-            const int v = vsrc[i];
-
-            udst[i] = s->lut_u[u][v];
-            vdst[i] = s->lut_v[u][v];
-        }
-
-        usrc += src_linesize;
-        vsrc += src_linesize;
-        udst += dst_linesize;
-        vdst += dst_linesize;
-    }
-}
-
 #define TS2D(ts) ((ts) == AV_NOPTS_VALUE ? NAN : (double)(ts))
 #define TS2T(ts, tb) ((ts) == AV_NOPTS_VALUE ? NAN : (double)(ts) * av_q2d(tb))
 
-static int filter_frame(AVFilterLink *inlink, AVFrame *inpic)
+/**
+ * Update the tables for the frame reaching inlink.
+ */
+static void update(AVFilterContext *ctx, AVFilterLink *inlink, const AVFrame *inpic)
 {
-    HueContext *hue = inlink->dst->priv;
-    AVFilterLink *outlink = inlink->dst->outputs[0];
-    AVFrame *outpic;
+    HueContext *hue = ctx->priv;
+    FFPointOp *op = ctx->internal->point_op;
     const int32_t old_hue_sin = hue->hue_sin, old_hue_cos = hue->hue_cos;
     const float old_brightness = hue->brightness;
-    int direct = 0;
-
-    if (av_frame_is_writable(inpic)) {
-        direct = 1;
-        outpic = inpic;
-    } else {
-        outpic = ff_get_video_buffer(outlink, outlink->w, outlink->h);
-        if (!outpic) {
-            av_frame_free(&inpic);
-            return AVERROR(ENOMEM);
-        }
-        av_frame_copy_props(outpic, inpic);
-    }
+    int i;
 
     hue->var_values[VAR_N]   = inlink->frame_count;
     hue->var_values[VAR_T]   = TS2T(inpic->pts, inlink->time_base);
@@ -327,7 +258,7 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *inpic)
 
         if (hue->saturation < SAT_MIN_VAL || hue->saturation > SAT_MAX_VAL) {
             hue->saturation = av_clip(hue->saturation, SAT_MIN_VAL, SAT_MAX_VAL);
-            av_log(inlink->dst, AV_LOG_WARNING,
+            av_log(ctx, AV_LOG_WARNING,
                    "Saturation value not in range [%d,%d]: clipping value to %0.1f\n",
                    SAT_MIN_VAL, SAT_MAX_VAL, hue->saturation);
         }
@@ -338,7 +269,7 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *inpic)
 
         if (hue->brightness < -10 || hue->brightness > 10) {
             hue->brightness = av_clipf(hue->brightness, -10, 10);
-            av_log(inlink->dst, AV_LOG_WARNING,
+            av_log(ctx, AV_LOG_WARNING,
                    "Brightness value not in range [%d,%d]: clipping value to %0.1f\n",
                    -10, 10, hue->brightness);
         }
@@ -352,42 +283,46 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *inpic)
         hue->hue_deg = hue->hue * 180 / M_PI;
     }
 
-    av_log(inlink->dst, AV_LOG_DEBUG,
+    av_log(ctx, AV_LOG_DEBUG,
            "H:%0.1f*PI h:%0.1f s:%0.1f b:%0.f t:%0.1f n:%d\n",
            hue->hue/M_PI, hue->hue_deg, hue->saturation, hue->brightness,
            hue->var_values[VAR_T], (int)hue->var_values[VAR_N]);
 
     compute_sin_and_cos(hue);
-    if (hue->is_first || (old_hue_sin != hue->hue_sin || old_hue_cos != hue->hue_cos))
+    if (hue->is_first || (old_hue_sin != hue->hue_sin || old_hue_cos != hue->hue_cos)) {
         create_chrominance_lut(hue, hue->hue_cos, hue->hue_sin);
+        op->version++;
+    }
 
     if (hue->is_first || (old_brightness != hue->brightness && hue->brightness))
         create_luma_lut(hue);
 
-    if (!direct) {
-        if (!hue->brightness)
-            av_image_copy_plane(outpic->data[0], outpic->linesize[0],
-                                inpic->data[0],  inpic->linesize[0],
-                                inlink->w, inlink->h);
-        if (inpic->data[3])
-            av_image_copy_plane(outpic->data[3], outpic->linesize[3],
-                                inpic->data[3],  inpic->linesize[3],
-                                inlink->w, inlink->h);
-    }
+    for (i = 0; i < 256; i++)
+        op->lut[0][i] = hue->brightness ? hue->lut_l[i] : i;
+
+    hue->is_first = 0;
+}
 
-    apply_lut(hue, outpic->data[1], outpic->data[2], outpic->linesize[1],
-              inpic->data[1],  inpic->data[2],  inpic->linesize[1],
-              FF_CEIL_RSHIFT(inlink->w, hue->hsub),
-              FF_CEIL_RSHIFT(inlink->h, hue->vsub));
-    if (hue->brightness)
-        apply_luma_lut(hue, outpic->data[0], outpic->linesize[0],
-                       inpic->data[0], inpic->linesize[0], inlink->w, inlink->h);
+static int config_props(AVFilterLink *inlink)
+{
+    HueContext *hue = inlink->dst->priv;
+    FFPointOp *op;
 
-    if (!direct)
-        av_frame_free(&inpic);
+    hue->var_values[VAR_N]  = 0;
+    hue->var_values[VAR_TB] = av_q2d(inlink->time_base);
+    hue->var_values[VAR_R]  = inlink->frame_rate.num == 0 || inlink->frame_rate.den == 0 ?
+        NAN : av_q2d(inlink->frame_rate);
 
-    hue->is_first = 0;
-    return ff_filter_frame(outlink, outpic);
+    /* the luma and the alpha go through lut, the chroma through lut_u and
+     * lut_v, and the tables are updated for each frame */
+    op = ff_point_op_init(inlink->dst);
+    if (!op)
+        return AVERROR(ENOMEM);
+    op->lut_u  = (const uint8_t (*)[256])hue->lut_u;
+    op->lut_v  = (const uint8_t (*)[256])hue->lut_v;
+    op->update = update;
+
+    return 0;
 }
 
 static int process_command(AVFilterContext *ctx, const char *cmd, const char *args,
@@ -424,7 +359,7 @@ static const AVFilterPad hue_inputs[] = {
     {
         .name         = "default",
         .type         = AVMEDIA_TYPE_VIDEO,
-        .filter_frame = filter_frame,
+        .filter_frame = ff_point_op_filter_frame,
         .config_props = config_props,
     },
     { NULL }
@@ -449,5 +384,5 @@ AVFilter ff_vf_hue = {
     .inputs          = hue_inputs,
     .outputs         = hue_outputs,
     .priv_class      = &hue_class,
-    .flags           = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags           = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
 };
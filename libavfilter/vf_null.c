@@ -45,6 +45,7 @@ static const AVFilterPad avfilter_vf_null_outputs[] = {
 AVFilter ff_vf_null = {
     .name        = "null",
     .description = NULL_IF_CONFIG_SMALL("Pass the source unchanged to the output."),
+    .flags       = AVFILTER_FLAG_SUPPORT_RELINK,
     .inputs      = avfilter_vf_null_inputs,
     .outputs     = avfilter_vf_null_outputs,
 };
@@ -38,6 +38,7 @@
 #include "dualinput.h"
 #include "drawutils.h"
 #include "video.h"
+#include "vf_overlay.h"
 
 static const char *const var_names[] = {
     "main_w",    "W", ///< width  of the main    video
@@ -54,27 +55,6 @@ static const char *const var_names[] = {
     NULL
 };
 
-enum var_name {
-    VAR_MAIN_W,    VAR_MW,
-    VAR_MAIN_H,    VAR_MH,
-    VAR_OVERLAY_W, VAR_OW,
-    VAR_OVERLAY_H, VAR_OH,
-    VAR_HSUB,
-    VAR_VSUB,
-    VAR_X,
-    VAR_Y,
-    VAR_N,
-    VAR_POS,
-    VAR_T,
-    VAR_VARS_NB
-};
-
-enum EOFAction {
-    EOF_ACTION_REPEAT,
-    EOF_ACTION_ENDALL,
-    EOF_ACTION_PASS
-};
-
 static const char *eof_action_str[] = {
     "repeat", "endall", "pass"
 };
@@ -91,34 +71,6 @@ static const char *eof_action_str[] = {
 #define U 1
 #define V 2
 
-typedef struct {
-    const AVClass *class;
-    int x, y;                   ///< position of overlayed picture
-
-    int allow_packed_rgb;
-    uint8_t main_is_packed_rgb;
-    uint8_t main_rgba_map[4];
-    uint8_t main_has_alpha;
-    uint8_t overlay_is_packed_rgb;
-    uint8_t overlay_rgba_map[4];
-    uint8_t overlay_has_alpha;
-    enum OverlayFormat { OVERLAY_FORMAT_YUV420, OVERLAY_FORMAT_YUV422, OVERLAY_FORMAT_YUV444, OVERLAY_FORMAT_RGB, OVERLAY_FORMAT_NB} format;
-    enum EvalMode { EVAL_MODE_INIT, EVAL_MODE_FRAME, EVAL_MODE_NB } eval_mode;
-
-    FFDualInputContext dinput;
-
-    int main_pix_step[4];       ///< steps per pixel for each plane of the main output
-    int overlay_pix_step[4];    ///< steps per pixel for each plane of the overlay
-    int hsub, vsub;             ///< chroma subsampling values
-
-    double var_values[VAR_VARS_NB];
-    char *x_expr, *y_expr;
-
-    enum EOFAction eof_action;  ///< action to take on EOF from source
-
-    AVExpr *x_pexpr, *y_pexpr;
-} OverlayContext;
-
 static av_cold void uninit(AVFilterContext *ctx)
 {
     OverlayContext *s = ctx->priv;
@@ -314,6 +266,13 @@ static int config_input_overlay(AVFilterLink *inlink)
         ff_fill_rgba_map(s->overlay_rgba_map, inlink->format) >= 0;
     s->overlay_has_alpha = ff_fmt_is_in(inlink->format, alpha_pix_fmts);
 
+    if (s->main_is_packed_rgb && !s->main_has_alpha && s->overlay_is_packed_rgb) {
+        s->rgb_map[s->main_rgba_map[R]] = s->overlay_rgba_map[R];
+        s->rgb_map[s->main_rgba_map[G]] = s->overlay_rgba_map[G];
+        s->rgb_map[s->main_rgba_map[B]] = s->overlay_rgba_map[B];
+        s->rgb_map[3]                   = s->overlay_rgba_map[A];
+    }
+
     if (s->eval_mode == EVAL_MODE_INIT) {
         eval_expr(ctx);
         av_log(ctx, AV_LOG_VERBOSE, "x:%f xi:%d y:%f yi:%d\n",
@@ -357,197 +316,390 @@ static int config_output(AVFilterLink *outlink)
 // ((((x) + (y)) << 8) - ((x) + (y)) - (y) * (x)) is a faster version of: 255 * (x + y)
 #define UNPREMULTIPLY_ALPHA(x, y) ((((x) << 16) - ((x) << 9) + (x)) / ((((x) + (y)) << 8) - ((x) + (y)) - (y) * (x)))
 
+void ff_overlay_blend_row_c(uint8_t *d, const uint8_t *s, const uint8_t *a, int w)
+{
+    int k;
+
+    for (k = 0; k < w; k++)
+        d[k] = FAST_DIV255(d[k] * (255 - a[k]) + s[k] * a[k]);
+}
+
+void ff_overlay_blend_row_420_c(uint8_t *d, const uint8_t *s, const uint8_t *a,
+                                ptrdiff_t alinesize, int w)
+{
+    int k;
+
+    for (k = 0; k < w; k++) {
+        int alpha = (a[2*k] + a[2*k + 1] + a[2*k + alinesize] + a[2*k + alinesize + 1]) >> 2;
+        d[k] = FAST_DIV255(d[k] * (255 - alpha) + s[k] * alpha);
+    }
+}
+
+void ff_overlay_blend_row_rgb_c(uint8_t *d, const uint8_t *o, const uint8_t *map,
+                                int w)
+{
+    int k;
+
+    for (k = 0; k < w; k++) {
+        int alpha = o[map[3]];
+
+        d[0] = FAST_DIV255(d[0] * (255 - alpha) + o[map[0]] * alpha);
+        d[1] = FAST_DIV255(d[1] * (255 - alpha) + o[map[1]] * alpha);
+        d[2] = FAST_DIV255(d[2] * (255 - alpha) + o[map[2]] * alpha);
+        d += 3;
+        o += 4;
+    }
+}
+
+typedef struct ThreadData {
+    AVFrame *dst;
+    const AVFrame *src;
+    int x, y;                   ///< position of the overlay
+    int start, end;             ///< rows of the overlay to blend
+} ThreadData;
+
+static int row_is_transparent(const uint8_t *a, int step, int w)
+{
+    int k, v = 0;
+
+    for (k = 0; k < w; k++)
+        v |= a[k * step];
+    return !v;
+}
+
 /**
- * Blend image in src to destination buffer dst at position (x, y).
+ * Shrink the rows [*start, *end) of src to the ones which are not fully
+ * transparent, blending the others would leave main unchanged. The bounds are
+ * kept aligned to the chroma subsampling.
  */
-static void blend_image(AVFilterContext *ctx,
-                        AVFrame *dst, const AVFrame *src,
-                        int x, int y)
+static void bounding_rows(OverlayContext *s, const AVFrame *src,
+                          int *start, int *end)
+{
+    const uint8_t *a;
+    int linesize, step;
+    int i0 = *start, i1 = *end;
+
+    if (s->overlay_is_packed_rgb) {
+        a        = src->data[0] + s->overlay_rgba_map[A];
+        linesize = src->linesize[0];
+        step     = s->overlay_pix_step[0];
+    } else {
+        a        = src->data[3];
+        linesize = src->linesize[3];
+        step     = 1;
+    }
+
+    while (i0 < i1 && row_is_transparent(a + i0 * linesize, step, src->width))
+        i0++;
+    while (i1 > i0 && row_is_transparent(a + (i1 - 1) * linesize, step, src->width))
+        i1--;
+
+    *start = i0 & ~((1 << s->vsub) - 1);
+    *end   = FFMIN(FFALIGN(i1, 1 << s->vsub), *end);
+}
+
+/**
+ * Get the rows of the overlay blended by one slice, aligned to the chroma
+ * subsampling so that no chroma row is shared between slices.
+ */
+static void slice_rows(const ThreadData *td, int vsub, int jobnr, int nb_jobs,
+                       int *start, int *end)
+{
+    int nb_blocks = FF_CEIL_RSHIFT(td->end - td->start, vsub);
+
+    *start = td->start + ((nb_blocks *  jobnr     ) / nb_jobs << vsub);
+    *end   = td->start + ((nb_blocks * (jobnr + 1)) / nb_jobs << vsub);
+    *end   = FFMIN(*end, td->end);
+}
+
+static int blend_slice_packed_rgb(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
     OverlayContext *s = ctx->priv;
-    int i, imax, j, jmax, k, kmax;
-    const int src_w = src->width;
-    const int src_h = src->height;
-    const int dst_w = dst->width;
-    const int dst_h = dst->height;
+    ThreadData *td = arg;
+    AVFrame *dst = td->dst;
+    const AVFrame *src = td->src;
+    const int x = td->x;
+    uint8_t alpha;          ///< the amount of overlay to blend on to main
+    const int dr = s->main_rgba_map[R];
+    const int dg = s->main_rgba_map[G];
+    const int db = s->main_rgba_map[B];
+    const int da = s->main_rgba_map[A];
+    const int dstep = s->main_pix_step[0];
+    const int sr = s->overlay_rgba_map[R];
+    const int sg = s->overlay_rgba_map[G];
+    const int sb = s->overlay_rgba_map[B];
+    const int sa = s->overlay_rgba_map[A];
+    const int sstep = s->overlay_pix_step[0];
+    const int main_has_alpha = s->main_has_alpha;
+    const uint8_t *o, *sp;
+    uint8_t *d, *dp;
+    int i, imax, j, jmax;
+
+    slice_rows(td, 0, jobnr, nb_jobs, &i, &imax);
+    sp = src->data[0] + i           * src->linesize[0];
+    dp = dst->data[0] + (td->y + i) * dst->linesize[0];
+
+    for (; i < imax; i++) {
+        j = FFMAX(-x, 0);
+        o = sp + j     * sstep;
+        d = dp + (x+j) * dstep;
+        jmax = FFMIN(-x + dst->width, src->width);
+
+        // without main alpha there is no unpremultiplying, the switch below
+        // only skips work, FAST_DIV255() being exact for alpha 0 and 255
+        if (!main_has_alpha && j < jmax) {
+            s->blend_row_rgb(d, o, s->rgb_map, jmax - j);
+            j = jmax;
+        }
 
-    if (x >= dst_w || x+src_w < 0 ||
-        y >= dst_h || y+src_h < 0)
-        return; /* no intersection */
+        for (; j < jmax; j++) {
+            alpha = o[sa];
 
-    if (s->main_is_packed_rgb) {
-        uint8_t alpha;          ///< the amount of overlay to blend on to main
-        const int dr = s->main_rgba_map[R];
-        const int dg = s->main_rgba_map[G];
-        const int db = s->main_rgba_map[B];
-        const int da = s->main_rgba_map[A];
-        const int dstep = s->main_pix_step[0];
-        const int sr = s->overlay_rgba_map[R];
-        const int sg = s->overlay_rgba_map[G];
-        const int sb = s->overlay_rgba_map[B];
-        const int sa = s->overlay_rgba_map[A];
-        const int sstep = s->overlay_pix_step[0];
-        const int main_has_alpha = s->main_has_alpha;
-        uint8_t *s, *sp, *d, *dp;
-
-        i = FFMAX(-y, 0);
-        sp = src->data[0] + i     * src->linesize[0];
-        dp = dst->data[0] + (y+i) * dst->linesize[0];
-
-        for (imax = FFMIN(-y + dst_h, src_h); i < imax; i++) {
-            j = FFMAX(-x, 0);
-            s = sp + j     * sstep;
-            d = dp + (x+j) * dstep;
-
-            for (jmax = FFMIN(-x + dst_w, src_w); j < jmax; j++) {
-                alpha = s[sa];
-
-                // if the main channel has an alpha channel, alpha has to be calculated
-                // to create an un-premultiplied (straight) alpha value
-                if (main_has_alpha && alpha != 0 && alpha != 255) {
-                    uint8_t alpha_d = d[da];
-                    alpha = UNPREMULTIPLY_ALPHA(alpha, alpha_d);
-                }
+            // if the main channel has an alpha channel, alpha has to be calculated
+            // to create an un-premultiplied (straight) alpha value
+            if (main_has_alpha && alpha != 0 && alpha != 255) {
+                uint8_t alpha_d = d[da];
+                alpha = UNPREMULTIPLY_ALPHA(alpha, alpha_d);
+            }
 
+            switch (alpha) {
+            case 0:
+                break;
+            case 255:
+                d[dr] = o[sr];
+                d[dg] = o[sg];
+                d[db] = o[sb];
+                break;
+            default:
+                // main_value = main_value * (1 - alpha) + overlay_value * alpha
+                // since alpha is in the range 0-255, the result must divided by 255
+                d[dr] = FAST_DIV255(d[dr] * (255 - alpha) + o[sr] * alpha);
+                d[dg] = FAST_DIV255(d[dg] * (255 - alpha) + o[sg] * alpha);
+                d[db] = FAST_DIV255(d[db] * (255 - alpha) + o[sb] * alpha);
+            }
+            if (main_has_alpha) {
                 switch (alpha) {
                 case 0:
                     break;
                 case 255:
-                    d[dr] = s[sr];
-                    d[dg] = s[sg];
-                    d[db] = s[sb];
+                    d[da] = o[sa];
                     break;
                 default:
-                    // main_value = main_value * (1 - alpha) + overlay_value * alpha
-                    // since alpha is in the range 0-255, the result must divided by 255
-                    d[dr] = FAST_DIV255(d[dr] * (255 - alpha) + s[sr] * alpha);
-                    d[dg] = FAST_DIV255(d[dg] * (255 - alpha) + s[sg] * alpha);
-                    d[db] = FAST_DIV255(d[db] * (255 - alpha) + s[sb] * alpha);
-                }
-                if (main_has_alpha) {
-                    switch (alpha) {
-                    case 0:
-                        break;
-                    case 255:
-                        d[da] = s[sa];
-                        break;
-                    default:
-                        // apply alpha compositing: main_alpha += (1-main_alpha) * overlay_alpha
-                        d[da] += FAST_DIV255((255 - d[da]) * s[sa]);
-                    }
+                    // apply alpha compositing: main_alpha += (1-main_alpha) * overlay_alpha
+                    d[da] += FAST_DIV255((255 - d[da]) * o[sa]);
                 }
-                d += dstep;
-                s += sstep;
             }
-            dp += dst->linesize[0];
-            sp += src->linesize[0];
+            d += dstep;
+            o += sstep;
         }
-    } else {
-        const int main_has_alpha = s->main_has_alpha;
-        if (main_has_alpha) {
-            uint8_t alpha;          ///< the amount of overlay to blend on to main
-            uint8_t *s, *sa, *d, *da;
-
-            i = FFMAX(-y, 0);
-            sa = src->data[3] + i     * src->linesize[3];
-            da = dst->data[3] + (y+i) * dst->linesize[3];
-
-            for (imax = FFMIN(-y + dst_h, src_h); i < imax; i++) {
-                j = FFMAX(-x, 0);
-                s = sa + j;
-                d = da + x+j;
-
-                for (jmax = FFMIN(-x + dst_w, src_w); j < jmax; j++) {
-                    alpha = *s;
-                    if (alpha != 0 && alpha != 255) {
-                        uint8_t alpha_d = *d;
-                        alpha = UNPREMULTIPLY_ALPHA(alpha, alpha_d);
-                    }
-                    switch (alpha) {
-                    case 0:
-                        break;
-                    case 255:
-                        *d = *s;
-                        break;
-                    default:
-                        // apply alpha compositing: main_alpha += (1-main_alpha) * overlay_alpha
-                        *d += FAST_DIV255((255 - *d) * *s);
-                    }
-                    d += 1;
-                    s += 1;
-                }
-                da += dst->linesize[3];
-                sa += src->linesize[3];
+        dp += dst->linesize[0];
+        sp += src->linesize[0];
+    }
+    return 0;
+}
+
+/**
+ * Blend the rows [start, end) of the overlay, in luma units, into plane i
+ * of dst.
+ */
+static void blend_plane(AVFilterContext *ctx, AVFrame *dst, const AVFrame *src,
+                        int x, int y, int i, int hsub, int vsub,
+                        int start, int end)
+{
+    OverlayContext *s = ctx->priv;
+    const int main_has_alpha = s->main_has_alpha;
+    int src_wp = FF_CEIL_RSHIFT(src->width,  hsub);
+    int src_hp = FF_CEIL_RSHIFT(src->height, vsub);
+    int dst_wp = FF_CEIL_RSHIFT(dst->width,  hsub);
+    int dst_hp = FF_CEIL_RSHIFT(dst->height, vsub);
+    int yp = y>>vsub;
+    int xp = x>>hsub;
+    int j, jmax, k, kmax;
+    const uint8_t *sp, *ap;
+    uint8_t *dp, *dap = NULL;
+
+    j    = FFMAX(-yp, start >> vsub);
+    jmax = FFMIN3(-yp + dst_hp, src_hp, FF_CEIL_RSHIFT(end, vsub));
+    sp = src->data[i] + j         * src->linesize[i];
+    dp = dst->data[i] + (yp+j)    * dst->linesize[i];
+    ap = src->data[3] + (j<<vsub) * src->linesize[3];
+    if (main_has_alpha)
+        dap = dst->data[3] + ((yp+j) << vsub) * dst->linesize[3];
+
+    for (; j < jmax; j++) {
+        const uint8_t *o, *a;
+        uint8_t *d, *da = NULL;
+        /* offsets of the next row and column of the main alpha, if any */
+        ptrdiff_t dls = ((yp+j) << vsub) + 1 < dst->height ? dst->linesize[3] : 0;
+
+        k    = FFMAX(-xp, 0);
+        kmax = FFMIN(-xp + dst_wp, src_wp);
+        d = dp + xp+k;
+        o = sp + k;
+        a = ap + (k<<hsub);
+        if (dap)
+            da = dap + ((xp+k) << hsub);
+
+        if (!main_has_alpha) {
+            if (!hsub && !vsub) {
+                s->blend_row(d, o, a, kmax - k);
+                k = kmax;
+            } else if (hsub && vsub && j+1 < src_hp && k < src_wp - 1) {
+                int n = FFMIN(kmax, src_wp - 1) - k;
+                s->blend_row_420(d, o, a, src->linesize[3], n);
+                k += n;
+                d += n;
+                o += n;
+                a += 2 * n;
             }
         }
-        for (i = 0; i < 3; i++) {
-            int hsub = i ? s->hsub : 0;
-            int vsub = i ? s->vsub : 0;
-            int src_wp = FF_CEIL_RSHIFT(src_w, hsub);
-            int src_hp = FF_CEIL_RSHIFT(src_h, vsub);
-            int dst_wp = FF_CEIL_RSHIFT(dst_w, hsub);
-            int dst_hp = FF_CEIL_RSHIFT(dst_h, vsub);
-            int yp = y>>vsub;
-            int xp = x>>hsub;
-            uint8_t *s, *sp, *d, *dp, *a, *ap;
-
-            j = FFMAX(-yp, 0);
-            sp = src->data[i] + j         * src->linesize[i];
-            dp = dst->data[i] + (yp+j)    * dst->linesize[i];
-            ap = src->data[3] + (j<<vsub) * src->linesize[3];
-
-            for (jmax = FFMIN(-yp + dst_hp, src_hp); j < jmax; j++) {
-                k = FFMAX(-xp, 0);
-                d = dp + xp+k;
-                s = sp + k;
-                a = ap + (k<<hsub);
-
-                for (kmax = FFMIN(-xp + dst_wp, src_wp); k < kmax; k++) {
-                    int alpha_v, alpha_h, alpha;
-
-                    // average alpha for color components, improve quality
-                    if (hsub && vsub && j+1 < src_hp && k+1 < src_wp) {
-                        alpha = (a[0] + a[src->linesize[3]] +
-                                 a[1] + a[src->linesize[3]+1]) >> 2;
-                    } else if (hsub || vsub) {
-                        alpha_h = hsub && k+1 < src_wp ?
-                            (a[0] + a[1]) >> 1 : a[0];
-                        alpha_v = vsub && j+1 < src_hp ?
-                            (a[0] + a[src->linesize[3]]) >> 1 : a[0];
-                        alpha = (alpha_v + alpha_h) >> 1;
-                    } else
-                        alpha = a[0];
-                    // if the main channel has an alpha channel, alpha has to be calculated
-                    // to create an un-premultiplied (straight) alpha value
-                    if (main_has_alpha && alpha != 0 && alpha != 255) {
-                        // average alpha for color components, improve quality
-                        uint8_t alpha_d;
-                        if (hsub && vsub && j+1 < src_hp && k+1 < src_wp) {
-                            alpha_d = (d[0] + d[src->linesize[3]] +
-                                       d[1] + d[src->linesize[3]+1]) >> 2;
-                        } else if (hsub || vsub) {
-                            alpha_h = hsub && k+1 < src_wp ?
-                                (d[0] + d[1]) >> 1 : d[0];
-                            alpha_v = vsub && j+1 < src_hp ?
-                                (d[0] + d[src->linesize[3]]) >> 1 : d[0];
-                            alpha_d = (alpha_v + alpha_h) >> 1;
-                        } else
-                            alpha_d = d[0];
-                        alpha = UNPREMULTIPLY_ALPHA(alpha, alpha_d);
-                    }
-                    *d = FAST_DIV255(*d * (255 - alpha) + *s * alpha);
-                    s++;
-                    d++;
-                    a += 1 << hsub;
-                }
-                dp += dst->linesize[i];
-                sp += src->linesize[i];
-                ap += (1 << vsub) * src->linesize[3];
+
+        for (; k < kmax; k++) {
+            int alpha_v, alpha_h, alpha;
+
+            // average alpha for color components, improve quality
+            if (hsub && vsub && j+1 < src_hp && k+1 < src_wp) {
+                alpha = (a[0] + a[src->linesize[3]] +
+                         a[1] + a[src->linesize[3]+1]) >> 2;
+            } else if (hsub || vsub) {
+                alpha_h = hsub && k+1 < src_wp ?
+                    (a[0] + a[1]) >> 1 : a[0];
+                alpha_v = vsub && j+1 < src_hp ?
+                    (a[0] + a[src->linesize[3]]) >> 1 : a[0];
+                alpha = (alpha_v + alpha_h) >> 1;
+            } else
+                alpha = a[0];
+            // if the main channel has an alpha channel, alpha has to be calculated
+            // to create an un-premultiplied (straight) alpha value
+            if (main_has_alpha && alpha != 0 && alpha != 255) {
+                // average alpha for color components, improve quality
+                int dx = ((xp+k) << hsub) + 1 < dst->width;
+                uint8_t alpha_d;
+                if (hsub && vsub && j+1 < src_hp && k+1 < src_wp) {
+                    alpha_d = (da[0] + da[dls] +
+                               da[dx] + da[dls+dx]) >> 2;
+                } else if (hsub || vsub) {
+                    alpha_h = hsub && k+1 < src_wp ?
+                        (da[0] + da[dx]) >> 1 : da[0];
+                    alpha_v = vsub && j+1 < src_hp ?
+                        (da[0] + da[dls]) >> 1 : da[0];
+                    alpha_d = (alpha_v + alpha_h) >> 1;
+                } else
+                    alpha_d = da[0];
+                alpha = UNPREMULTIPLY_ALPHA(alpha, alpha_d);
+            }
+            *d = FAST_DIV255(*d * (255 - alpha) + *o * alpha);
+            o++;
+            d++;
+            a  += 1 << hsub;
+            if (da)
+                da += 1 << hsub;
+        }
+        dp += dst->linesize[i];
+        sp += src->linesize[i];
+        ap += (1 << vsub) * src->linesize[3];
+        if (dap)
+            dap += (1 << vsub) * dst->linesize[3];
+    }
+}
+
+/**
+ * Composite the alpha of the rows [start, end) of the overlay into the alpha
+ * plane of dst.
+ */
+static void alpha_composite(AVFrame *dst, const AVFrame *src,
+                            int x, int y, int start, int end)
+{
+    uint8_t alpha;          ///< the amount of overlay to blend on to main
+    const uint8_t *s, *sa;
+    uint8_t *d, *da;
+    int i, imax, j, jmax;
+
+    i = start;
+    sa = src->data[3] + i     * src->linesize[3];
+    da = dst->data[3] + (y+i) * dst->linesize[3];
+
+    for (imax = end; i < imax; i++) {
+        j = FFMAX(-x, 0);
+        s = sa + j;
+        d = da + x+j;
+
+        for (jmax = FFMIN(-x + dst->width, src->width); j < jmax; j++) {
+            alpha = *s;
+            if (alpha != 0 && alpha != 255) {
+                uint8_t alpha_d = *d;
+                alpha = UNPREMULTIPLY_ALPHA(alpha, alpha_d);
+            }
+            switch (alpha) {
+            case 0:
+                break;
+            case 255:
+                *d = *s;
+                break;
+            default:
+                // apply alpha compositing: main_alpha += (1-main_alpha) * overlay_alpha
+                *d += FAST_DIV255((255 - *d) * *s);
             }
+            d += 1;
+            s += 1;
         }
+        da += dst->linesize[3];
+        sa += src->linesize[3];
     }
 }
 
+static int blend_slice_yuv(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    OverlayContext *s = ctx->priv;
+    ThreadData *td = arg;
+    int start, end;
+
+    slice_rows(td, s->vsub, jobnr, nb_jobs, &start, &end);
+
+    /* the color planes need the main alpha before compositing */
+    blend_plane(ctx, td->dst, td->src, td->x, td->y, 0, 0,       0,       start, end);
+    blend_plane(ctx, td->dst, td->src, td->x, td->y, 1, s->hsub, s->vsub, start, end);
+    blend_plane(ctx, td->dst, td->src, td->x, td->y, 2, s->hsub, s->vsub, start, end);
+    if (s->main_has_alpha)
+        alpha_composite(td->dst, td->src, td->x, td->y, start, end);
+    return 0;
+}
+
+/**
+ * Blend image in src to destination buffer dst at position (x, y).
+ */
+static void blend_image(AVFilterContext *ctx,
+                        AVFrame *dst, const AVFrame *src,
+                        int x, int y)
+{
+    OverlayContext *s = ctx->priv;
+    const int src_w = src->width;
+    const int src_h = src->height;
+    const int dst_w = dst->width;
+    const int dst_h = dst->height;
+    ThreadData td;
+    int nb_blocks;
+
+    if (x >= dst_w || x+src_w < 0 ||
+        y >= dst_h || y+src_h < 0)
+        return; /* no intersection */
+
+    td.dst   = dst;
+    td.src   = src;
+    td.x     = x;
+    td.y     = y;
+    td.start = FFMAX(-y, 0);
+    td.end   = FFMIN(-y + dst_h, src_h);
+    bounding_rows(s, src, &td.start, &td.end);
+    if (td.start >= td.end)
+        return;
+
+    nb_blocks = FF_CEIL_RSHIFT(td.end - td.start, s->vsub);
+    ctx->internal->execute(ctx, s->main_is_packed_rgb ? blend_slice_packed_rgb :
+                                                        blend_slice_yuv,
+                           &td, NULL, FFMIN(nb_blocks, ctx->graph->nb_threads));
+}
+
 static AVFrame *do_blend(AVFilterContext *ctx, AVFrame *mainpic,
                          const AVFrame *second)
 {
@@ -605,6 +757,12 @@ static av_cold int init(AVFilterContext *ctx)
     }
 
     s->dinput.process = do_blend;
+
+    s->blend_row     = ff_overlay_blend_row_c;
+    s->blend_row_420 = ff_overlay_blend_row_420_c;
+    s->blend_row_rgb = ff_overlay_blend_row_rgb_c;
+    if (ARCH_X86)
+        ff_overlay_init_x86(s);
     return 0;
 }
 
@@ -674,5 +832,6 @@ AVFilter ff_vf_overlay = {
     .process_command = process_command,
     .inputs        = avfilter_vf_overlay_inputs,
     .outputs       = avfilter_vf_overlay_outputs,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_INTERNAL,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_INTERNAL |
+                     AVFILTER_FLAG_SLICE_THREADS,
 };
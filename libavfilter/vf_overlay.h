@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2010 Stefano Sabatini
+ * Copyright (c) 2010 Baptiste Coudurier
+ * Copyright (c) 2007 Bobby Bingham
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_VF_OVERLAY_H
+#define AVFILTER_VF_OVERLAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "libavutil/eval.h"
+#include "libavutil/opt.h"
+#include "dualinput.h"
+
+enum var_name {
+    VAR_MAIN_W,    VAR_MW,
+    VAR_MAIN_H,    VAR_MH,
+    VAR_OVERLAY_W, VAR_OW,
+    VAR_OVERLAY_H, VAR_OH,
+    VAR_HSUB,
+    VAR_VSUB,
+    VAR_X,
+    VAR_Y,
+    VAR_N,
+    VAR_POS,
+    VAR_T,
+    VAR_VARS_NB
+};
+
+enum EOFAction {
+    EOF_ACTION_REPEAT,
+    EOF_ACTION_ENDALL,
+    EOF_ACTION_PASS
+};
+
+typedef struct {
+    const AVClass *class;
+    int x, y;                   ///< position of overlayed picture
+
+    int allow_packed_rgb;
+    uint8_t main_is_packed_rgb;
+    uint8_t main_rgba_map[4];
+    uint8_t main_has_alpha;
+    uint8_t overlay_is_packed_rgb;
+    uint8_t overlay_rgba_map[4];
+    uint8_t overlay_has_alpha;
+    uint8_t rgb_map[4];         ///< overlay offset of each main component, then of the overlay alpha
+    enum OverlayFormat { OVERLAY_FORMAT_YUV420, OVERLAY_FORMAT_YUV422, OVERLAY_FORMAT_YUV444, OVERLAY_FORMAT_RGB, OVERLAY_FORMAT_NB} format;
+    enum EvalMode { EVAL_MODE_INIT, EVAL_MODE_FRAME, EVAL_MODE_NB } eval_mode;
+
+    FFDualInputContext dinput;
+
+    int main_pix_step[4];       ///< steps per pixel for each plane of the main output
+    int overlay_pix_step[4];    ///< steps per pixel for each plane of the overlay
+    int hsub, vsub;             ///< chroma subsampling values
+
+    double var_values[VAR_VARS_NB];
+    char *x_expr, *y_expr;
+
+    enum EOFAction eof_action;  ///< action to take on EOF from source
+
+    AVExpr *x_pexpr, *y_pexpr;
+
+    /**
+     * Blend w pixels of s onto d, a holding the alpha of each pixel.
+     * Used when the main input has no alpha.
+     */
+    void (*blend_row)(uint8_t *d, const uint8_t *s, const uint8_t *a, int w);
+
+    /**
+     * Same as blend_row, for a plane subsampled 2x2 relative to its alpha:
+     * the alpha of each pixel is the average of the 2x2 block at a.
+     */
+    void (*blend_row_420)(uint8_t *d, const uint8_t *s, const uint8_t *a,
+                          ptrdiff_t alinesize, int w);
+
+    /**
+     * Blend w packed RGB pixels of o onto d, when the main input has no
+     * alpha; map[k] is the offset in an o pixel of the component at offset
+     * k in a d pixel, map[3] the offset of its alpha.
+     */
+    void (*blend_row_rgb)(uint8_t *d, const uint8_t *o, const uint8_t *map,
+                          int w);
+} OverlayContext;
+
+void ff_overlay_blend_row_c(uint8_t *d, const uint8_t *s, const uint8_t *a, int w);
+void ff_overlay_blend_row_420_c(uint8_t *d, const uint8_t *s, const uint8_t *a,
+                                ptrdiff_t alinesize, int w);
+void ff_overlay_blend_row_rgb_c(uint8_t *d, const uint8_t *o, const uint8_t *map,
+                                int w);
+
+void ff_overlay_init_x86(OverlayContext *s);
+
+#endif /* AVFILTER_VF_OVERLAY_H */
@@ -596,6 +596,7 @@ AVFilter ff_vf_scale = {
     .query_formats = query_formats,
     .priv_size     = sizeof(ScaleContext),
     .priv_class    = &scale_class,
+    .flags         = AVFILTER_FLAG_SUPPORT_RELINK,
     .inputs        = avfilter_vf_scale_inputs,
     .outputs       = avfilter_vf_scale_outputs,
 };
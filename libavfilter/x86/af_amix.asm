@@ -0,0 +1,69 @@
+;*****************************************************************************
+;* x86-optimized functions for the amix filter
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_TEXT
+
+;------------------------------------------------------------------------------
+; void ff_amix_mix_4_float(float *dst, const float **src, const float *scale,
+;                          int len)
+;------------------------------------------------------------------------------
+
+INIT_XMM sse
+cglobal amix_mix_4_float, 4,7,6, dst, src, scale, len, src1, src2, src3
+    movss       m2, [scaleq+ 0]
+    movss       m3, [scaleq+ 4]
+    movss       m4, [scaleq+ 8]
+    movss       m5, [scaleq+12]
+    shufps      m2, m2, 0
+    shufps      m3, m3, 0
+    shufps      m4, m4, 0
+    shufps      m5, m5, 0
+    mov      src1q, [srcq+1*gprsize]
+    mov      src2q, [srcq+2*gprsize]
+    mov      src3q, [srcq+3*gprsize]
+    mov       srcq, [srcq+0*gprsize]
+    movsxdifnidn lenq, lend
+    shl       lenq, 2
+    add       dstq, lenq
+    add       srcq, lenq
+    add      src1q, lenq
+    add      src2q, lenq
+    add      src3q, lenq
+    neg       lenq
+.loop:
+    movu        m0, [dstq+lenq]
+    movu        m1, [srcq+lenq]
+    mulps       m1, m2
+    addps       m0, m1
+    movu        m1, [src1q+lenq]
+    mulps       m1, m3
+    addps       m0, m1
+    movu        m1, [src2q+lenq]
+    mulps       m1, m4
+    addps       m0, m1
+    movu        m1, [src3q+lenq]
+    mulps       m1, m5
+    addps       m0, m1
+    movu [dstq+lenq], m0
+    add       lenq, mmsize
+    jl .loop
+    REP_RET
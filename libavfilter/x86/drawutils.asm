@@ -0,0 +1,112 @@
+;*****************************************************************************
+;* x86-optimized functions for the drawing utilities
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA
+
+pb_1: times 16 db 1
+
+SECTION .text
+
+; blend the 8 bytes at dstq+wq with the coverages in the dwords of m0 and m1,
+; m4 holding alpha and m5 src in each dword:
+; dst = ((0x1010101 - a) * dst + a * src) >> 24 with a = coverage * alpha,
+; computed as (dst * 0x1010101 - a * (dst - src)) >> 24, which is the same
+; modulo 2^32 and the result fits 32 bits
+%macro BLEND8 0
+    pmulld       m0, m4
+    pmulld       m1, m4
+    movh         m2, [dstq+wq]
+    punpcklbw    m2, m2
+    punpckhwd    m3, m2, m2
+    punpcklwd    m2, m2
+    psrld        m6, m2, 24
+    psrld        m7, m3, 24
+    psubd        m6, m5
+    psubd        m7, m5
+    pmulld       m6, m0
+    pmulld       m7, m1
+    psubd        m2, m6
+    psubd        m3, m7
+    psrld        m2, 24
+    psrld        m3, 24
+    packusdw     m2, m3
+    packuswb     m2, m2
+    movh  [dstq+wq], m2
+%endmacro
+
+INIT_XMM sse4
+;------------------------------------------------------------------------------
+; void ff_blend_row8(uint8_t *dst, const uint8_t *mask, int w,
+;                    unsigned src, unsigned alpha)
+; w must be a multiple of 8
+;------------------------------------------------------------------------------
+
+cglobal blend_row8, 5, 5, 8, dst, mask, w, src, alpha
+    movsxdifnidn wq, wd
+    movd         m4, alphad
+    movd         m5, srcd
+    pshufd       m4, m4, 0
+    pshufd       m5, m5, 0
+    add        dstq, wq
+    add       maskq, wq
+    neg          wq
+.loop:
+    pmovzxbd     m0, [maskq+wq]
+    pmovzxbd     m1, [maskq+wq+4]
+    BLEND8
+    add          wq, 8
+    jl .loop
+    REP_RET
+
+;------------------------------------------------------------------------------
+; void ff_blend_row8_420(uint8_t *dst, const uint8_t *mask,
+;                        ptrdiff_t mask_linesize, int w,
+;                        unsigned src, unsigned alpha)
+; the coverage of each byte is the average of a 2x2 block of mask,
+; w must be a multiple of 8
+;------------------------------------------------------------------------------
+
+cglobal blend_row8_420, 6, 7, 8, dst, mask, mask_linesize, w, src, alpha, mask2
+    movsxdifnidn wq, wd
+    movd         m4, alphad
+    movd         m5, srcd
+    pshufd       m4, m4, 0
+    pshufd       m5, m5, 0
+    lea      mask2q, [maskq+mask_linesizeq]
+    add        dstq, wq
+    lea       maskq, [maskq +wq*2]
+    lea      mask2q, [mask2q+wq*2]
+    neg          wq
+.loop:
+    movu         m0, [maskq +wq*2]
+    movu         m1, [mask2q+wq*2]
+    pmaddubsw    m0, [pb_1]
+    pmaddubsw    m1, [pb_1]
+    paddw        m0, m1
+    psrlw        m0, 2
+    psrldq       m1, m0, 8
+    pmovzxwd     m0, m0
+    pmovzxwd     m1, m1
+    BLEND8
+    add          wq, 8
+    jl .loop
+    REP_RET
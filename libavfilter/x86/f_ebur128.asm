@@ -0,0 +1,100 @@
+;*****************************************************************************
+;* x86-optimized functions for the ebur128 filter
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or modify
+;* it under the terms of the GNU General Public License as published by
+;* the Free Software Foundation; either version 2 of the License, or
+;* (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;* GNU General Public License for more details.
+;*
+;* You should have received a copy of the GNU General Public License along
+;* with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+;* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA
+
+; same values as the PRE_* and RLB_* coefficients in f_ebur128.c
+pd_pre_b0: times 2 dq 0x3FF88FDF15B33DF7
+pd_pre_b1: times 2 dq 0xC005889803022552
+pd_pre_b2: times 2 dq 0x3FF32C9DF0A5FDF9
+pd_pre_a1: times 2 dq 0xBFFB0CF0C24E59D0
+pd_pre_a2: times 2 dq 0x3FE7707B85469635
+pd_rlb_b1: times 2 dq 0xC000000000000000
+pd_rlb_a1: times 2 dq 0xBFFFD73BFFFFFFEC
+pd_rlb_a2: times 2 dq 0x3FEFAEABFFFFFFF8
+
+SECTION_TEXT
+
+;------------------------------------------------------------------------------
+; void ff_ebur128_kweight_2ch(double *dst, const double *src, ptrdiff_t stride,
+;                             int len, double *state)
+;
+; The operations are done in the same order as the C version so that the
+; output is bit-exact.
+;------------------------------------------------------------------------------
+
+INIT_XMM sse2
+cglobal ebur128_kweight_2ch, 5,5,8, dst, src, stride, len, state
+    shl    strideq, 3
+    movu        m0, [stateq+ 0]         ; x[i-1]
+    movu        m1, [stateq+16]         ; x[i-2]
+    movu        m2, [stateq+32]         ; y[i-1]
+    movu        m3, [stateq+48]         ; y[i-2]
+    movu        m4, [stateq+64]         ; z[i-1]
+    movu        m5, [stateq+80]         ; z[i-2]
+.loop:
+    ; y[i] = x[i]*b0 + x[i-1]*b1 + x[i-2]*b2 - y[i-1]*a1 - y[i-2]*a2
+    movu        m7, [srcq]
+    mulpd       m7, [pd_pre_b0]
+    mova        m6, m0
+    mulpd       m6, [pd_pre_b1]
+    addpd       m7, m6
+    mulpd       m1, [pd_pre_b2]
+    addpd       m7, m1
+    mova        m1, m0
+    movu        m0, [srcq]
+    mova        m6, m2
+    mulpd       m6, [pd_pre_a1]
+    subpd       m7, m6
+    mova        m6, m3
+    mulpd       m6, [pd_pre_a2]
+    subpd       m7, m6
+
+    ; z[i] = y[i] + y[i-1]*b1 + y[i-2] - z[i-1]*a1 - z[i-2]*a2
+    mova        m6, m2
+    mulpd       m6, [pd_rlb_b1]
+    addpd       m6, m7
+    addpd       m6, m3
+    mova        m3, m2
+    mova        m2, m7
+    mova        m7, m4
+    mulpd       m7, [pd_rlb_a1]
+    subpd       m6, m7
+    mulpd       m5, [pd_rlb_a2]
+    subpd       m6, m5
+    mova        m5, m4
+    mova        m4, m6
+
+    mulpd       m6, m6
+    movu    [dstq], m6
+    add       srcq, strideq
+    add       dstq, strideq
+    dec       lend
+    jg .loop
+
+    movu [stateq+ 0], m0
+    movu [stateq+16], m1
+    movu [stateq+32], m2
+    movu [stateq+48], m3
+    movu [stateq+64], m4
+    movu [stateq+80], m5
+    RET
@@ -0,0 +1,70 @@
+;******************************************************************************
+;* SIMD-optimized scene change detection SAD
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION .text
+
+;------------------------------------------------------------------------------
+; void ff_scene_sad(const uint8_t *src1, ptrdiff_t stride1,
+;                   const uint8_t *src2, ptrdiff_t stride2,
+;                   ptrdiff_t width, ptrdiff_t height, uint64_t *sum)
+;
+; width must be a non-zero multiple of mmsize and height must be positive
+;------------------------------------------------------------------------------
+
+%macro SCENE_SAD 0
+cglobal scene_sad, 6, 7, 3, src1, stride1, src2, stride2, width, height, x
+    add       src1q, widthq
+    add       src2q, widthq
+    neg      widthq
+    pxor         m0, m0
+.nextrow:
+    mov          xq, widthq
+.loop:
+    movu         m1, [src1q+xq]
+    movu         m2, [src2q+xq]
+    psadbw       m1, m2
+    paddq        m0, m1
+    add          xq, mmsize
+    jl .loop
+    add       src1q, stride1q
+    add       src2q, stride2q
+    dec     heightq
+    jg .nextrow
+
+%if mmsize == 32
+    vextracti128 xm1, m0, 1
+    paddq       xm0, xm1
+%endif
+    movhlps     xm1, xm0
+    paddq       xm0, xm1
+    mov          xq, r6mp
+    movq       [xq], xm0
+    RET
+%endmacro
+
+INIT_XMM sse2
+SCENE_SAD
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+SCENE_SAD
+%endif
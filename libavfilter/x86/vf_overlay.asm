@@ -0,0 +1,195 @@
+;*****************************************************************************
+;* x86-optimized functions for overlay filter
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA
+
+pw_128: times 8 dw 128
+pw_255: times 8 dw 255
+pw_257: times 8 dw 257
+rgb_mask0: db -1,-1,-1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+rgb_mask1: db  0, 0, 0, 0,-1,-1,-1, 0, 0, 0, 0, 0, 0, 0, 0, 0
+rgb_mask2: db  0, 0, 0, 0, 0, 0, 0, 0,-1,-1,-1, 0, 0, 0, 0, 0
+rgb_mask3: db  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,-1,-1,-1, 0
+
+SECTION .text
+
+; m%1 = (m%1 * (255 - m%3) + m%2 * m%3 + 128) * 257 >> 16 on words, which is
+; the blend divided by 255 exactly like FAST_DIV255(); m%2 and m%4 are clobbered
+%macro BLEND 4
+    mova        m%4, [pw_255]
+    psubw       m%4, m%3
+    pmullw      m%1, m%4
+    pmullw      m%2, m%3
+    paddw       m%1, m%2
+    paddw       m%1, [pw_128]
+    pmulhuw     m%1, [pw_257]
+%endmacro
+
+INIT_XMM sse2
+;------------------------------------------------------------------------------
+; void ff_overlay_blend_row(uint8_t *dst, const uint8_t *src,
+;                           const uint8_t *alpha, int w)
+; w must be a multiple of mmsize
+;------------------------------------------------------------------------------
+
+cglobal overlay_blend_row, 4, 4, 8, dst, src, alpha, w
+    movsxdifnidn wq, wd
+    add        dstq, wq
+    add        srcq, wq
+    add      alphaq, wq
+    neg          wq
+    pxor         m7, m7
+.loop:
+    movu         m0, [dstq+wq]
+    movu         m2, [srcq+wq]
+    movu         m4, [alphaq+wq]
+    punpckhbw    m1, m0, m7
+    punpcklbw    m0, m7
+    punpckhbw    m3, m2, m7
+    punpcklbw    m2, m7
+    punpckhbw    m5, m4, m7
+    punpcklbw    m4, m7
+    BLEND         0, 2, 4, 6
+    BLEND         1, 3, 5, 6
+    packuswb     m0, m1
+    movu  [dstq+wq], m0
+    add          wq, mmsize
+    jl .loop
+    REP_RET
+
+;------------------------------------------------------------------------------
+; void ff_overlay_blend_row_420(uint8_t *dst, const uint8_t *src,
+;                               const uint8_t *alpha, ptrdiff_t alinesize,
+;                               int w)
+; the alpha of each pixel is the average of a 2x2 block of alpha,
+; w must be a multiple of mmsize/2
+;------------------------------------------------------------------------------
+
+cglobal overlay_blend_row_420, 5, 6, 8, dst, src, alpha, alinesize, w, alpha2
+    movsxdifnidn wq, wd
+    lea     alpha2q, [alphaq+alinesizeq]
+    add        dstq, wq
+    add        srcq, wq
+    lea      alphaq, [alphaq +wq*2]
+    lea     alpha2q, [alpha2q+wq*2]
+    neg          wq
+    pxor         m7, m7
+    mova         m6, [pw_255]
+.loop:
+    movu         m4, [alphaq +wq*2]
+    movu         m2, [alpha2q+wq*2]
+    psrlw        m5, m4, 8
+    pand         m4, m6
+    paddw        m4, m5
+    psrlw        m5, m2, 8
+    pand         m2, m6
+    paddw        m4, m5
+    paddw        m4, m2
+    psrlw        m4, 2
+    movh         m0, [dstq+wq]
+    movh         m2, [srcq+wq]
+    punpcklbw    m0, m7
+    punpcklbw    m2, m7
+    BLEND         0, 2, 4, 5
+    packuswb     m0, m0
+    movh  [dstq+wq], m0
+    add          wq, mmsize/2
+    jl .loop
+    REP_RET
+
+%if ARCH_X86_64
+; the packed RGB main pixels are read 4 at a time as 16 bytes, only the first
+; 12 of which are blended and stored back
+;------------------------------------------------------------------------------
+; void ff_overlay_blend_row_rgb(uint8_t *dst, const uint8_t *src, int w,
+;                               int rev, int rot)
+; blend w 4-byte src pixels onto 3-byte dst pixels; the src words are reversed
+; if rev is set, then rotated down by rot, to bring them in the dst component
+; order with the alpha last. w must be a multiple of 4, and 4 bytes past the
+; end of dst must be readable.
+;------------------------------------------------------------------------------
+
+; reorder the 2 src pixels in m%1 as described above
+%macro REORDER 1
+    pshuflw      m4, m%1, 0x1B
+    pshufhw      m4, m4,  0x1B
+    pand         m4, m10
+    pandn        m5, m10, m%1
+    por          m4, m5
+    mova        m%1, m4
+    psrlq       m%1, m8
+    psllq        m4, m9
+    por         m%1, m4
+%endmacro
+
+cglobal overlay_blend_row_rgb, 5, 5, 11, dst, src, w, rev, rot
+    movsxdifnidn wq, wd
+    shl        rotd, 4
+    movd         m8, rotd
+    neg        rotd
+    add        rotd, 64
+    movd         m9, rotd
+    neg        revd
+    movd        m10, revd
+    pshufd      m10, m10, 0
+    pxor         m7, m7
+.loop:
+    movu         m0, [dstq]
+    psrldq       m1, m0, 3
+    psrldq       m2, m0, 6
+    psrldq       m3, m0, 9
+    punpckldq    m0, m1
+    punpckldq    m2, m3
+    punpcklqdq   m0, m2
+    punpckhbw    m1, m0, m7
+    punpcklbw    m0, m7
+    movu         m2, [srcq]
+    punpckhbw    m3, m2, m7
+    punpcklbw    m2, m7
+    REORDER       2
+    REORDER       3
+    pshuflw      m4, m2, 0xFF
+    pshufhw      m4, m4, 0xFF
+    pshuflw      m5, m3, 0xFF
+    pshufhw      m5, m5, 0xFF
+    BLEND         0, 2, 4, 6
+    BLEND         1, 3, 5, 6
+    packuswb     m0, m1
+    pand         m1, m0, [rgb_mask1]
+    pand         m2, m0, [rgb_mask2]
+    pand         m3, m0, [rgb_mask3]
+    pand         m0, [rgb_mask0]
+    psrldq       m1, 1
+    psrldq       m2, 2
+    psrldq       m3, 3
+    por          m0, m1
+    por          m2, m3
+    por          m0, m2
+    movq     [dstq], m0
+    psrldq       m0, 8
+    movd   [dstq+8], m0
+    add        dstq, 12
+    add        srcq, 16
+    sub          wq, 4
+    jg .loop
+    REP_RET
+%endif
@@ -0,0 +1,100 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/common.h"
+#include "libavutil/cpu.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/vf_overlay.h"
+
+void ff_overlay_blend_row_sse2(uint8_t *d, const uint8_t *s, const uint8_t *a,
+                               int w);
+void ff_overlay_blend_row_420_sse2(uint8_t *d, const uint8_t *s, const uint8_t *a,
+                                   ptrdiff_t alinesize, int w);
+void ff_overlay_blend_row_rgb_sse2(uint8_t *d, const uint8_t *o, int w,
+                                   int rev, int rot);
+
+#if HAVE_YASM
+static void overlay_blend_row_sse2(uint8_t *d, const uint8_t *s, const uint8_t *a,
+                                   int w)
+{
+    int x = w & ~15;
+
+    if (x)
+        ff_overlay_blend_row_sse2(d, s, a, x);
+    ff_overlay_blend_row_c(d + x, s + x, a + x, w - x);
+}
+
+static void overlay_blend_row_420_sse2(uint8_t *d, const uint8_t *s, const uint8_t *a,
+                                       ptrdiff_t alinesize, int w)
+{
+    int x = w & ~7;
+
+    if (x)
+        ff_overlay_blend_row_420_sse2(d, s, a, alinesize, x);
+    ff_overlay_blend_row_420_c(d + x, s + x, a + 2 * x, alinesize, w - x);
+}
+
+/* the asm brings the o components in the d order by optionally reversing
+ * them, then rotating them; find the way matching map */
+static int rgb_reorder(const uint8_t *map, int *rev, int *rot)
+{
+    int k;
+
+    for (*rev = 0; *rev < 2; (*rev)++) {
+        for (*rot = 0; *rot < 4; (*rot)++) {
+            for (k = 0; k < 4; k++) {
+                int i = (k + *rot) & 3;
+                if (map[k] != (*rev ? 3 - i : i))
+                    break;
+            }
+            if (k == 4)
+                return 1;
+        }
+    }
+    return 0;
+}
+
+static void overlay_blend_row_rgb_sse2(uint8_t *d, const uint8_t *o, const uint8_t *map,
+                                       int w)
+{
+    /* the last 16 byte read of d must not pass its end */
+    int x = FFMAX(w - 2, 0) & ~3;
+    int rev, rot;
+
+    if (x && rgb_reorder(map, &rev, &rot))
+        ff_overlay_blend_row_rgb_sse2(d, o, x, rev, rot);
+    else
+        x = 0;
+    ff_overlay_blend_row_rgb_c(d + 3 * x, o + 4 * x, map, w - x);
+}
+#endif /* HAVE_YASM */
+
+av_cold void ff_overlay_init_x86(OverlayContext *s)
+{
+#if HAVE_YASM
+    int cpu_flags = av_get_cpu_flags();
+
+    if (EXTERNAL_SSE2(cpu_flags)) {
+        s->blend_row     = overlay_blend_row_sse2;
+        s->blend_row_420 = overlay_blend_row_420_sse2;
+    }
+    if (ARCH_X86_64 && EXTERNAL_SSE2(cpu_flags))
+        s->blend_row_rgb = overlay_blend_row_rgb_sse2;
+#endif /* HAVE_YASM */
+}
@@ -50,6 +50,7 @@ typedef struct ResampleContext {
     enum AVSampleFormat format;
     int felem_size;
     int filter_shift;
+    ResampleDSPContext dsp;
 } ResampleContext;
 
 /**
@@ -229,6 +230,8 @@ static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_r
             av_assert0(0);
         }
 
+        if (HAVE_YASM && HAVE_MMX) swri_resample_dsp_init_x86(&c->dsp, c->format);
+
         c->phase_shift   = phase_shift;
         c->phase_mask    = phase_count - 1;
         c->linear        = linear;
@@ -310,32 +313,71 @@ static int set_compensation(ResampleContext *c, int sample_delta, int compensati
 
 #endif // HAVE_MMXEXT_INLINE
 
-static int multiple_resample(ResampleContext *c, AudioData *dst, int dst_size, AudioData *src, int src_size, int *consumed){
+static int resample_channels(ResampleContext *c, AudioData *dst, int dst_size, AudioData *src, int src_size, int *consumed,
+                             int ch_start, int ch_end, int update_ctx){
     int i, ret= -1;
     int av_unused mm_flags = av_get_cpu_flags();
     int need_emms= 0;
 
-    for(i=0; i<dst->ch_count; i++){
+    for(i=ch_start; i<ch_end; i++){
+        int update= update_ctx && i+1==ch_end;
 #if HAVE_MMXEXT_INLINE
 #if HAVE_SSSE3_INLINE
-             if(c->format == AV_SAMPLE_FMT_S16P && (mm_flags&AV_CPU_FLAG_SSSE3)) ret= swri_resample_int16_ssse3(c, (int16_t*)dst->ch[i], (const int16_t*)src->ch[i], consumed, src_size, dst_size, i+1==dst->ch_count);
+             if(c->format == AV_SAMPLE_FMT_S16P && !c->dsp.dot && (mm_flags&AV_CPU_FLAG_SSSE3)) ret= swri_resample_int16_ssse3(c, (int16_t*)dst->ch[i], (const int16_t*)src->ch[i], consumed, src_size, dst_size, update);
         else
 #endif
-             if(c->format == AV_SAMPLE_FMT_S16P && (mm_flags&AV_CPU_FLAG_MMX2 )){
-                 ret= swri_resample_int16_mmx2 (c, (int16_t*)dst->ch[i], (const int16_t*)src->ch[i], consumed, src_size, dst_size, i+1==dst->ch_count);
+             if(c->format == AV_SAMPLE_FMT_S16P && !c->dsp.dot && (mm_flags&AV_CPU_FLAG_MMX2 )){
+                 ret= swri_resample_int16_mmx2 (c, (int16_t*)dst->ch[i], (const int16_t*)src->ch[i], consumed, src_size, dst_size, update);
                  need_emms= 1;
              } else
 #endif
-             if(c->format == AV_SAMPLE_FMT_S16P) ret= swri_resample_int16(c, (int16_t*)dst->ch[i], (const int16_t*)src->ch[i], consumed, src_size, dst_size, i+1==dst->ch_count);
-        else if(c->format == AV_SAMPLE_FMT_S32P) ret= swri_resample_int32(c, (int32_t*)dst->ch[i], (const int32_t*)src->ch[i], consumed, src_size, dst_size, i+1==dst->ch_count);
-        else if(c->format == AV_SAMPLE_FMT_FLTP) ret= swri_resample_float(c, (float  *)dst->ch[i], (const float  *)src->ch[i], consumed, src_size, dst_size, i+1==dst->ch_count);
-        else if(c->format == AV_SAMPLE_FMT_DBLP) ret= swri_resample_double(c,(double *)dst->ch[i], (const double *)src->ch[i], consumed, src_size, dst_size, i+1==dst->ch_count);
+             if(c->format == AV_SAMPLE_FMT_S16P) ret= swri_resample_int16(c, (int16_t*)dst->ch[i], (const int16_t*)src->ch[i], consumed, src_size, dst_size, update);
+        else if(c->format == AV_SAMPLE_FMT_S32P) ret= swri_resample_int32(c, (int32_t*)dst->ch[i], (const int32_t*)src->ch[i], consumed, src_size, dst_size, update);
+        else if(c->format == AV_SAMPLE_FMT_FLTP) ret= swri_resample_float(c, (float  *)dst->ch[i], (const float  *)src->ch[i], consumed, src_size, dst_size, update);
+        else if(c->format == AV_SAMPLE_FMT_DBLP) ret= swri_resample_double(c,(double *)dst->ch[i], (const double *)src->ch[i], consumed, src_size, dst_size, update);
     }
     if(need_emms)
         emms_c();
     return ret;
 }
 
+typedef struct ResampleJobs {
+    ResampleContext *c;
+    ResampleContext last;   ///< private copy updated by the job resampling the last channel
+    AudioData *dst, *src;
+    int dst_size, src_size;
+    int nb_jobs;
+    int ret, consumed;
+} ResampleJobs;
+
+static void resample_job(void *arg, int jobnr){
+    ResampleJobs *j = arg;
+    int ch_start = j->dst->ch_count *  jobnr      / j->nb_jobs;
+    int ch_end   = j->dst->ch_count * (jobnr + 1) / j->nb_jobs;
+    int consumed;
+
+    /* All channels start from the same position, so every job reads the
+     * shared context and only the last one advances it, on its own copy. */
+    if(jobnr == j->nb_jobs - 1)
+        j->ret = resample_channels(&j->last, j->dst, j->dst_size, j->src, j->src_size, &j->consumed, ch_start, ch_end, 1);
+    else
+        resample_channels(j->c, j->dst, j->dst_size, j->src, j->src_size, &consumed, ch_start, ch_end, 0);
+}
+
+static int multiple_resample(ResampleContext *c, AudioData *dst, int dst_size, AudioData *src, int src_size, int *consumed,
+                             struct SwrThreadContext *thread){
+    int nb_jobs = HAVE_THREADS && thread ? FFMIN(swri_thread_count(thread), dst->ch_count) : 1;
+
+    if(nb_jobs > 1){
+        ResampleJobs j = { c, *c, dst, src, dst_size, src_size, nb_jobs };
+        swri_thread_execute(thread, resample_job, &j, nb_jobs);
+        *c = j.last;
+        *consumed = j.consumed;
+        return j.ret;
+    }
+    return resample_channels(c, dst, dst_size, src, src_size, consumed, 0, dst->ch_count, 1);
+}
+
 static int64_t get_delay(struct SwrContext *s, int64_t base){
     ResampleContext *c = s->resample;
     int64_t num = s->in_buffer_count - (c->filter_length-1)/2;
@@ -122,8 +122,12 @@ int RENAME(swri_resample)(ResampleContext *c, DELEM *dst, const DELEM *src, int
                 COMMON_CORE
 #else
                 FELEM2 val=0;
-                for(i=0; i<c->filter_length; i++){
-                    val += src[sample_index + i] * (FELEM2)filter[i];
+                if(c->dsp.dot){
+                    c->dsp.dot(&val, src + sample_index, filter, c->filter_length);
+                }else{
+                    for(i=0; i<c->filter_length; i++){
+                        val += src[sample_index + i] * (FELEM2)filter[i];
+                    }
                 }
                 OUT(dst[dst_index], val);
 #endif
@@ -154,11 +158,20 @@ int RENAME(swri_resample)(ResampleContext *c, DELEM *dst, const DELEM *src, int
                     val += src[FFABS(sample_index + i)] * (FELEM2)filter[i];
             }else if(c->linear){
                 FELEM2 v2=0;
-                for(i=0; i<c->filter_length; i++){
-                    val += src[sample_index + i] * (FELEM2)filter[i];
-                    v2  += src[sample_index + i] * (FELEM2)filter[i + c->filter_alloc];
+                if(c->dsp.dot2){
+                    FELEM2 acc[2];
+                    c->dsp.dot2(acc, src + sample_index, filter, filter + c->filter_alloc, c->filter_length);
+                    val = acc[0];
+                    v2  = acc[1];
+                }else{
+                    for(i=0; i<c->filter_length; i++){
+                        val += src[sample_index + i] * (FELEM2)filter[i];
+                        v2  += src[sample_index + i] * (FELEM2)filter[i + c->filter_alloc];
+                    }
                 }
                 val+=(v2-val)*(FELEML)frac / c->src_incr;
+            }else if(c->dsp.dot){
+                c->dsp.dot(&val, src + sample_index, filter, c->filter_length);
             }else{
                 for(i=0; i<c->filter_length; i++){
                     val += src[sample_index + i] * (FELEM2)filter[i];
@@ -73,7 +73,7 @@ static int flush(struct SwrContext *s){
 
 static int process(
         struct ResampleContext * c, AudioData *dst, int dst_size,
-        AudioData *src, int src_size, int *consumed){
+        AudioData *src, int src_size, int *consumed, struct SwrThreadContext *thread){
     size_t idone, odone;
     soxr_error_t error = soxr_set_error((soxr_t)c, soxr_set_num_channels((soxr_t)c, src->ch_count));
     error = soxr_process((soxr_t)c, src->ch, (size_t)src_size,
@@ -22,7 +22,10 @@
 #include "libavutil/avassert.h"
 #include "libavutil/channel_layout.h"
 #include "libavutil/common.h"
+#include "libavutil/cpu.h"
 #include "libavutil/opt.h"
+#include "libavutil/samplefmt.h"
+#include "libavutil/time.h"
 #include "swresample.h"
 
 #undef time
@@ -219,6 +222,97 @@ static void audiogen(void *data, enum AVSampleFormat sample_fmt,
     }
 }
 
+#define BENCH_IN_RATE   48000
+#define BENCH_OUT_RATE  44100
+#define BENCH_SECONDS   7
+#define BENCH_BLOCK     1024
+
+static int bench_run(uint8_t **out, uint8_t **in, int channels, int threads, int64_t *time){
+    int in_samples  = BENCH_SECONDS * BENCH_IN_RATE;
+    int out_samples = BENCH_SECONDS * BENCH_OUT_RATE + BENCH_BLOCK;
+    int64_t t0;
+    int i, ch, count = 0, ret;
+    uint8_t *o[SWR_CH_MAX];
+    const uint8_t *p[SWR_CH_MAX];
+    struct SwrContext *s = swr_alloc();
+
+    if (!s)
+        return AVERROR(ENOMEM);
+    av_opt_set_int(s, "ich", channels, 0);
+    av_opt_set_int(s, "och", channels, 0);
+    av_opt_set_int(s, "isr", BENCH_IN_RATE, 0);
+    av_opt_set_int(s, "osr", BENCH_OUT_RATE, 0);
+    av_opt_set_sample_fmt(s, "isf", AV_SAMPLE_FMT_FLTP, 0);
+    av_opt_set_sample_fmt(s, "osf", AV_SAMPLE_FMT_FLTP, 0);
+    av_opt_set_int(s, "threads", threads, 0);
+    if ((ret = swr_init(s)) < 0)
+        goto end;
+
+    t0 = av_gettime();
+    for (i = 0; i < in_samples; i += BENCH_BLOCK) {
+        for (ch = 0; ch < channels; ch++) {
+            p[ch] = in [ch] + i     * sizeof(float);
+            o[ch] = out[ch] + count * sizeof(float);
+        }
+        ret = swr_convert(s, o, out_samples - count, p, FFMIN(BENCH_BLOCK, in_samples - i));
+        if (ret < 0)
+            goto end;
+        count += ret;
+    }
+    *time = av_gettime() - t0;
+    ret = count;
+end:
+    swr_free(&s);
+    return ret;
+}
+
+/**
+ * Resample a multichannel signal single threaded and with the given number
+ * of threads, check that the outputs match and print the timings.
+ */
+static int bench(int channels, int threads){
+    int in_samples  = BENCH_SECONDS * BENCH_IN_RATE;
+    int out_samples = BENCH_SECONDS * BENCH_OUT_RATE + BENCH_BLOCK;
+    uint8_t *in[SWR_CH_MAX], *out1[SWR_CH_MAX], *outn[SWR_CH_MAX];
+    int64_t time1, timen;
+    int ch, count1, countn, ret = 1;
+
+    if (av_samples_alloc(in,   NULL, channels, in_samples,  AV_SAMPLE_FMT_FLTP, 0) < 0 ||
+        av_samples_alloc(out1, NULL, channels, out_samples, AV_SAMPLE_FMT_FLTP, 0) < 0 ||
+        av_samples_alloc(outn, NULL, channels, out_samples, AV_SAMPLE_FMT_FLTP, 0) < 0) {
+        fprintf(stderr, "Failed to allocate buffers\n");
+        return 1;
+    }
+    audiogen(in, AV_SAMPLE_FMT_FLTP, channels, BENCH_IN_RATE, in_samples);
+
+    count1 = bench_run(out1, in, channels, 1,       &time1);
+    countn = bench_run(outn, in, channels, threads, &timen);
+    if (count1 < 0 || countn < 0) {
+        fprintf(stderr, "Resampling failed\n");
+        goto end;
+    }
+    if (count1 != countn) {
+        fprintf(stderr, "Output length mismatch: %d != %d\n", count1, countn);
+        goto end;
+    }
+    for (ch = 0; ch < channels; ch++) {
+        if (memcmp(out1[ch], outn[ch], count1 * sizeof(float))) {
+            fprintf(stderr, "Output mismatch in channel %d\n", ch);
+            goto end;
+        }
+    }
+
+    fprintf(stderr, "%d channels, %d -> %d Hz, %d s: 1 thread %"PRId64" us, %d threads %"PRId64" us (%.2fx)\n",
+            channels, BENCH_IN_RATE, BENCH_OUT_RATE, BENCH_SECONDS,
+            time1, threads ? threads : av_cpu_count(), timen, timen ? time1 / (double)timen : 0.0);
+    ret = 0;
+end:
+    av_freep(&in[0]);
+    av_freep(&out1[0]);
+    av_freep(&outn[0]);
+    return ret;
+}
+
 int main(int argc, char **argv){
     int in_sample_rate, out_sample_rate, ch ,i, flush_count;
     uint64_t in_ch_layout, out_ch_layout;
@@ -245,9 +339,21 @@ int main(int argc, char **argv){
     if (argc > 1) {
         if (!strcmp(argv[1], "-h") || !strcmp(argv[1], "--help")) {
             av_log(NULL, AV_LOG_INFO, "Usage: swresample-test [<num_tests>[ <test>]]  \n"
-                   "num_tests           Default is %d\n", num_tests);
+                   "       swresample-test -bench [<channels>[ <threads>]]\n"
+                   "num_tests           Default is %d\n"
+                   "channels            Default is 16\n"
+                   "threads             Default is 0 (auto)\n", num_tests);
             return 0;
         }
+        if (!strcmp(argv[1], "-bench")) {
+            int channels = argc > 2 ? strtol(argv[2], NULL, 0) : 16;
+            int threads  = argc > 3 ? strtol(argv[3], NULL, 0) : 0;
+            if (channels < 1 || channels > SWR_CH_MAX || threads < 0) {
+                fprintf(stderr, "Invalid channel or thread count\n");
+                return 1;
+            }
+            return bench(channels, threads);
+        }
         num_tests = strtol(argv[1], NULL, 0);
         if(num_tests < 0) {
             num_tests = -num_tests;
@@ -36,6 +36,9 @@
 
 #define ALIGN 32
 
+/* number of samples converted at a time when no resampling is done */
+#define FUSED_BLOCK_SIZE 512
+
 //TODO split options array out?
 #define OFFSET(x) offsetof(SwrContext,x)
 #define PARAM AV_OPT_FLAG_AUDIO_PARAM
@@ -91,6 +94,8 @@ static const AVOption options[]={
 {"filter_size"          , "set swr resampling filter size", OFFSET(filter_size)  , AV_OPT_TYPE_INT  , {.i64=32                    }, 0      , INT_MAX   , PARAM },
 {"phase_shift"          , "set swr resampling phase shift", OFFSET(phase_shift)  , AV_OPT_TYPE_INT  , {.i64=10                    }, 0      , 24        , PARAM },
 {"linear_interp"        , "enable linear interpolation" , OFFSET(linear_interp)  , AV_OPT_TYPE_INT  , {.i64=0                     }, 0      , 1         , PARAM },
+{"threads"              , "set number of threads for resampling channels, 0 for auto"
+                                                        , OFFSET(nb_threads)     , AV_OPT_TYPE_INT  , {.i64=1                     }, 0      , INT_MAX   , PARAM },
 {"cutoff"               , "set cutoff frequency ratio"  , OFFSET(cutoff)         , AV_OPT_TYPE_DOUBLE,{.dbl=0.                    }, 0      , 1         , PARAM },
 
 /* duplicate option in order to work with avconv */
@@ -235,6 +240,8 @@ av_cold void swr_free(SwrContext **ss){
         if (s->resampler)
             s->resampler->free(&s->resample);
         swri_rematrix_free(s);
+        if (HAVE_THREADS)
+            swri_thread_free(s);
     }
 
     av_freep(ss);
@@ -259,6 +266,8 @@ av_cold int swr_init(struct SwrContext *s){
     swri_audio_convert_free(&s->out_convert);
     swri_audio_convert_free(&s->full_convert);
     swri_rematrix_free(s);
+    if (HAVE_THREADS)
+        swri_thread_free(s);
 
     s->flushed = 0;
 
@@ -433,6 +442,10 @@ av_assert0(s->out.ch_count);
         set_audiodata_fmt(&s->in_buffer, s->int_sample_fmt);
     }
 
+    if (HAVE_THREADS && s->resample && s->engine == SWR_ENGINE_SWR && s->nb_threads != 1 &&
+        (ret = swri_thread_init(s, s->in_buffer.ch_count)) < 0)
+        return ret;
+
     if ((ret = swri_dither_init(s, s->out_sample_fmt, s->int_sample_fmt)) < 0)
         return ret;
 
@@ -547,7 +560,7 @@ static int resample(SwrContext *s, AudioData *out_param, int out_count,
         int ret, size, consumed;
         if(!s->resample_in_constraint && s->in_buffer_count){
             buf_set(&tmp, &s->in_buffer, s->in_buffer_index);
-            ret= s->resampler->multiple_resample(s->resample, &out, out_count, &tmp, s->in_buffer_count, &consumed);
+            ret= s->resampler->multiple_resample(s->resample, &out, out_count, &tmp, s->in_buffer_count, &consumed, s->thread);
             out_count -= ret;
             ret_sum += ret;
             buf_set(&out, &out, ret);
@@ -567,7 +580,7 @@ static int resample(SwrContext *s, AudioData *out_param, int out_count,
 
         if((s->flushed || in_count > padless) && !s->in_buffer_count){
             s->in_buffer_index=0;
-            ret= s->resampler->multiple_resample(s->resample, &out, out_count, &in, FFMAX(in_count-padless, 0), &consumed);
+            ret= s->resampler->multiple_resample(s->resample, &out, out_count, &in, FFMAX(in_count-padless, 0), &consumed, s->thread);
             out_count -= ret;
             ret_sum += ret;
             buf_set(&out, &out, ret);
@@ -612,8 +625,19 @@ static int resample(SwrContext *s, AudioData *out_param, int out_count,
     return ret_sum;
 }
 
-static int swr_convert_internal(struct SwrContext *s, AudioData *out, int out_count,
-                                                      AudioData *in , int  in_count){
+static int dither_alloc(struct SwrContext *s, int count){
+    int ch, ret;
+
+    if((ret=swri_realloc_audio(&s->dither.noise, count))<0)
+        return ret;
+    if(ret)
+        for(ch=0; ch<s->dither.noise.ch_count; ch++)
+            swri_get_dither(s, s->dither.noise.ch[ch], s->dither.noise.count, 12345678913579<<ch, s->dither.noise.fmt);
+    return 0;
+}
+
+static int convert_block(struct SwrContext *s, AudioData *out, int out_count,
+                                               AudioData *in , int  in_count){
     AudioData *postin, *midbuf, *preout;
     int ret/*, in_max*/;
     AudioData preout_tmp, midbuf_tmp;
@@ -698,11 +722,8 @@ static int swr_convert_internal(struct SwrContext *s, AudioData *out, int out_co
                     return ret;
             }
 
-            if((ret=swri_realloc_audio(&s->dither.noise, dither_count))<0)
+            if((ret=dither_alloc(s, dither_count))<0)
                 return ret;
-            if(ret)
-                for(ch=0; ch<s->dither.noise.ch_count; ch++)
-                    swri_get_dither(s, s->dither.noise.ch[ch], s->dither.noise.count, 12345678913579<<ch, s->dither.noise.fmt);
             av_assert0(s->dither.noise.ch_count == preout->ch_count);
 
             if(s->dither.noise_pos + out_count > s->dither.noise.count)
@@ -739,6 +760,83 @@ static int swr_convert_internal(struct SwrContext *s, AudioData *out, int out_co
     return out_count;
 }
 
+/**
+ * Without resampling every output sample only depends on the input sample at
+ * the same position, so the input is converted, rematrixed and converted to
+ * the output format in blocks that stay in the cache, which also bounds the
+ * size of the intermediate buffers.
+ * Dithering is left unblocked as the noise is added in place to rematrix
+ * outputs which may alias their input or be left untouched between calls.
+ */
+static int swr_convert_internal(struct SwrContext *s, AudioData *out, int out_count,
+                                                      AudioData *in , int  in_count){
+    AudioData in_block, out_block;
+    int done = 0;
+
+    if(s->resample || s->full_convert || s->dither.method || in_count <= FUSED_BLOCK_SIZE)
+        return convert_block(s, out, out_count, in, in_count);
+
+    av_assert1(out_count == in_count);
+    in_block  = *in;
+    out_block = *out;
+    while(done < in_count){
+        int ret = convert_block(s, &out_block, FFMIN(out_count - done, FUSED_BLOCK_SIZE),
+                                   &in_block , FFMIN( in_count - done, FUSED_BLOCK_SIZE));
+        if(ret<0)
+            return ret;
+        done += ret;
+        buf_set(&in_block , in , done);
+        buf_set(&out_block, out, done);
+    }
+    return done;
+}
+
+int swr_preallocate(struct SwrContext *s, int max_in_count, int max_out_count){
+    int in_max = max_in_count, out_max = max_out_count;
+    int ret;
+
+    if(max_in_count < 0 || max_out_count < 0)
+        return AVERROR(EINVAL);
+    if(s->full_convert || !s->in_convert)
+        return 0;
+
+    if(!s->resample){
+        if(!s->dither.method){
+            in_max  = FFMIN(in_max , FUSED_BLOCK_SIZE);
+            out_max = FFMIN(out_max, FUSED_BLOCK_SIZE);
+        }
+    }else{
+        /* leftover input kept between calls, see resample() */
+        double cutoff = s->cutoff ? s->cutoff : 0.97;
+        double ratio  = FFMAX(s->in_sample_rate / (s->out_sample_rate * cutoff), 1.0);
+        int history   = FFMIN(s->filter_size * ratio, INT_MAX / 8) + 8;
+
+        if(max_in_count > INT_MAX / 4 - history)
+            return AVERROR(EINVAL);
+        if((ret=swri_realloc_audio(&s->in_buffer, 2*(max_in_count + history)))<0)
+            return ret;
+    }
+
+    if((ret=swri_realloc_audio(&s->postin, in_max))<0)
+        return ret;
+    if((ret=swri_realloc_audio(&s->midbuf, s->resample_first ? out_max : in_max))<0)
+        return ret;
+    if((ret=swri_realloc_audio(&s->preout, out_max))<0)
+        return ret;
+
+    if(s->dither.method){
+        int dither_count= FFMAX(out_max, 1<<16);
+
+        if((ret=dither_alloc(s, dither_count))<0)
+            return ret;
+        if(!s->resample && !s->rematrix &&
+           s->int_sample_fmt == s->in_sample_fmt && s->in.planar && !s->channel_map &&
+           (ret=swri_realloc_audio(&s->dither.temp, dither_count))<0)
+            return ret;
+    }
+    return 0;
+}
+
 int swr_convert(struct SwrContext *s, uint8_t *out_arg[SWR_CH_MAX], int out_count,
                                 const uint8_t *in_arg [SWR_CH_MAX], int  in_count){
     AudioData * in= &s->in;
@@ -216,6 +216,22 @@ void swr_free(struct SwrContext **s);
 int swr_convert(struct SwrContext *s, uint8_t **out, int out_count,
                                 const uint8_t **in , int in_count);
 
+/**
+ * Allocate the internal buffers of an initialized context up front.
+ *
+ * As long as swr_convert() is then called with at most max_in_count input
+ * and max_out_count output samples per channel, it does not need to allocate
+ * any memory. Dropping output, injecting silence and unusually large
+ * accumulations of input can still cause allocations.
+ * swr_init() frees the buffers again.
+ *
+ * @param s             initialized swr context
+ * @param max_in_count  maximum number of input samples per channel per call
+ * @param max_out_count maximum amount of output space per channel per call
+ * @return >= 0 on success, or a negative AVERROR code on failure
+ */
+int swr_preallocate(struct SwrContext *s, int max_in_count, int max_out_count);
+
 /**
  * Convert the next timestamp from input to output
  * timestamps are in 1/(in_sample_rate * out_sample_rate) units.
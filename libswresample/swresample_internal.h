@@ -40,6 +40,23 @@ typedef void (mix_2_1_func_type)(void *out, const void *in1, const void *in2, vo
 
 typedef void (mix_any_func_type)(uint8_t **out, const uint8_t **in1, void *coeffp, integer len);
 
+typedef void (mix_n_1_func_type)(void *out, const uint8_t **in, void *coeffp, integer nb_in, integer len);
+
+/**
+ * Filter dot products used by the resampler, acc receives the unrounded sum
+ * in the wide accumulator type of the sample format (int32_t for s16p,
+ * int64_t for s32p, float and double for fltp and dblp).
+ * dot2 evaluates two filters over the same input for linear interpolation
+ * and stores both sums in acc[0] and acc[1].
+ */
+typedef void (resample_dot_func_type)(void *acc, const void *src, const void *filter, int len);
+typedef void (resample_dot2_func_type)(void *acc, const void *src, const void *filter, const void *filter2, int len);
+
+typedef struct ResampleDSPContext {
+    resample_dot_func_type  *dot;
+    resample_dot2_func_type *dot2;
+} ResampleDSPContext;
+
 typedef struct AudioData{
     uint8_t *ch[SWR_CH_MAX];    ///< samples buffer per channel
     uint8_t *data;              ///< samples buffer
@@ -147,13 +164,18 @@ struct SwrContext {
 
     mix_any_func_type *mix_any_f;
 
+    mix_n_1_func_type *mix_n_1_simd;
+
+    int nb_threads;                                 ///< number of threads requested by the user, 0 for auto
+    struct SwrThreadContext *thread;                ///< worker pool for resampling channels in parallel, NULL if single threaded
+
     /* TODO: callbacks for ASM optimizations */
 };
 
 typedef struct ResampleContext * (* resample_init_func)(struct ResampleContext *c, int out_rate, int in_rate, int filter_size, int phase_shift, int linear,
                                     double cutoff, enum AVSampleFormat format, enum SwrFilterType filter_type, int kaiser_beta, double precision, int cheby);
 typedef void    (* resample_free_func)(struct ResampleContext **c);
-typedef int     (* multiple_resample_func)(struct ResampleContext *c, AudioData *dst, int dst_size, AudioData *src, int src_size, int *consumed);
+typedef int     (* multiple_resample_func)(struct ResampleContext *c, AudioData *dst, int dst_size, AudioData *src, int src_size, int *consumed, struct SwrThreadContext *thread);
 typedef int     (* resample_flush_func)(struct SwrContext *c);
 typedef int     (* set_compensation_func)(struct ResampleContext *c, int sample_delta, int compensation_distance);
 typedef int64_t (* get_delay_func)(struct SwrContext *s, int64_t base);
@@ -170,6 +192,27 @@ struct Resampler {
 extern struct Resampler const swri_resampler;
 
 int swri_realloc_audio(AudioData *a, int count);
+
+typedef struct SwrThreadContext SwrThreadContext;
+typedef void (swri_thread_func_type)(void *arg, int jobnr);
+
+/**
+ * Start a pool of s->nb_threads workers, but no more than nb_channels.
+ * Does nothing and leaves s->thread NULL if a single thread is enough.
+ */
+int  swri_thread_init(SwrContext *s, int nb_channels);
+void swri_thread_free(SwrContext *s);
+/**
+ * @return the number of workers in t, 1 if t is NULL
+ */
+int  swri_thread_count(const SwrThreadContext *t);
+/**
+ * Run func(arg, jobnr) for jobnr from 0 to nb_jobs - 1 on the workers of t
+ * and wait until all of them have returned, nb_jobs must not be larger than
+ * swri_thread_count(t).
+ */
+void swri_thread_execute(SwrThreadContext *t, swri_thread_func_type *func,
+                         void *arg, int nb_jobs);
 int swri_resample_int16(struct ResampleContext *c, int16_t *dst, const int16_t *src, int *consumed, int src_size, int dst_size, int update_ctx);
 int swri_resample_int32(struct ResampleContext *c, int32_t *dst, const int32_t *src, int *consumed, int src_size, int dst_size, int update_ctx);
 int swri_resample_float(struct ResampleContext *c, float   *dst, const float   *src, int *consumed, int src_size, int dst_size, int update_ctx);
@@ -185,6 +228,8 @@ void swri_rematrix_free(SwrContext *s);
 int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mustcopy);
 void swri_rematrix_init_x86(struct SwrContext *s);
 
+void swri_resample_dsp_init_x86(ResampleDSPContext *dsp, enum AVSampleFormat format);
+
 void swri_get_dither(SwrContext *s, void *dst, int len, unsigned seed, enum AVSampleFormat noise_fmt);
 int swri_dither_init(SwrContext *s, enum AVSampleFormat out_fmt, enum AVSampleFormat in_fmt);
 
@@ -0,0 +1,207 @@
+/*
+ * This file is part of libswresample
+ *
+ * libswresample is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libswresample is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libswresample; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * libswresample channel multithreading support
+ *
+ * A small worker pool on which the resampler runs groups of channels in
+ * parallel, see multiple_resample() in resample.c.
+ */
+
+#include "config.h"
+
+#include "libavutil/avassert.h"
+#include "libavutil/common.h"
+#include "libavutil/cpu.h"
+#include "libavutil/mem.h"
+
+#include "swresample_internal.h"
+
+#if HAVE_PTHREADS
+#include <pthread.h>
+#elif HAVE_OS2THREADS
+#include "compat/os2threads.h"
+#elif HAVE_W32THREADS
+#include "compat/w32pthreads.h"
+#endif
+
+struct SwrThreadContext {
+    int nb_threads;
+    pthread_t *workers;
+
+    /* per-execute parameters */
+    swri_thread_func_type *func;
+    void *arg;
+    int nb_jobs;
+
+    pthread_cond_t last_job_cond;
+    pthread_cond_t current_job_cond;
+    pthread_mutex_t current_job_lock;
+    int current_job;
+    unsigned int current_execute;
+    int done;
+};
+
+static void* attribute_align_arg worker(void *v)
+{
+    SwrThreadContext *t = v;
+    int our_job         = t->nb_jobs;
+    int nb_threads      = t->nb_threads;
+    unsigned int last_execute = 0;
+    int self_id;
+
+    pthread_mutex_lock(&t->current_job_lock);
+    self_id = t->current_job++;
+    for (;;) {
+        while (our_job >= t->nb_jobs) {
+            if (t->current_job == nb_threads + t->nb_jobs)
+                pthread_cond_signal(&t->last_job_cond);
+
+            while (last_execute == t->current_execute && !t->done)
+                pthread_cond_wait(&t->current_job_cond, &t->current_job_lock);
+            last_execute = t->current_execute;
+            our_job = self_id;
+
+            if (t->done) {
+                pthread_mutex_unlock(&t->current_job_lock);
+                return NULL;
+            }
+        }
+        pthread_mutex_unlock(&t->current_job_lock);
+
+        t->func(t->arg, our_job);
+
+        pthread_mutex_lock(&t->current_job_lock);
+        our_job = t->current_job++;
+    }
+}
+
+static void park_workers(SwrThreadContext *t)
+{
+    while (t->current_job != t->nb_threads + t->nb_jobs)
+        pthread_cond_wait(&t->last_job_cond, &t->current_job_lock);
+    pthread_mutex_unlock(&t->current_job_lock);
+}
+
+static void thread_uninit(SwrThreadContext *t)
+{
+    int i;
+
+    pthread_mutex_lock(&t->current_job_lock);
+    t->done = 1;
+    pthread_cond_broadcast(&t->current_job_cond);
+    pthread_mutex_unlock(&t->current_job_lock);
+
+    for (i = 0; i < t->nb_threads; i++)
+        pthread_join(t->workers[i], NULL);
+
+    pthread_mutex_destroy(&t->current_job_lock);
+    pthread_cond_destroy(&t->current_job_cond);
+    pthread_cond_destroy(&t->last_job_cond);
+    av_freep(&t->workers);
+}
+
+static int thread_init(SwrThreadContext *t, int nb_threads)
+{
+    int i, ret;
+
+    t->workers = av_mallocz(sizeof(*t->workers) * nb_threads);
+    if (!t->workers)
+        return AVERROR(ENOMEM);
+
+    t->nb_threads  = nb_threads;
+    t->current_job = 0;
+    t->nb_jobs     = 0;
+    t->done        = 0;
+
+    pthread_cond_init(&t->current_job_cond, NULL);
+    pthread_cond_init(&t->last_job_cond,    NULL);
+
+    pthread_mutex_init(&t->current_job_lock, NULL);
+    pthread_mutex_lock(&t->current_job_lock);
+    for (i = 0; i < nb_threads; i++) {
+        ret = pthread_create(&t->workers[i], NULL, worker, t);
+        if (ret) {
+            pthread_mutex_unlock(&t->current_job_lock);
+            t->nb_threads = i;
+            thread_uninit(t);
+            return AVERROR(ret);
+        }
+    }
+
+    park_workers(t);
+
+    return 0;
+}
+
+av_cold int swri_thread_init(SwrContext *s, int nb_channels)
+{
+    int nb_threads = s->nb_threads;
+    int ret;
+
+#if HAVE_W32THREADS
+    w32thread_init();
+#endif
+
+    if (!nb_threads)
+        nb_threads = av_cpu_count();
+    nb_threads = FFMIN(nb_threads, nb_channels);
+    if (nb_threads <= 1)
+        return 0;
+
+    s->thread = av_mallocz(sizeof(*s->thread));
+    if (!s->thread)
+        return AVERROR(ENOMEM);
+    if ((ret = thread_init(s->thread, nb_threads)) < 0) {
+        av_freep(&s->thread);
+        return ret;
+    }
+
+    return 0;
+}
+
+av_cold void swri_thread_free(SwrContext *s)
+{
+    if (s->thread)
+        thread_uninit(s->thread);
+    av_freep(&s->thread);
+}
+
+int swri_thread_count(const SwrThreadContext *t)
+{
+    return t ? t->nb_threads : 1;
+}
+
+void swri_thread_execute(SwrThreadContext *t, swri_thread_func_type *func,
+                         void *arg, int nb_jobs)
+{
+    av_assert1(nb_jobs <= t->nb_threads);
+
+    pthread_mutex_lock(&t->current_job_lock);
+
+    t->func        = func;
+    t->arg         = arg;
+    t->current_job = t->nb_threads;
+    t->nb_jobs     = nb_jobs;
+    t->current_execute++;
+
+    pthread_cond_broadcast(&t->current_job_cond);
+
+    park_workers(t);
+}
@@ -223,6 +223,117 @@ mix_2_1_int16_u_int %+ SUFFIX
 %endmacro
 
 
+;------------------------------------------------------------------------------
+; Mix an arbitrary number of input channels into one output channel,
+; out[i] = sum of coeffp[j] * in[j][i] for j < nb_in, nb_in >= 1.
+; len must be a multiple of 16, buffers do not need to be aligned.
+;
+; void ff_mix_n_1_float(float *out, const float **in, const float *coeffp,
+;                       integer nb_in, integer len)
+;------------------------------------------------------------------------------
+
+%macro MIXN_FLT 0
+cglobal mix_n_1_float, 5, 8, 5, out, in, coeffp, nb, len, pos, j, ptr
+    shl        lenq, 2
+    xor        posq, posq
+.next:
+    xorps        m0, m0
+    xorps        m1, m1
+    xor          jq, jq
+.channel:
+    mov        ptrq, [inq + jq*gprsize]
+    VBROADCASTSS m2, [coeffpq + 4*jq]
+%if cpuflag(fma4)
+    fmaddps      m0, m2, [ptrq + posq         ], m0
+    fmaddps      m1, m2, [ptrq + posq + mmsize], m1
+%else
+    movu         m3, [ptrq + posq         ]
+    movu         m4, [ptrq + posq + mmsize]
+    mulps        m3, m3, m2
+    mulps        m4, m4, m2
+    addps        m0, m0, m3
+    addps        m1, m1, m4
+%endif
+    inc          jq
+    cmp          jq, nbq
+        jl .channel
+    movu  [outq + posq         ], m0
+    movu  [outq + posq + mmsize], m1
+    add        posq, mmsize*2
+    cmp        posq, lenq
+        jl .next
+    REP_RET
+%endmacro
+
+;------------------------------------------------------------------------------
+; int16 variant, the input channels are interleaved in pairs for pmaddwd and
+; the result saturated to 16 bits. Each coefficient is a word pair holding the
+; 16 bit coefficient and the shift of the output channel, as in
+; native_simd_matrix.
+;
+; void ff_mix_n_1_int16(int16_t *out, const int16_t **in, const int32_t *coeffp,
+;                       integer nb_in, integer len)
+;------------------------------------------------------------------------------
+
+%macro MIXN_INT16 0
+cglobal mix_n_1_int16, 5, 9, 8, out, in, coeffp, nb, len, pos, j, ptr, ptr2
+    movd         m7, [coeffpq]
+    psrld        m7, 16
+    mova         m6, [dw1]
+    pslld        m6, m7
+    psrld        m6, 1
+    add        lenq, lenq
+    dec         nbq
+    xor        posq, posq
+.next:
+    mova         m0, m6
+    mova         m1, m6
+    xor          jq, jq
+.pair:
+    cmp          jq, nbq
+        jge .last
+    mov        ptrq, [inq + jq*gprsize          ]
+    mov       ptr2q, [inq + jq*gprsize + gprsize]
+    movd         m5, [coeffpq + 4*jq]
+    pinsrw       m5, [coeffpq + 4*jq + 4], 1
+    pshufd       m5, m5, 0
+    movu         m2, [ptrq  + posq]
+    movu         m4, [ptr2q + posq]
+    mova         m3, m2
+    punpcklwd    m2, m4
+    punpckhwd    m3, m4
+    pmaddwd      m2, m5
+    pmaddwd      m3, m5
+    paddd        m0, m2
+    paddd        m1, m3
+    add          jq, 2
+    jmp .pair
+.last:
+        jg .store
+    mov        ptrq, [inq + jq*gprsize]
+    movd         m5, [coeffpq + 4*jq]
+    pshufd       m5, m5, 0
+    pxor         m4, m4
+    movu         m2, [ptrq + posq]
+    mova         m3, m2
+    punpcklwd    m2, m4
+    punpckhwd    m3, m4
+    pmaddwd      m2, m5
+    pmaddwd      m3, m5
+    paddd        m0, m2
+    paddd        m1, m3
+.store:
+    psrad        m0, m7
+    psrad        m1, m7
+    packssdw     m0, m1
+    movu  [outq + posq], m0
+    add        posq, mmsize
+    cmp        posq, lenq
+        jl .next
+    REP_RET
+%endmacro
+
+
 INIT_MMX mmx
 MIX1_INT16 u
 MIX1_INT16 a
@@ -248,3 +359,18 @@ MIX2_FLT a
 MIX1_FLT u
 MIX1_FLT a
 %endif
+
+%if ARCH_X86_64
+INIT_XMM sse
+MIXN_FLT
+INIT_XMM sse2
+MIXN_INT16
+%if HAVE_AVX_EXTERNAL
+INIT_YMM avx
+MIXN_FLT
+%endif
+%if HAVE_FMA4_EXTERNAL
+INIT_YMM fma4
+MIXN_FLT
+%endif
+%endif
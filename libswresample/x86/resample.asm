@@ -0,0 +1,320 @@
+;******************************************************************************
+;* polyphase resampler filter kernels
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION .text
+
+; horizontal sums of m%1 into the low element of xm%1, m%2 is clobbered
+%macro HADD_ps 2
+%if mmsize == 32
+    vextractf128 xm%2, m%1, 1
+    addps        xm%1, xm%2
+%endif
+    movhlps      xm%2, xm%1, xm%1
+    addps        xm%1, xm%2
+    shufps       xm%2, xm%1, xm%1, q1111
+    addss        xm%1, xm%2
+%endmacro
+
+%macro HADD_pd 2
+%if mmsize == 32
+    vextractf128 xm%2, m%1, 1
+    addpd        xm%1, xm%2
+%endif
+    movhlps      xm%2, xm%1, xm%1
+    addsd        xm%1, xm%2
+%endmacro
+
+%macro HADD_d 2
+    pshufd       m%2, m%1, q3232
+    paddd        m%1, m%2
+    pshufd       m%2, m%1, q1111
+    paddd        m%1, m%2
+%endmacro
+
+%macro HADD_q 2
+    pshufd       m%2, m%1, q3232
+    paddq        m%1, m%2
+%endmacro
+
+;------------------------------------------------------------------------------
+; int16: the rows of the filter bank are zero padded to a multiple of 8 taps,
+; so like the inline asm in resample_mmx.h the length is rounded up to whole
+; registers and the sum is left in 32 bits, exactly as the C code computes it.
+;
+; void ff_resample_dot_int16(int32_t *acc, const int16_t *src,
+;                            const int16_t *filter, int len)
+; void ff_resample_dot2_int16(int32_t acc[2], const int16_t *src,
+;                             const int16_t *filter, const int16_t *filter2,
+;                             int len)
+;------------------------------------------------------------------------------
+
+%macro RESAMPLE_INT16 0
+cglobal resample_dot_int16, 4, 4, 2, acc, src, filter, len
+    movsxdifnidn lenq, lend
+    lea        srcq, [srcq+lenq*2]
+    lea     filterq, [filterq+lenq*2]
+    neg        lenq
+    pxor         m0, m0
+.loop:
+    movu         m1, [srcq+lenq*2]
+    pmaddwd      m1, [filterq+lenq*2]
+    paddd        m0, m1
+    add        lenq, mmsize/2
+    jl .loop
+    HADD_d        0, 1
+    movd     [accq], m0
+    RET
+
+cglobal resample_dot2_int16, 5, 5, 4, acc, src, filter, filter2, len
+    movsxdifnidn lenq, lend
+    lea        srcq, [srcq+lenq*2]
+    lea     filterq, [filterq+lenq*2]
+    lea    filter2q, [filter2q+lenq*2]
+    neg        lenq
+    pxor         m0, m0
+    pxor         m2, m2
+.loop:
+    movu         m1, [srcq+lenq*2]
+    pmaddwd      m3, m1, [filter2q+lenq*2]
+    pmaddwd      m1, [filterq+lenq*2]
+    paddd        m0, m1
+    paddd        m2, m3
+    add        lenq, mmsize/2
+    jl .loop
+    HADD_d        0, 1
+    HADD_d        2, 3
+    movd   [accq+0], m0
+    movd   [accq+4], m2
+    RET
+%endmacro
+
+;------------------------------------------------------------------------------
+; int32: products are accumulated in 64 bits, remaining taps are handled one
+; at a time so the input is never read past len.
+;
+; void ff_resample_dot_int32(int64_t *acc, const int32_t *src,
+;                            const int32_t *filter, int len)
+; void ff_resample_dot2_int32(int64_t acc[2], const int32_t *src,
+;                             const int32_t *filter, const int32_t *filter2,
+;                             int len)
+;------------------------------------------------------------------------------
+
+; m%1 += src * filter for the 4 dwords in m%2 and [%3], m%2, m%4, m%5 are clobbered
+%macro PMULACC_DQ 5
+    pshufd       m%4, m%2, q3311
+    pmuldq       m%2, %3
+    pshufd       m%5, %3, q3311
+    pmuldq       m%4, m%5
+    paddq        m%1, m%2
+    paddq        m%1, m%4
+%endmacro
+
+%macro RESAMPLE_INT32 0
+cglobal resample_dot_int32, 4, 5, 4, acc, src, filter, len, blk
+    movsxdifnidn lenq, lend
+    pxor         m0, m0
+    mov        blkq, lenq
+    and        blkq, -(mmsize/4)
+    lea        srcq, [srcq+blkq*4]
+    lea     filterq, [filterq+blkq*4]
+    sub        lenq, blkq
+    neg        blkq
+    jz .hadd
+.loop:
+    movu         m1, [srcq+blkq*4]
+    PMULACC_DQ    0, 1, [filterq+blkq*4], 2, 3
+    add        blkq, mmsize/4
+    jl .loop
+.hadd:
+    HADD_q        0, 1
+    test       lenq, lenq
+    jz .end
+.tail:
+    movd         m1, [srcq]
+    movd         m2, [filterq]
+    pmuldq       m1, m2
+    paddq        m0, m1
+    add        srcq, 4
+    add     filterq, 4
+    dec        lenq
+    jg .tail
+.end:
+    movq     [accq], m0
+    RET
+
+cglobal resample_dot2_int32, 5, 6, 6, acc, src, filter, filter2, len, blk
+    movsxdifnidn lenq, lend
+    pxor         m0, m0
+    pxor         m4, m4
+    mov        blkq, lenq
+    and        blkq, -(mmsize/4)
+    lea        srcq, [srcq+blkq*4]
+    lea     filterq, [filterq+blkq*4]
+    lea    filter2q, [filter2q+blkq*4]
+    sub        lenq, blkq
+    neg        blkq
+    jz .hadd
+.loop:
+    movu         m1, [srcq+blkq*4]
+    mova         m5, m1
+    PMULACC_DQ    0, 1, [filterq +blkq*4], 2, 3
+    PMULACC_DQ    4, 5, [filter2q+blkq*4], 2, 3
+    add        blkq, mmsize/4
+    jl .loop
+.hadd:
+    HADD_q        0, 1
+    HADD_q        4, 1
+    test       lenq, lenq
+    jz .end
+.tail:
+    movd         m1, [srcq]
+    movd         m2, [filterq]
+    movd         m3, [filter2q]
+    pmuldq       m2, m1
+    pmuldq       m3, m1
+    paddq        m0, m2
+    paddq        m4, m3
+    add        srcq, 4
+    add     filterq, 4
+    add    filter2q, 4
+    dec        lenq
+    jg .tail
+.end:
+    movq   [accq+0], m0
+    movq   [accq+8], m4
+    RET
+%endmacro
+
+;------------------------------------------------------------------------------
+; float / double
+;
+; void ff_resample_dot_<type>(<type> *acc, const <type> *src,
+;                             const <type> *filter, int len)
+; void ff_resample_dot2_<type>(<type> acc[2], const <type> *src,
+;                              const <type> *filter, const <type> *filter2,
+;                              int len)
+;------------------------------------------------------------------------------
+
+; m%1 += m%2 * %3 with %4 = ps/pd, m%2 is clobbered
+%macro MULACC 4
+%if cpuflag(fma4)
+    fmadd%4      m%1, m%2, %3, m%1
+%else
+    mul%4        m%2, %3
+    add%4        m%1, m%2
+%endif
+%endmacro
+
+; %1 = type, %2 = packed suffix, %3 = scalar suffix, %4 = bytes per sample
+%macro RESAMPLE_FLOAT 4
+cglobal resample_dot_%1, 4, 5, 3, acc, src, filter, len, blk
+    movsxdifnidn lenq, lend
+    xorps        m0, m0
+    mov        blkq, lenq
+    and        blkq, -(mmsize/%4)
+    lea        srcq, [srcq+blkq*%4]
+    lea     filterq, [filterq+blkq*%4]
+    sub        lenq, blkq
+    neg        blkq
+    jz .hadd
+.loop:
+    movu         m1, [srcq+blkq*%4]
+    MULACC        0, 1, [filterq+blkq*%4], %2
+    add        blkq, mmsize/%4
+    jl .loop
+.hadd:
+    HADD_%2       0, 1
+    test       lenq, lenq
+    jz .end
+.tail:
+    mov%3       xm1, [srcq]
+    mul%3       xm1, [filterq]
+    add%3       xm0, xm1
+    add        srcq, %4
+    add     filterq, %4
+    dec        lenq
+    jg .tail
+.end:
+    mov%3    [accq], xm0
+    RET
+
+cglobal resample_dot2_%1, 5, 6, 5, acc, src, filter, filter2, len, blk
+    movsxdifnidn lenq, lend
+    xorps        m0, m0
+    xorps        m3, m3
+    mov        blkq, lenq
+    and        blkq, -(mmsize/%4)
+    lea        srcq, [srcq+blkq*%4]
+    lea     filterq, [filterq+blkq*%4]
+    lea    filter2q, [filter2q+blkq*%4]
+    sub        lenq, blkq
+    neg        blkq
+    jz .hadd
+.loop:
+    movu         m1, [srcq+blkq*%4]
+    mova         m4, m1
+    MULACC        0, 1, [filterq +blkq*%4], %2
+    MULACC        3, 4, [filter2q+blkq*%4], %2
+    add        blkq, mmsize/%4
+    jl .loop
+.hadd:
+    HADD_%2       0, 1
+    HADD_%2       3, 1
+    test       lenq, lenq
+    jz .end
+.tail:
+    mov%3       xm1, [srcq]
+    mov%3       xm2, xm1
+    mul%3       xm1, [filterq]
+    mul%3       xm2, [filter2q]
+    add%3       xm0, xm1
+    add%3       xm3, xm2
+    add        srcq, %4
+    add     filterq, %4
+    add    filter2q, %4
+    dec        lenq
+    jg .tail
+.end:
+    mov%3  [accq+0], xm0
+    mov%3 [accq+%4], xm3
+    RET
+%endmacro
+
+INIT_XMM sse2
+RESAMPLE_INT16
+RESAMPLE_FLOAT double, pd, sd, 8
+INIT_XMM sse
+RESAMPLE_FLOAT float, ps, ss, 4
+%if HAVE_SSE4_EXTERNAL
+INIT_XMM sse4
+RESAMPLE_INT32
+%endif
+%if HAVE_AVX_EXTERNAL
+INIT_YMM avx
+RESAMPLE_FLOAT float, ps, ss, 4
+RESAMPLE_FLOAT double, pd, sd, 8
+%endif
+%if HAVE_FMA4_EXTERNAL
+INIT_YMM fma4
+RESAMPLE_FLOAT float, ps, ss, 4
+RESAMPLE_FLOAT double, pd, sd, 8
+%endif
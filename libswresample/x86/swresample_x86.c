@@ -148,6 +148,10 @@ D(float, avx)
 D(int16, mmx)
 D(int16, sse2)
 
+mix_n_1_func_type ff_mix_n_1_float_sse;
+mix_n_1_func_type ff_mix_n_1_float_avx;
+mix_n_1_func_type ff_mix_n_1_float_fma4;
+mix_n_1_func_type ff_mix_n_1_int16_sse2;
 
 av_cold void swri_rematrix_init_x86(struct SwrContext *s){
     int mm_flags = av_get_cpu_flags();
@@ -158,6 +162,7 @@ av_cold void swri_rematrix_init_x86(struct SwrContext *s){
 
     s->mix_1_1_simd = NULL;
     s->mix_2_1_simd = NULL;
+    s->mix_n_1_simd = NULL;
 
     if (s->midbuf.fmt == AV_SAMPLE_FMT_S16P){
         if(mm_flags & AV_CPU_FLAG_MMX) {
@@ -167,6 +172,8 @@ av_cold void swri_rematrix_init_x86(struct SwrContext *s){
         if(mm_flags & AV_CPU_FLAG_SSE2) {
             s->mix_1_1_simd = ff_mix_1_1_a_int16_sse2;
             s->mix_2_1_simd = ff_mix_2_1_a_int16_sse2;
+            if (ARCH_X86_64)
+                s->mix_n_1_simd = ff_mix_n_1_int16_sse2;
         }
         s->native_simd_matrix = av_mallocz(2 * num * sizeof(int16_t));
         s->native_simd_one    = av_mallocz(2 * sizeof(int16_t));
@@ -187,14 +194,78 @@ av_cold void swri_rematrix_init_x86(struct SwrContext *s){
         if(mm_flags & AV_CPU_FLAG_SSE) {
             s->mix_1_1_simd = ff_mix_1_1_a_float_sse;
             s->mix_2_1_simd = ff_mix_2_1_a_float_sse;
+            if (ARCH_X86_64)
+                s->mix_n_1_simd = ff_mix_n_1_float_sse;
         }
         if(HAVE_AVX_EXTERNAL && mm_flags & AV_CPU_FLAG_AVX) {
             s->mix_1_1_simd = ff_mix_1_1_a_float_avx;
             s->mix_2_1_simd = ff_mix_2_1_a_float_avx;
+            if (ARCH_X86_64)
+                s->mix_n_1_simd = ff_mix_n_1_float_avx;
         }
+        if(ARCH_X86_64 && HAVE_FMA4_EXTERNAL && mm_flags & AV_CPU_FLAG_FMA4)
+            s->mix_n_1_simd = ff_mix_n_1_float_fma4;
         s->native_simd_matrix = av_mallocz(num * sizeof(float));
         memcpy(s->native_simd_matrix, s->native_matrix, num * sizeof(float));
         s->native_simd_one = av_mallocz(sizeof(float));
         memcpy(s->native_simd_one, s->native_one, sizeof(float));
     }
 }
+
+#define RESAMPLE_FUNCS(type, opt) \
+void ff_resample_dot_  ## type ## _ ## opt(void *acc, const void *src, const void *filter, int len);\
+void ff_resample_dot2_ ## type ## _ ## opt(void *acc, const void *src, const void *filter, const void *filter2, int len);
+
+RESAMPLE_FUNCS(int16,  sse2)
+RESAMPLE_FUNCS(int32,  sse4)
+RESAMPLE_FUNCS(float,  sse)
+RESAMPLE_FUNCS(float,  avx)
+RESAMPLE_FUNCS(float,  fma4)
+RESAMPLE_FUNCS(double, sse2)
+RESAMPLE_FUNCS(double, avx)
+RESAMPLE_FUNCS(double, fma4)
+
+av_cold void swri_resample_dsp_init_x86(ResampleDSPContext *dsp, enum AVSampleFormat format){
+    int mm_flags = av_get_cpu_flags();
+
+#define ASSIGN_RESAMPLE_FUNCS(type, opt) \
+    dsp->dot  = ff_resample_dot_  ## type ## _ ## opt;\
+    dsp->dot2 = ff_resample_dot2_ ## type ## _ ## opt;
+
+    switch(format){
+    case AV_SAMPLE_FMT_S16P:
+        if(mm_flags & AV_CPU_FLAG_SSE2) {
+            ASSIGN_RESAMPLE_FUNCS(int16, sse2)
+        }
+        break;
+    case AV_SAMPLE_FMT_S32P:
+        if(HAVE_SSE4_EXTERNAL && mm_flags & AV_CPU_FLAG_SSE4) {
+            ASSIGN_RESAMPLE_FUNCS(int32, sse4)
+        }
+        break;
+    case AV_SAMPLE_FMT_FLTP:
+        if(mm_flags & AV_CPU_FLAG_SSE) {
+            ASSIGN_RESAMPLE_FUNCS(float, sse)
+        }
+        if(HAVE_AVX_EXTERNAL && mm_flags & AV_CPU_FLAG_AVX) {
+            ASSIGN_RESAMPLE_FUNCS(float, avx)
+        }
+        if(HAVE_FMA4_EXTERNAL && mm_flags & AV_CPU_FLAG_FMA4) {
+            ASSIGN_RESAMPLE_FUNCS(float, fma4)
+        }
+        break;
+    case AV_SAMPLE_FMT_DBLP:
+        if(mm_flags & AV_CPU_FLAG_SSE2) {
+            ASSIGN_RESAMPLE_FUNCS(double, sse2)
+        }
+        if(HAVE_AVX_EXTERNAL && mm_flags & AV_CPU_FLAG_AVX) {
+            ASSIGN_RESAMPLE_FUNCS(double, avx)
+        }
+        if(HAVE_FMA4_EXTERNAL && mm_flags & AV_CPU_FLAG_FMA4) {
+            ASSIGN_RESAMPLE_FUNCS(double, fma4)
+        }
+        break;
+    default:
+        break;
+    }
+}
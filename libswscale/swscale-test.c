@@ -28,9 +28,11 @@
 #include "libavutil/imgutils.h"
 #include "libavutil/mem.h"
 #include "libavutil/avutil.h"
+#include "libavutil/cpu.h"
 #include "libavutil/crc.h"
 #include "libavutil/pixdesc.h"
 #include "libavutil/lfg.h"
+#include "libavutil/time.h"
 #include "swscale.h"
 
 /* HACK Duplicated from swscale_internal.h.
@@ -286,6 +288,230 @@ static void selfTest(uint8_t *ref[4], int refStride[4], int w, int h,
     }
 }
 
+/* CPU flag sets benchmarked after plain C, each one adds to the previous */
+static const struct {
+    const char *name;
+    int flags;
+} bench_cpu_levels[] = {
+    { "mmx",    AV_CPU_FLAG_MMX                       },
+    { "mmxext", AV_CPU_FLAG_MMXEXT                    },
+    { "sse2",   AV_CPU_FLAG_SSE   | AV_CPU_FLAG_SSE2  },
+    { "ssse3",  AV_CPU_FLAG_SSE3  | AV_CPU_FLAG_SSSE3 },
+    { "sse4",   AV_CPU_FLAG_SSE4  | AV_CPU_FLAG_SSE42 },
+    { "avx",    AV_CPU_FLAG_AVX                       },
+    { "avx2",   AV_CPU_FLAG_AVX2                      },
+};
+
+static int allocImage(uint8_t *data[4], int stride[4],
+                      enum AVPixelFormat format, int w, int h)
+{
+    int i;
+
+    av_image_fill_linesizes(stride, format, w);
+    for (i = 0; i < 4; i++) {
+        stride[i] = FFALIGN(stride[i], 16);
+        data[i]   = NULL;
+        if (stride[i]) {
+            /* some scalers may write out of bounds */
+            data[i] = av_mallocz(stride[i] * h + 16);
+            if (!data[i]) {
+                perror("Malloc");
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+static void freeImage(uint8_t *data[4])
+{
+    int i;
+
+    for (i = 0; i < 4; i++)
+        av_freep(&data[i]);
+}
+
+/* scale src runs times with the given CPU flags forced, return the time in
+ * ns per output pixel and the CRC of the visible part of the output, or -1
+ * with a CRC of 0 on failure */
+static double benchRun(uint8_t *src[4], int srcStride[4],
+                       uint8_t *dst[4], int dstStride[4],
+                       enum AVPixelFormat srcFormat, enum AVPixelFormat dstFormat,
+                       int srcW, int srcH, int dstW, int dstH, int flags,
+                       int cpu_flags, int runs, uint32_t *crc)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(dstFormat);
+    struct SwsContext *ctx;
+    int lineSize[4];
+    int64_t t;
+    int i, y;
+
+    *crc = 0;
+    av_force_cpu_flags(cpu_flags);
+    ctx = sws_getContext(srcW, srcH, srcFormat, dstW, dstH, dstFormat,
+                         flags, NULL, NULL, NULL);
+    if (!ctx)
+        return -1;
+
+    /* do not let a run inherit the output of the previous one */
+    for (i = 0; i < 4 && dstStride[i]; i++)
+        memset(dst[i], 0, dstStride[i] * dstH);
+
+    sws_scale(ctx, (const uint8_t * const*)src, srcStride, 0, srcH, dst, dstStride);
+    t = av_gettime();
+    for (i = 0; i < runs; i++)
+        sws_scale(ctx, (const uint8_t * const*)src, srcStride, 0, srcH, dst, dstStride);
+    t = av_gettime() - t;
+    sws_freeContext(ctx);
+
+    av_image_fill_linesizes(lineSize, dstFormat, dstW);
+    for (i = 0; i < 4 && dstStride[i]; i++) {
+        int h = i == 1 || i == 2 ? -((-dstH) >> desc->log2_chroma_h) : dstH;
+        for (y = 0; y < h; y++)
+            *crc = av_crc(av_crc_get_table(AV_CRC_32_IEEE), *crc,
+                          dst[i] + y * dstStride[i], lineSize[i]);
+    }
+
+    return t * 1000.0 / ((double)runs * dstW * dstH);
+}
+
+/**
+ * Time one conversion with plain C and with each supported CPU flag set and
+ * print the ns per output pixel. Outputs that differ from the C output are
+ * marked with '!'; SIMD code is only expected to match C with SWS_BITEXACT
+ * and SWS_ACCURATE_RND, which can be added with -flags.
+ * The rgb2rgb converters used by some unscaled conversions are selected once
+ * per process, so they always run with the detected CPU flags.
+ *
+ * @return 0 if all outputs match, 1 if one differs, -1 on failure
+ */
+static int benchTest(uint8_t *ref[4], int refStride[4], int w, int h,
+                     enum AVPixelFormat srcFormat, enum AVPixelFormat dstFormat,
+                     int srcW, int srcH, int dstW, int dstH, int flags, int runs)
+{
+    const AVPixFmtDescriptor *desc_src = av_pix_fmt_desc_get(srcFormat);
+    const AVPixFmtDescriptor *desc_dst = av_pix_fmt_desc_get(dstFormat);
+    int detected = av_get_cpu_flags();
+    int cpu_flags = 0, prev_flags = 0;
+    uint8_t *src[4] = { 0 }, *dst[4] = { 0 };
+    int srcStride[4], dstStride[4];
+    struct SwsContext *srcContext;
+    uint32_t crc_c, crc;
+    double ns;
+    int i, res = -1;
+
+    if (allocImage(src, srcStride, srcFormat, srcW, srcH) < 0 ||
+        allocImage(dst, dstStride, dstFormat, dstW, dstH) < 0)
+        goto end;
+
+    srcContext = sws_getContext(w, h, AV_PIX_FMT_YUVA420P, srcW, srcH,
+                                srcFormat, SWS_BILINEAR, NULL, NULL, NULL);
+    if (!srcContext) {
+        fprintf(stderr, "Failed to get yuva420p ---> %s\n", desc_src->name);
+        goto end;
+    }
+    sws_scale(srcContext, (const uint8_t * const*)ref, refStride, 0, h, src, srcStride);
+    sws_freeContext(srcContext);
+
+    printf(" %s %dx%d -> %s %4dx%4d flags=%2d",
+           desc_src->name, srcW, srcH,
+           desc_dst->name, dstW, dstH,
+           flags);
+    fflush(stdout);
+
+    ns = benchRun(src, srcStride, dst, dstStride, srcFormat, dstFormat,
+                  srcW, srcH, dstW, dstH, flags, 0, runs, &crc_c);
+    if (ns < 0) {
+        printf(" failed\n");
+        goto end;
+    }
+    printf(" c %.2f", ns);
+
+    res = 0;
+    for (i = 0; i <= FF_ARRAY_ELEMS(bench_cpu_levels); i++) {
+        const char *name;
+
+        if (i < FF_ARRAY_ELEMS(bench_cpu_levels)) {
+            cpu_flags |= bench_cpu_levels[i].flags & detected;
+            if (!(detected & bench_cpu_levels[i].flags) || cpu_flags == prev_flags)
+                continue;
+            name = bench_cpu_levels[i].name;
+        } else {
+            /* flags not covered by the levels above */
+            if (!detected || detected == prev_flags)
+                continue;
+            cpu_flags = detected;
+            name = "all";
+        }
+        prev_flags = cpu_flags;
+        ns = benchRun(src, srcStride, dst, dstStride, srcFormat, dstFormat,
+                      srcW, srcH, dstW, dstH, flags, cpu_flags, runs, &crc);
+        if (ns < 0) {
+            printf(" %s failed", name);
+            res = -1;
+            continue;
+        }
+        printf(" %s %.2f%s", name, ns, crc != crc_c ? "!" : "");
+        if (crc != crc_c && !res)
+            res = 1;
+    }
+    printf("\n");
+
+end:
+    av_force_cpu_flags(-1);
+    freeImage(src);
+    freeImage(dst);
+    return res;
+}
+
+/**
+ * @return 0 if all outputs matched the C output, 1 otherwise
+ */
+static int benchmark(uint8_t *ref[4], int refStride[4], int w, int h,
+                     enum AVPixelFormat srcFormat_in,
+                     enum AVPixelFormat dstFormat_in,
+                     int extra_flags, int runs)
+{
+    const int flags[] = { SWS_FAST_BILINEAR, SWS_BILINEAR, SWS_BICUBIC,
+                          SWS_POINT, SWS_AREA, SWS_LANCZOS, 0 };
+    /* downscale, unscaled and upscale */
+    const int srcW[] = { 1920, 1920, 1280, 0 };
+    const int srcH[] = { 1080, 1080,  720, 0 };
+    const int dstW[] = { 1280, 1920, 1920, 0 };
+    const int dstH[] = {  720, 1080, 1080, 0 };
+    enum AVPixelFormat srcFormat, dstFormat;
+    int mismatch = 0;
+
+    printf("ns per output pixel, '!' marks output differing from C\n");
+
+    for (srcFormat = srcFormat_in != AV_PIX_FMT_NONE ? srcFormat_in : 0;
+         srcFormat < AV_PIX_FMT_NB; srcFormat++) {
+        if (!sws_isSupportedInput(srcFormat))
+            continue;
+
+        for (dstFormat = dstFormat_in != AV_PIX_FMT_NONE ? dstFormat_in : 0;
+             dstFormat < AV_PIX_FMT_NB; dstFormat++) {
+            int i, k;
+
+            if (!sws_isSupportedOutput(dstFormat))
+                continue;
+
+            for (k = 0; flags[k]; k++)
+                for (i = 0; srcW[i]; i++)
+                    if (benchTest(ref, refStride, w, h, srcFormat, dstFormat,
+                                  srcW[i], srcH[i], dstW[i], dstH[i],
+                                  flags[k] | extra_flags, runs) > 0)
+                        mismatch = 1;
+            if (dstFormat_in != AV_PIX_FMT_NONE)
+                break;
+        }
+        if (srcFormat_in != AV_PIX_FMT_NONE)
+            break;
+    }
+
+    return mismatch;
+}
+
 static int fileTest(uint8_t *ref[4], int refStride[4], int w, int h, FILE *fp,
                     enum AVPixelFormat srcFormat_in,
                     enum AVPixelFormat dstFormat_in)
@@ -356,6 +582,7 @@ int main(int argc, char **argv)
     AVLFG rand;
     int res = -1;
     int i;
+    int bench_runs = 0, extra_flags = 0;
     FILE *fp = NULL;
 
     if (!rgb_data || !data)
@@ -382,6 +609,14 @@ int main(int argc, char **argv)
                 fprintf(stderr, "invalid pixel format %s\n", argv[i + 1]);
                 return -1;
             }
+        } else if (!strcmp(argv[i], "-bench")) {
+            bench_runs = strtol(argv[i + 1], NULL, 0);
+            if (bench_runs <= 0) {
+                fprintf(stderr, "invalid number of runs %s\n", argv[i + 1]);
+                return -1;
+            }
+        } else if (!strcmp(argv[i], "-flags")) {
+            extra_flags = strtol(argv[i + 1], NULL, 0);
         } else {
 bad_option:
             fprintf(stderr, "bad option or argument missing (%s)\n", argv[i]);
@@ -404,6 +639,9 @@ bad_option:
     if(fp) {
         res = fileTest(src, stride, W, H, fp, srcFormat, dstFormat);
         fclose(fp);
+    } else if (bench_runs) {
+        av_log_set_level(AV_LOG_ERROR);
+        res = benchmark(src, stride, W, H, srcFormat, dstFormat, extra_flags, bench_runs);
     } else {
         selfTest(src, stride, W, H, srcFormat, dstFormat);
         res = 0;
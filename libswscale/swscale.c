@@ -331,6 +331,195 @@ static av_always_inline void hcscale(SwsContext *c, int16_t *dst1,
     if (DEBUG_SWSCALE_BUFFERS)                  \
         av_log(c, AV_LOG_DEBUG, __VA_ARGS__)
 
+void ff_gamma_lut_c(uint16_t *dst, const uint16_t *src,
+                    const uint16_t *table, int n, int alpha)
+{
+    int i;
+
+    if (alpha) {
+        for (i = 0; i < n; i += 4) {
+            dst[i + 0] = table[src[i + 0]];
+            dst[i + 1] = table[src[i + 1]];
+            dst[i + 2] = table[src[i + 2]];
+            dst[i + 3] = src[i + 3];
+        }
+    } else {
+        for (i = 0; i < n; i++)
+            dst[i] = table[src[i]];
+    }
+}
+
+void ff_gamma_lut8to16_c(uint16_t *dst, const uint8_t *src,
+                         const uint16_t *table, int n, int alpha)
+{
+    int i;
+
+    if (alpha) {
+        for (i = 0; i < n; i += 4) {
+            dst[i + 0] = table[src[i + 0]];
+            dst[i + 1] = table[src[i + 1]];
+            dst[i + 2] = table[src[i + 2]];
+            dst[i + 3] = src[i + 3] * 257;
+        }
+    } else {
+        for (i = 0; i < n; i++)
+            dst[i] = table[src[i]];
+    }
+}
+
+void ff_gamma_lut16to8_c(uint8_t *dst, const uint16_t *src,
+                         const uint8_t *table, int n, int alpha)
+{
+    int i;
+
+    if (alpha) {
+        for (i = 0; i < n; i += 4) {
+            dst[i + 0] = table[src[i + 0]];
+            dst[i + 1] = table[src[i + 1]];
+            dst[i + 2] = table[src[i + 2]];
+            dst[i + 3] = src[i + 3] >> 8;
+        }
+    } else {
+        for (i = 0; i < n; i++)
+            dst[i] = table[src[i]];
+    }
+}
+
+/**
+ * gamma_lut() for 16 bit components of the opposite endianness.
+ */
+static void gamma_lut_bswap(uint16_t *dst, const uint16_t *src,
+                            const uint16_t *table, int n, int alpha)
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+        dst[i] = alpha && (i & 3) == 3 ? src[i] :
+                 av_bswap16(table[av_bswap16(src[i])]);
+}
+
+/**
+ * Linearize line y of the source slice into the 16 bit packed RGB format
+ * srcFormat, for SWS_GAMMA_CORRECT. Subsampled chroma is interpolated
+ * bilinearly to the luma positions, using the chroma lines of the slice.
+ */
+static void gamma_input(SwsContext *c, uint16_t *dst, const uint8_t *src[4],
+                        const int srcStride[4], int y,
+                        int srcSliceY, int srcSliceH)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(c->gammaSrcFormat);
+    const AVPixFmtDescriptor *lin  = av_pix_fmt_desc_get(c->srcFormat);
+    const uint8_t *line = src[0] + y * srcStride[0];
+    const int alpha = isALPHA(c->srcFormat);
+    const int step  = alpha ? 4 : 3;
+    const int width = c->srcW;
+    int i, j;
+
+    if (c->gammaSrcFormat == AV_PIX_FMT_NONE) {
+        if (!isBE(c->srcFormat) == !HAVE_BIGENDIAN)
+            c->gamma_lut(dst, (const uint16_t *)line, c->gamma_lin,
+                         width * step, alpha);
+        else
+            gamma_lut_bswap(dst, (const uint16_t *)line, c->gamma_lin,
+                            width * step, alpha);
+    } else if (isAnyRGB(c->gammaSrcFormat)) {
+        if (c->gammaSrcFormat == AV_PIX_FMT_RGB24 ||
+            c->gammaSrcFormat == AV_PIX_FMT_BGR24 ||
+            c->gammaSrcFormat == AV_PIX_FMT_RGBA) {
+            /* same component order as srcFormat */
+            c->gamma_lut8to16(dst, line, c->gamma_lin8, width * step, alpha);
+            return;
+        }
+        for (i = 0; i < width; i++) {
+            for (j = 0; j < 3; j++)
+                dst[(lin->comp[j].offset_plus1 - 1) >> 1] =
+                    c->gamma_lin8[line[desc->comp[j].offset_plus1 - 1]];
+            if (alpha)
+                dst[3] = line[desc->comp[3].offset_plus1 - 1] * 257;
+            line += desc->comp[0].step_minus1 + 1;
+            dst  += step;
+        }
+    } else {
+        const int sw = desc->log2_chroma_w, sh = desc->log2_chroma_h;
+        /* chroma sample positions in 1/256 luma pixels, as get_local_pos() */
+        const int hpos = c->src_h_chr_pos < 0 ? (128 << sw) - 128 : c->src_h_chr_pos;
+        const int vpos = c->src_v_chr_pos < 0 ? (128 << sh) - 128 : c->src_v_chr_pos;
+        const int chrW = FF_CEIL_RSHIFT(width, sw);
+        const int chrY = srcSliceY >> sh;
+        const int chrH = FF_CEIL_RSHIFT(srcSliceY + srcSliceH, sh) - chrY;
+        const int vy   = ((srcSliceY + y) << 8) - vpos;
+        const int cy0  = av_clip((vy >> (8 + sh))     - chrY, 0, chrH - 1);
+        const int cy1  = av_clip((vy >> (8 + sh)) + 1 - chrY, 0, chrH - 1);
+        const int fy   = (vy & ((256 << sh) - 1)) >> sh;
+        const uint8_t *lineU0 = src[1] + cy0 * srcStride[1];
+        const uint8_t *lineU1 = src[1] + cy1 * srcStride[1];
+        const uint8_t *lineV0 = src[2] + cy0 * srcStride[2];
+        const uint8_t *lineV1 = src[2] + cy1 * srcStride[2];
+        const uint8_t *lineA  = alpha ? src[3] + y * srcStride[3] : NULL;
+        const int64_t *k = c->gamma_uv2rgb;
+        uint16_t *out = dst;
+
+        for (i = 0; i < width; i++) {
+            const int hx = (i << 8) - hpos;
+            const int x0 = av_clip( hx >> (8 + sw),      0, chrW - 1);
+            const int x1 = av_clip((hx >> (8 + sw)) + 1, 0, chrW - 1);
+            const int fx = (hx & ((256 << sw) - 1)) >> sw;
+            /* chroma - 128 in 1/65536 steps */
+            const int U = ((lineU0[x0] * (256 - fx) + lineU0[x1] * fx) * (256 - fy) +
+                           (lineU1[x0] * (256 - fx) + lineU1[x1] * fx) * fy) - (128 << 16);
+            const int V = ((lineV0[x0] * (256 - fx) + lineV0[x1] * fx) * (256 - fy) +
+                           (lineV1[x0] * (256 - fx) + lineV1[x1] * fx) * fy) - (128 << 16);
+            const int Y = c->gamma_y2rgb[line[i]];
+
+            out[0] = av_clip_uint16((Y + (int)((k[0] * V + (1 << 23)) >> 24)) >> 8);
+            out[1] = av_clip_uint16((Y + (int)((k[1] * U + k[2] * V + (1 << 23)) >> 24)) >> 8);
+            out[2] = av_clip_uint16((Y + (int)((k[3] * U + (1 << 23)) >> 24)) >> 8);
+            if (alpha)
+                out[3] = lineA[i] * 257;
+            out += step;
+        }
+        c->gamma_lut(dst, dst, c->gamma_lin, width * step, alpha);
+    }
+}
+
+/**
+ * Gamma encode a linear line of the 16 bit packed RGB format dstFormat
+ * into dst, for SWS_GAMMA_CORRECT. dst and src may be the same.
+ */
+static void gamma_output(SwsContext *c, uint8_t *dst, const uint16_t *src)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(c->gammaDstFormat);
+    const AVPixFmtDescriptor *lin  = av_pix_fmt_desc_get(c->dstFormat);
+    const int alpha = isALPHA(c->dstFormat);
+    const int step  = alpha ? 4 : 3;
+    const int width = c->dstW;
+    int i, j;
+
+    if (c->gammaDstFormat == AV_PIX_FMT_NONE) {
+        if (!isBE(c->dstFormat) == !HAVE_BIGENDIAN)
+            c->gamma_lut((uint16_t *)dst, src, c->gamma_enc,
+                         width * step, alpha);
+        else
+            gamma_lut_bswap((uint16_t *)dst, src, c->gamma_enc,
+                            width * step, alpha);
+    } else if (c->gammaDstFormat == AV_PIX_FMT_RGB24 ||
+               c->gammaDstFormat == AV_PIX_FMT_BGR24 ||
+               c->gammaDstFormat == AV_PIX_FMT_RGBA) {
+        /* same component order as dstFormat */
+        c->gamma_lut16to8(dst, src, c->gamma_enc8, width * step, alpha);
+    } else {
+        for (i = 0; i < width; i++) {
+            for (j = 0; j < 3; j++)
+                dst[desc->comp[j].offset_plus1 - 1] =
+                    c->gamma_enc8[src[(lin->comp[j].offset_plus1 - 1) >> 1]];
+            if (alpha)
+                dst[desc->comp[3].offset_plus1 - 1] = src[3] >> 8;
+            dst += desc->comp[0].step_minus1 + 1;
+            src += step;
+        }
+    }
+}
+
 static int swscale(SwsContext *c, const uint8_t *src[],
                    int srcStride[], int srcSliceY,
                    int srcSliceH, uint8_t *dst[], int dstStride[])
@@ -340,6 +529,7 @@ static int swscale(SwsContext *c, const uint8_t *src[],
     const int srcW                   = c->srcW;
     const int dstW                   = c->dstW;
     const int dstH                   = c->dstH;
+    const int dstYEnd                = c->dstSliceEnd ? c->dstSliceEnd : dstH;
     const int chrDstW                = c->chrDstW;
     const int chrSrcW                = c->chrSrcW;
     const int lumXInc                = c->lumXInc;
@@ -365,6 +555,7 @@ static int swscale(SwsContext *c, const uint8_t *src[],
     const int vLumBufSize            = c->vLumBufSize;
     const int vChrBufSize            = c->vChrBufSize;
     uint8_t *formatConvBuffer        = c->formatConvBuffer;
+    uint8_t *gammaConvBuffer         = c->gammaConvBuffer;
     uint32_t *pal                    = c->pal_yuv;
     yuv2planar1_fn yuv2plane1        = c->yuv2plane1;
     yuv2planarX_fn yuv2planeX        = c->yuv2planeX;
@@ -390,7 +581,7 @@ static int swscale(SwsContext *c, const uint8_t *src[],
         pal = c->input_rgb2yuv_table;
     }
 
-    if (isPacked(c->srcFormat)) {
+    if (isPacked(userSrcFormat(c))) {
         src[0] =
         src[1] =
         src[2] =
@@ -400,8 +591,11 @@ static int swscale(SwsContext *c, const uint8_t *src[],
         srcStride[2] =
         srcStride[3] = srcStride[0];
     }
-    srcStride[1] <<= c->vChrDrop;
-    srcStride[2] <<= c->vChrDrop;
+    /* gamma_input() reads the lines of dropped chroma itself */
+    if (c->gammaSrcFormat == AV_PIX_FMT_NONE) {
+        srcStride[1] <<= c->vChrDrop;
+        srcStride[2] <<= c->vChrDrop;
+    }
 
     DEBUG_BUFFERS("swscale() %p[%d] %p[%d] %p[%d] %p[%d] -> %p[%d] %p[%d] %p[%d] %p[%d]\n",
                   src[0], srcStride[0], src[1], srcStride[1],
@@ -443,7 +637,7 @@ static int swscale(SwsContext *c, const uint8_t *src[],
     if (srcSliceY == 0) {
         lumBufIndex  = -1;
         chrBufIndex  = -1;
-        dstY         = 0;
+        dstY         = c->dstSliceStart;
         lastInLumBuf = -1;
         lastInChrBuf = -1;
     }
@@ -453,7 +647,7 @@ static int swscale(SwsContext *c, const uint8_t *src[],
     }
     lastDstY = dstY;
 
-    for (; dstY < dstH; dstY++) {
+    for (; dstY < dstYEnd; dstY++) {
         const int chrDstY = dstY >> c->chrDstVSubSample;
         uint8_t *dest[4]  = {
             dst[0] + dstStride[0] * dstY,
@@ -512,6 +706,11 @@ static int swscale(SwsContext *c, const uint8_t *src[],
             av_assert0(lumBufIndex < 2 * vLumBufSize);
             av_assert0(lastInLumBuf + 1 - srcSliceY < srcSliceH);
             av_assert0(lastInLumBuf + 1 - srcSliceY >= 0);
+            if (flags & SWS_GAMMA_CORRECT) {
+                gamma_input(c, (uint16_t *)gammaConvBuffer, src, srcStride,
+                            lastInLumBuf + 1 - srcSliceY, srcSliceY, srcSliceH);
+                src1[0] = src1[1] = src1[2] = src1[3] = gammaConvBuffer;
+            }
             hyscale(c, lumPixBuf[lumBufIndex], dstW, src1, srcW, lumXInc,
                     hLumFilter, hLumFilterPos, hLumFilterSize,
                     formatConvBuffer, pal, 0);
@@ -536,6 +735,14 @@ static int swscale(SwsContext *c, const uint8_t *src[],
             av_assert0(lastInChrBuf + 1 - chrSrcSliceY >= 0);
             // FIXME replace parameters through context struct (some at least)
 
+            if (c->needs_hcscale && (flags & SWS_GAMMA_CORRECT)) {
+                uint8_t *line = gammaConvBuffer + FFALIGN((srcW + 1) * 8, 16);
+                gamma_input(c, (uint16_t *)line, src, srcStride,
+                            (lastInChrBuf + 1 - chrSrcSliceY) << c->vChrDrop,
+                            srcSliceY, srcSliceH);
+                src1[0] = src1[1] = src1[2] = src1[3] = line;
+            }
+
             if (c->needs_hcscale)
                 hcscale(c, chrUPixBuf[chrBufIndex], chrVPixBuf[chrBufIndex],
                         chrDstW, src1, chrSrcW, chrXInc,
@@ -639,6 +846,8 @@ static int swscale(SwsContext *c, const uint8_t *src[],
                     }
                 }
             } else if (yuv2packedX) {
+                if (c->gammaDstFormat != AV_PIX_FMT_NONE)
+                    dest[0] = c->gammaOutBuffer;
                 av_assert1(lumSrcPtr  + vLumFilterSize - 1 < (const int16_t **)lumPixBuf  + vLumBufSize * 2);
                 av_assert1(chrUSrcPtr + vChrFilterSize - 1 < (const int16_t **)chrUPixBuf + vChrBufSize * 2);
                 if (c->yuv2packed1 && vLumFilterSize == 1 &&
@@ -665,6 +874,9 @@ static int swscale(SwsContext *c, const uint8_t *src[],
                                 chrUSrcPtr, chrVSrcPtr, vChrFilterSize,
                                 alpSrcPtr, dest[0], dstW, dstY);
                 }
+                if (flags & SWS_GAMMA_CORRECT)
+                    gamma_output(c, dst[0] + dstStride[0] * dstY,
+                                 (const uint16_t *)dest[0]);
             } else {
                 av_assert1(!yuv2packed1 && !yuv2packed2);
                 yuv2anyX(c, vLumFilter + dstY * vLumFilterSize,
@@ -753,6 +965,10 @@ static av_cold void sws_init_swscale(SwsContext *c)
     if (!(isGray(srcFormat) || isGray(c->dstFormat) ||
           srcFormat == AV_PIX_FMT_MONOBLACK || srcFormat == AV_PIX_FMT_MONOWHITE))
         c->needs_hcscale = 1;
+
+    c->gamma_lut      = ff_gamma_lut_c;
+    c->gamma_lut8to16 = ff_gamma_lut8to16_c;
+    c->gamma_lut16to8 = ff_gamma_lut16to8_c;
 }
 
 SwsFunc ff_getSwsFunc(SwsContext *c)
@@ -932,11 +1148,11 @@ int attribute_align_arg sws_scale(struct SwsContext *c,
     if (srcSliceH == 0)
         return 0;
 
-    if (!check_image_pointers(srcSlice, c->srcFormat, srcStride)) {
+    if (!check_image_pointers(srcSlice, userSrcFormat(c), srcStride)) {
         av_log(c, AV_LOG_ERROR, "bad src image pointers\n");
         return 0;
     }
-    if (!check_image_pointers((const uint8_t* const*)dst, c->dstFormat, dstStride)) {
+    if (!check_image_pointers((const uint8_t* const*)dst, userDstFormat(c), dstStride)) {
         av_log(c, AV_LOG_ERROR, "bad dst image pointers\n");
         return 0;
     }
@@ -1065,41 +1281,53 @@ int attribute_align_arg sws_scale(struct SwsContext *c,
         int dstStride2[4] = { dstStride[0], dstStride[1], dstStride[2],
                               dstStride[3] };
 
-        reset_ptr(src2, c->srcFormat);
-        reset_ptr((void*)dst2, c->dstFormat);
+        reset_ptr(src2, userSrcFormat(c));
+        reset_ptr((void*)dst2, userDstFormat(c));
 
         /* reset slice direction at end of frame */
         if (srcSliceY + srcSliceH == c->srcH)
             c->sliceDir = 0;
 
-        ret = c->swscale(c, src2, srcStride2, srcSliceY, srcSliceH, dst2,
-                          dstStride2);
+        if (HAVE_THREADS && c->nb_slice_ctx &&
+            srcSliceY == 0 && srcSliceH == c->srcH)
+            ret = ff_sws_scale_threaded(c, src2, srcStride2, srcSliceY,
+                                        srcSliceH, dst2, dstStride2);
+        else
+            ret = c->swscale(c, src2, srcStride2, srcSliceY, srcSliceH, dst2,
+                              dstStride2);
     } else {
         // slices go from bottom to top => we flip the image internally
         int srcStride2[4] = { -srcStride[0], -srcStride[1], -srcStride[2],
                               -srcStride[3] };
         int dstStride2[4] = { -dstStride[0], -dstStride[1], -dstStride[2],
                               -dstStride[3] };
+        int chrSrcVSubSample = c->gammaSrcFormat == AV_PIX_FMT_NONE ? c->chrSrcVSubSample :
+                               av_pix_fmt_desc_get(c->gammaSrcFormat)->log2_chroma_h;
 
         src2[0] += (srcSliceH - 1) * srcStride[0];
         if (!usePal(c->srcFormat))
-            src2[1] += ((srcSliceH >> c->chrSrcVSubSample) - 1) * srcStride[1];
-        src2[2] += ((srcSliceH >> c->chrSrcVSubSample) - 1) * srcStride[2];
+            src2[1] += ((srcSliceH >> chrSrcVSubSample) - 1) * srcStride[1];
+        src2[2] += ((srcSliceH >> chrSrcVSubSample) - 1) * srcStride[2];
         src2[3] += (srcSliceH - 1) * srcStride[3];
         dst2[0] += ( c->dstH                         - 1) * dstStride[0];
         dst2[1] += ((c->dstH >> c->chrDstVSubSample) - 1) * dstStride[1];
         dst2[2] += ((c->dstH >> c->chrDstVSubSample) - 1) * dstStride[2];
         dst2[3] += ( c->dstH                         - 1) * dstStride[3];
 
-        reset_ptr(src2, c->srcFormat);
-        reset_ptr((void*)dst2, c->dstFormat);
+        reset_ptr(src2, userSrcFormat(c));
+        reset_ptr((void*)dst2, userDstFormat(c));
 
         /* reset slice direction at end of frame */
         if (!srcSliceY)
             c->sliceDir = 0;
 
-        ret = c->swscale(c, src2, srcStride2, c->srcH-srcSliceY-srcSliceH,
-                          srcSliceH, dst2, dstStride2);
+        if (HAVE_THREADS && c->nb_slice_ctx &&
+            srcSliceY == 0 && srcSliceH == c->srcH)
+            ret = ff_sws_scale_threaded(c, src2, srcStride2, 0,
+                                        srcSliceH, dst2, dstStride2);
+        else
+            ret = c->swscale(c, src2, srcStride2, c->srcH-srcSliceY-srcSliceH,
+                              srcSliceH, dst2, dstStride2);
     }
 
 
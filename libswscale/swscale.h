@@ -80,6 +80,8 @@ const char *swscale_license(void);
 #define SWS_DIRECT_BGR        0x8000
 #define SWS_ACCURATE_RND      0x40000
 #define SWS_BITEXACT          0x80000
+//scale in linear light, from 8/16 bit packed RGB or 8 bit planar YUV to 8/16 bit packed RGB
+#define SWS_GAMMA_CORRECT    0x100000
 #define SWS_ERROR_DIFFUSION  0x800000
 
 #if FF_API_SWS_CPU_CAPS
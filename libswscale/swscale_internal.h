@@ -275,6 +275,7 @@ typedef struct SwsContext {
      * sws_scale() wrapper so they can be freely modified here.
      */
     SwsFunc swscale;
+    SwsFunc swscale_generic;      ///< Generic scaler, used by fused converters for slices they cannot handle.
     int srcW;                     ///< Width  of source      luma/alpha planes.
     int srcH;                     ///< Height of source      luma/alpha planes.
     int dstH;                     ///< Height of destination luma/alpha planes.
@@ -352,6 +353,17 @@ typedef struct SwsContext {
     int vChrFilterSize;           ///< Vertical   filter size for chroma     pixels.
     //@}
 
+    /**
+     * Refcounted plans owning the filter arrays above (and the runtime-generated
+     * MMXEXT code below), shared with all contexts using the same filters.
+     */
+    //@{
+    struct SwsFilterPlan *hLumPlan;
+    struct SwsFilterPlan *hChrPlan;
+    struct SwsFilterPlan *vLumPlan;
+    struct SwsFilterPlan *vChrPlan;
+    //@}
+
     int lumMmxextFilterCodeSize;  ///< Runtime-generated MMXEXT horizontal fast bilinear scaler code size for luma/alpha planes.
     int chrMmxextFilterCodeSize;  ///< Runtime-generated MMXEXT horizontal fast bilinear scaler code size for chroma planes.
     uint8_t *lumMmxextFilterCode; ///< Runtime-generated MMXEXT horizontal fast bilinear scaler code for luma/alpha planes.
@@ -360,6 +372,8 @@ typedef struct SwsContext {
     int canMMXEXTBeUsed;
 
     int dstY;                     ///< Last destination vertical line output from last slice.
+    int dstSliceStart;            ///< Destination line swscale() restarts from when srcSliceY is 0.
+    int dstSliceEnd;              ///< If nonzero, swscale() stops before this destination line.
     int flags;                    ///< Flags passed by the user to select scaler algorithm, optimizations, subsampling, etc...
     void *yuvTable;             // pointer to the yuv->rgb table start so it can be freed()
     // alignment ensures the offset can be added in a single
@@ -499,6 +513,37 @@ typedef struct SwsContext {
     int16_t xyz2rgb_matrix[3][4];
     int16_t rgb2xyz_matrix[3][4];
 
+    /**
+     * @name SWS_GAMMA_CORRECT state.
+     * Sources and destinations other than 16 bit packed RGB are replaced by
+     * the 16 bit packed RGB format in srcFormat/dstFormat. Their lines are
+     * linearized into it when read by the horizontal scaler, and gamma
+     * encoded from it when written by the vertical scaler.
+     */
+    //@{
+    uint16_t *gamma_lin;          ///< RGB_GAMMA decoding table, indexed by 16 bit component
+    uint16_t *gamma_enc;          ///< RGB_GAMMA encoding table, inverse of gamma_lin
+    uint16_t *gamma_lin8;         ///< RGB_GAMMA decoding table, indexed by 8 bit component
+    uint8_t *gamma_enc8;          ///< RGB_GAMMA encoding table with 8 bit output
+    int gamma_y2rgb[256];         ///< Y term of 8 bit YUV to 16 bit RGB, scaled by 256
+    int64_t gamma_uv2rgb[4];      ///< V->R, U->G, V->G and U->B factors for chroma in 1/65536 steps, scaled by 1 << 24
+    enum AVPixelFormat gammaSrcFormat; ///< replaced source format, AV_PIX_FMT_NONE if none
+    enum AVPixelFormat gammaDstFormat; ///< replaced destination format, AV_PIX_FMT_NONE if none
+    uint8_t *gammaConvBuffer;     ///< linearized luma and chroma input lines
+    uint8_t *gammaOutBuffer;      ///< linear output line when gammaDstFormat is set
+
+    /**
+     * Map n components through a gamma table. If alpha is set, every
+     * fourth component is alpha and is only converted to the output depth.
+     */
+    void (*gamma_lut)(uint16_t *dst, const uint16_t *src,
+                      const uint16_t *table, int n, int alpha);
+    void (*gamma_lut8to16)(uint16_t *dst, const uint8_t *src,
+                           const uint16_t *table, int n, int alpha);
+    void (*gamma_lut16to8)(uint8_t *dst, const uint16_t *src,
+                           const uint8_t *table, int n, int alpha);
+    //@}
+
     /* function pointers for swscale() */
     yuv2planar1_fn yuv2plane1;
     yuv2planarX_fn yuv2planeX;
@@ -605,6 +650,19 @@ typedef struct SwsContext {
     int needs_hcscale; ///< Set if there are chroma planes to be converted.
 
     SwsDither dither;
+
+    /**
+     * @name Slice threading.
+     * With more than one thread, full-frame sws_scale() calls are split into
+     * horizontal bands of destination lines, each scaled by its own
+     * context in slice_ctx[] on the worker pool in thread.
+     */
+    //@{
+    int nb_threads;               ///< Number of threads requested by the user, 0 for auto.
+    int nb_slice_ctx;             ///< Number of contexts in slice_ctx.
+    struct SwsContext **slice_ctx;
+    struct SwsThreadContext *thread;
+    //@}
 } SwsContext;
 //FIXME check init (where 0)
 
@@ -618,6 +676,22 @@ void ff_yuv2rgb_init_tables_ppc(SwsContext *c, const int inv_table[4],
 void updateMMXDitherTables(SwsContext *c, int dstY, int lumBufIndex, int chrBufIndex,
                            int lastInLumBuf, int lastInChrBuf);
 
+/**
+ * Set up the slice contexts and the worker pool for c->nb_threads threads.
+ * Does nothing if threading is disabled or not applicable to c.
+ */
+int ff_sws_thread_init(SwsContext *c, struct SwsFilter *srcFilter,
+                       struct SwsFilter *dstFilter);
+void ff_sws_thread_free(SwsContext *c);
+
+/**
+ * Scale a whole frame using the slice contexts. Takes the same arguments
+ * as SwsContext.swscale.
+ */
+int ff_sws_scale_threaded(SwsContext *c, const uint8_t *src[], int srcStride[],
+                          int srcSliceY, int srcSliceH,
+                          uint8_t *dst[], int dstStride[]);
+
 SwsFunc ff_yuv2rgb_init_x86(SwsContext *c);
 SwsFunc ff_yuv2rgb_init_vis(SwsContext *c);
 SwsFunc ff_yuv2rgb_init_ppc(SwsContext *c);
@@ -647,6 +721,24 @@ static av_always_inline int is9_OR_10BPS(enum AVPixelFormat pix_fmt)
 
 #define isNBPS(x) is9_OR_10BPS(x)
 
+/**
+ * Return the source format of the pictures passed to sws_scale(), which
+ * differs from srcFormat if SWS_GAMMA_CORRECT replaced it.
+ */
+static av_always_inline enum AVPixelFormat userSrcFormat(const SwsContext *c)
+{
+    return c->gammaSrcFormat != AV_PIX_FMT_NONE ? c->gammaSrcFormat : c->srcFormat;
+}
+
+/**
+ * Return the destination format of the pictures passed to sws_scale(),
+ * which differs from dstFormat if SWS_GAMMA_CORRECT replaced it.
+ */
+static av_always_inline enum AVPixelFormat userDstFormat(const SwsContext *c)
+{
+    return c->gammaDstFormat != AV_PIX_FMT_NONE ? c->gammaDstFormat : c->dstFormat;
+}
+
 static av_always_inline int isBE(enum AVPixelFormat pix_fmt)
 {
     const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(pix_fmt);
@@ -837,6 +929,14 @@ void ff_get_unscaled_swscale_bfin(SwsContext *c);
 void ff_get_unscaled_swscale_ppc(SwsContext *c);
 void ff_get_unscaled_swscale_arm(SwsContext *c);
 
+/**
+ * Set c->swscale to a converter which scales and converts the pixel format
+ * in a single pass without intermediate line buffers, if one exists for the
+ * specific formats, dimensions and flags. c->swscale must already be set to
+ * the generic scaler.
+ */
+void ff_get_fused_swscale(SwsContext *c);
+
 /**
  * Return function pointer to fastest main scaler path function depending
  * on architecture and available optimizations.
@@ -855,6 +955,13 @@ void ff_sws_init_output_funcs(SwsContext *c,
 void ff_sws_init_swscale_ppc(SwsContext *c);
 void ff_sws_init_swscale_x86(SwsContext *c);
 
+void ff_gamma_lut_c(uint16_t *dst, const uint16_t *src,
+                    const uint16_t *table, int n, int alpha);
+void ff_gamma_lut8to16_c(uint16_t *dst, const uint8_t *src,
+                         const uint16_t *table, int n, int alpha);
+void ff_gamma_lut16to8_c(uint8_t *dst, const uint16_t *src,
+                         const uint8_t *table, int n, int alpha);
+
 static inline void fillPlane16(uint8_t *plane, int stride, int width, int height, int y,
                                int alpha, int bits, const int big_endian)
 {
@@ -307,6 +307,38 @@ static int uyvyToYuv422Wrapper(SwsContext *c, const uint8_t *src[],
     return srcSliceH;
 }
 
+static int packed422ToYuv422p10Wrapper(SwsContext *c, const uint8_t *src[],
+                                       int srcStride[], int srcSliceY,
+                                       int srcSliceH, uint8_t *dstParam[],
+                                       int dstStride[])
+{
+    const int be   = isBE(c->dstFormat);
+    const int lpos = c->srcFormat == AV_PIX_FMT_UYVY422;
+    const int cpos = !lpos;
+    const uint8_t *s = src[0];
+    uint8_t *ydst = dstParam[0] + dstStride[0] * srcSliceY;
+    uint8_t *udst = dstParam[1] + dstStride[1] * srcSliceY;
+    uint8_t *vdst = dstParam[2] + dstStride[2] * srcSliceY;
+    int x, y;
+
+#define STORE10(p, v) do { if (be) AV_WB16(p, (v) << 2); else AV_WL16(p, (v) << 2); } while (0)
+    for (y = 0; y < srcSliceH; y++) {
+        for (x = 0; x < c->srcW; x++)
+            STORE10(ydst + 2 * x, s[2 * x + lpos]);
+        for (x = 0; x < (c->srcW + 1) >> 1; x++) {
+            STORE10(udst + 2 * x, s[4 * x + cpos]);
+            STORE10(vdst + 2 * x, s[4 * x + cpos + 2]);
+        }
+        s    += srcStride[0];
+        ydst += dstStride[0];
+        udst += dstStride[1];
+        vdst += dstStride[2];
+    }
+#undef STORE10
+
+    return srcSliceH;
+}
+
 static void gray8aToPacked32(const uint8_t *src, uint8_t *dst, int num_pixels,
                              const uint8_t *palette)
 {
@@ -1557,6 +1589,9 @@ void ff_get_unscaled_swscale(SwsContext *c)
         c->swscale = yuyvToYuv422Wrapper;
     if (srcFormat == AV_PIX_FMT_UYVY422 && dstFormat == AV_PIX_FMT_YUV422P)
         c->swscale = uyvyToYuv422Wrapper;
+    if ((srcFormat == AV_PIX_FMT_YUYV422 || srcFormat == AV_PIX_FMT_UYVY422) &&
+        (dstFormat == AV_PIX_FMT_YUV422P10LE || dstFormat == AV_PIX_FMT_YUV422P10BE))
+        c->swscale = packed422ToYuv422p10Wrapper;
 
 #define isPlanarGray(x) (isGray(x) && (x) != AV_PIX_FMT_GRAY8A)
     /* simple copy */
@@ -1611,3 +1646,164 @@ void sws_convertPalette8ToPacked24(const uint8_t *src, uint8_t *dst,
         dst += 3;
     }
 }
+
+/* Sum of the 2x2 block of 8-bit samples at s[0], s[step] and the line below. */
+#define BOX2X2(s, stride, step) \
+    ((s)[0] + (s)[step] + (s)[stride] + (s)[(stride) + (step)])
+
+static void downscale2_plane(const uint8_t *src, int srcStride, int step,
+                             uint8_t *dst, int dstStride, int w, int h)
+{
+    int x, y;
+
+    for (y = 0; y < h; y++) {
+        for (x = 0; x < w; x++)
+            dst[x] = (BOX2X2(src + 2 * step * x, srcStride, step) + 2) >> 2;
+        src += 2 * srcStride;
+        dst += dstStride;
+    }
+}
+
+/* Same as what the generic scaler does with its 2-tap filters and the 8x8
+ * ordered dither used for high bit depth to 8-bit output. */
+static void downscale2_plane10(const uint8_t *src, int srcStride, int be,
+                               uint8_t *dst, int dstStride, int w, int h,
+                               int dither_offset)
+{
+    int x, y;
+
+    for (y = 0; y < h; y++) {
+        const uint8_t *dither = ff_dither_8x8_128[y & 7];
+        const uint8_t *s0 = src, *s1 = src + srcStride;
+
+        for (x = 0; x < w; x++) {
+            int sum = be ? AV_RB16(s0 + 4 * x) + AV_RB16(s0 + 4 * x + 2) +
+                           AV_RB16(s1 + 4 * x) + AV_RB16(s1 + 4 * x + 2)
+                         : AV_RL16(s0 + 4 * x) + AV_RL16(s0 + 4 * x + 2) +
+                           AV_RL16(s1 + 4 * x) + AV_RL16(s1 + 4 * x + 2);
+            dst[x] = av_clip_uint8((8 * sum + dither[(x + dither_offset) & 7]) >> 7);
+        }
+        src += 2 * srcStride;
+        dst += dstStride;
+    }
+}
+
+/**
+ * 2:1 area downscale of 4:2:0 input to yuv420p, directly from the source
+ * planes. Other than full frames go through the generic scaler, which keeps
+ * its state between slices.
+ */
+static int downscale2ToYuv420pWrapper(SwsContext *c, const uint8_t *src[],
+                                      int srcStride[], int srcSliceY,
+                                      int srcSliceH, uint8_t *dst[],
+                                      int dstStride[])
+{
+    const enum AVPixelFormat srcFormat = c->srcFormat;
+
+    if (srcSliceY || srcSliceH != c->srcH)
+        return c->swscale_generic(c, src, srcStride, srcSliceY, srcSliceH,
+                                  dst, dstStride);
+
+    switch (srcFormat) {
+    case AV_PIX_FMT_NV12:
+    case AV_PIX_FMT_NV21: {
+        const int u = srcFormat == AV_PIX_FMT_NV21;
+        downscale2_plane(src[0], srcStride[0], 1, dst[0], dstStride[0],
+                         c->dstW, c->dstH);
+        downscale2_plane(src[1] + u, srcStride[1], 2, dst[1], dstStride[1],
+                         c->chrDstW, c->chrDstH);
+        downscale2_plane(src[1] + !u, srcStride[1], 2, dst[2], dstStride[2],
+                         c->chrDstW, c->chrDstH);
+        break;
+    }
+    case AV_PIX_FMT_YUV420P:
+        downscale2_plane(src[0], srcStride[0], 1, dst[0], dstStride[0],
+                         c->dstW, c->dstH);
+        downscale2_plane(src[1], srcStride[1], 1, dst[1], dstStride[1],
+                         c->chrDstW, c->chrDstH);
+        downscale2_plane(src[2], srcStride[2], 1, dst[2], dstStride[2],
+                         c->chrDstW, c->chrDstH);
+        break;
+    default: {
+        const int be = isBE(srcFormat);
+        downscale2_plane10(src[0], srcStride[0], be, dst[0], dstStride[0],
+                           c->dstW, c->dstH, 0);
+        downscale2_plane10(src[1], srcStride[1], be, dst[1], dstStride[1],
+                           c->chrDstW, c->chrDstH, 0);
+        downscale2_plane10(src[2], srcStride[2], be, dst[2], dstStride[2],
+                           c->chrDstW, c->chrDstH, 3);
+        break;
+    }
+    }
+
+    return c->dstH;
+}
+
+/**
+ * 2:1 area downscale of packed 4:2:2 input to yuv422p10, directly from the
+ * source. The sum of each 2x2 block of 8-bit samples is the 10-bit output
+ * of the generic scaler, which rounds it down exactly.
+ */
+static int downscale2Packed422ToYuv422p10Wrapper(SwsContext *c, const uint8_t *src[],
+                                                 int srcStride[], int srcSliceY,
+                                                 int srcSliceH, uint8_t *dst[],
+                                                 int dstStride[])
+{
+    const int be   = isBE(c->dstFormat);
+    const int lpos = c->srcFormat == AV_PIX_FMT_UYVY422;
+    const int cpos = !lpos;
+    const uint8_t *s0 = src[0];
+    uint8_t *ydst = dst[0], *udst = dst[1], *vdst = dst[2];
+    int x, y;
+
+    if (srcSliceY || srcSliceH != c->srcH)
+        return c->swscale_generic(c, src, srcStride, srcSliceY, srcSliceH,
+                                  dst, dstStride);
+
+#define STORE10(p, v) do { if (be) AV_WB16(p, v); else AV_WL16(p, v); } while (0)
+    for (y = 0; y < c->dstH; y++) {
+        for (x = 0; x < c->dstW; x++)
+            STORE10(ydst + 2 * x, BOX2X2(s0 + 4 * x + lpos, srcStride[0], 2));
+        for (x = 0; x < c->chrDstW; x++) {
+            STORE10(udst + 2 * x, BOX2X2(s0 + 8 * x + cpos,     srcStride[0], 4));
+            STORE10(vdst + 2 * x, BOX2X2(s0 + 8 * x + cpos + 2, srcStride[0], 4));
+        }
+        s0   += 2 * srcStride[0];
+        ydst += dstStride[0];
+        udst += dstStride[1];
+        vdst += dstStride[2];
+    }
+#undef STORE10
+
+    return c->dstH;
+}
+
+void ff_get_fused_swscale(SwsContext *c)
+{
+    const enum AVPixelFormat srcFormat = c->srcFormat;
+    const int scaler = c->flags & (SWS_FAST_BILINEAR | SWS_BILINEAR | SWS_BICUBIC |
+                                   SWS_X | SWS_POINT | SWS_AREA | SWS_BICUBLIN |
+                                   SWS_GAUSS | SWS_SINC | SWS_LANCZOS | SWS_SPLINE);
+    const int default_chr_pos = c->src_h_chr_pos == -1 && c->src_v_chr_pos == -1 &&
+                                c->dst_h_chr_pos == -1 && c->dst_v_chr_pos == -1;
+
+    /* exact 2:1 area downscale, the box filter matches the generic scaler */
+    if ((srcFormat == AV_PIX_FMT_NV12        || srcFormat == AV_PIX_FMT_NV21 ||
+         srcFormat == AV_PIX_FMT_YUV420P     ||
+         srcFormat == AV_PIX_FMT_YUV420P10LE || srcFormat == AV_PIX_FMT_YUV420P10BE) &&
+        c->dstFormat == AV_PIX_FMT_YUV420P && scaler == SWS_AREA && default_chr_pos &&
+        c->srcRange == c->dstRange &&
+        c->srcW == 2 * c->dstW && c->srcH == 2 * c->dstH &&
+        !(c->dstW & 1) && !(c->dstH & 1)) {
+        c->swscale_generic = c->swscale;
+        c->swscale         = downscale2ToYuv420pWrapper;
+    }
+
+    if ((srcFormat == AV_PIX_FMT_YUYV422     || srcFormat == AV_PIX_FMT_UYVY422) &&
+        (c->dstFormat == AV_PIX_FMT_YUV422P10LE || c->dstFormat == AV_PIX_FMT_YUV422P10BE) &&
+        scaler == SWS_AREA && default_chr_pos && c->srcRange == c->dstRange &&
+        c->srcW == 2 * c->dstW && c->srcH == 2 * c->dstH && !(c->dstW & 1)) {
+        c->swscale_generic = c->swscale;
+        c->swscale         = downscale2Packed422ToYuv422p10Wrapper;
+    }
+}
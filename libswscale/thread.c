@@ -0,0 +1,376 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * libswscale slice multithreading support
+ *
+ * The destination picture is split into horizontal bands. Every band is
+ * scaled by a private SwsContext that is fed exactly the source lines its
+ * vertical filter taps need, so the output is identical to the one of a
+ * single-threaded run.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/cpu.h"
+#include "libavutil/imgutils.h"
+#include "libavutil/mem.h"
+
+#include "swscale.h"
+#include "swscale_internal.h"
+
+#if HAVE_PTHREADS
+#include <pthread.h>
+#elif HAVE_OS2THREADS
+#include "compat/os2threads.h"
+#elif HAVE_W32THREADS
+#include "compat/w32pthreads.h"
+#endif
+
+/* do not bother splitting pictures into bands smaller than this */
+#define MIN_BAND_HEIGHT 16
+
+/* The SIMD output functions write whole registers, i.e. up to this many
+ * pixels past the end of a line. With a single thread that only clobbers
+ * padding or lines that are rewritten later; with bands it must not reach
+ * into the first line of the next band, which another thread may already
+ * have written. */
+#define MAX_LINE_OVERWRITE 32
+
+typedef struct SwsThreadContext {
+    SwsContext *parent;
+    int min_stride[4];
+
+    int nb_threads;
+    pthread_t *workers;
+
+    /* per-execute parameters */
+    const uint8_t *src[4];
+    int srcStride[4];
+    uint8_t *dst[4];
+    int dstStride[4];
+    int nb_jobs;
+
+    pthread_cond_t last_job_cond;
+    pthread_cond_t current_job_cond;
+    pthread_mutex_t current_job_lock;
+    int current_job;
+    unsigned int current_execute;
+    int done;
+} SwsThreadContext;
+
+static void band_range(const SwsContext *c, int band, int nb_bands,
+                       int *start, int *end)
+{
+    int mask = (1 << c->chrDstVSubSample) - 1;
+
+    *start = (int)((int64_t)c->dstH *  band      / nb_bands) & ~mask;
+    *end   = band == nb_bands - 1 ? c->dstH :
+             (int)((int64_t)c->dstH * (band + 1) / nb_bands) & ~mask;
+}
+
+static void scale_band(SwsThreadContext *t, int band)
+{
+    SwsContext *c = t->parent;
+    SwsContext *s = c->slice_ctx[band];
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(userSrcFormat(c));
+    /* SWS_GAMMA_CORRECT reads the chroma planes of the user source itself */
+    const int chrSrcMask = (1 << FFMAX(c->chrSrcVSubSample, desc->log2_chroma_h)) - 1;
+    const int chrDstMask = (1 << c->chrDstVSubSample) - 1;
+    const uint8_t *src[4];
+    uint8_t *dst[4];
+    int srcStride[4], dstStride[4];
+    int dstY0, dstY1, lastY, srcY0, srcY1, chrY0, chrY1, i;
+
+    band_range(c, band, t->nb_jobs, &dstY0, &dstY1);
+    if (dstY0 >= dstY1)
+        return;
+    lastY = dstY1 - 1;
+
+    /* First and last source lines the vertical filters of this band read,
+     * mirroring the line selection done in swscale(). */
+    srcY0 = FFMAX(0, c->vLumFilterPos[dstY0]);
+    chrY0 = FFMAX(0, c->vChrFilterPos[dstY0 >> c->chrDstVSubSample]);
+    srcY0 = FFMIN(srcY0, chrY0 << c->chrSrcVSubSample) & ~chrSrcMask;
+
+    srcY1 = FFMIN(c->srcH, c->vLumFilterPos[FFMIN(lastY | chrDstMask, c->dstH - 1)] +
+                           c->vLumFilterSize);
+    chrY1 = FFMIN(c->chrSrcH, c->vChrFilterPos[lastY >> c->chrDstVSubSample] +
+                              c->vChrFilterSize);
+    srcY1 = FFMIN(c->srcH, FFMAX(srcY1, chrY1 << c->chrSrcVSubSample));
+    if (srcY1 & chrSrcMask)
+        srcY1 = FFMIN(c->srcH, (srcY1 | chrSrcMask) + 1);
+    /* gamma_input() interpolates between the chroma lines around each
+     * line, hand it the ones bordering the band as well */
+    if (c->gammaSrcFormat != AV_PIX_FMT_NONE && isYUV(c->gammaSrcFormat)) {
+        srcY0 = FFMAX(0,       srcY0 - (1 << desc->log2_chroma_h));
+        srcY1 = FFMIN(c->srcH, srcY1 + (1 << desc->log2_chroma_h));
+    }
+
+    for (i = 0; i < 4; i++) {
+        int y = i == 0 || i == 3         ? srcY0 :
+                isPacked(userSrcFormat(c)) ? 0 :
+                c->gammaSrcFormat != AV_PIX_FMT_NONE ? srcY0 >> desc->log2_chroma_h :
+                srcY0 >> c->chrSrcVSubSample << c->vChrDrop;
+        src[i]       = t->src[i] ? t->src[i] + y * t->srcStride[i] : NULL;
+        srcStride[i] = t->srcStride[i];
+        dst[i]       = t->dst[i];
+        dstStride[i] = t->dstStride[i];
+    }
+    if (usePal(c->srcFormat))
+        memcpy(s->pal_yuv, c->pal_yuv, sizeof(c->pal_yuv));
+
+    s->dstY          = dstY0;
+    s->dstSliceStart = dstY0;
+    s->dstSliceEnd   = dstY1;
+    s->lumBufIndex   = -1;
+    s->chrBufIndex   = -1;
+    s->lastInLumBuf  = srcY0 - 1;
+    s->lastInChrBuf  = (srcY0 >> c->chrSrcVSubSample) - 1;
+
+    s->swscale(s, src, srcStride, srcY0, srcY1 - srcY0, dst, dstStride);
+}
+
+static void* attribute_align_arg worker(void *v)
+{
+    SwsThreadContext *t = v;
+    int our_job         = t->nb_jobs;
+    int nb_threads      = t->nb_threads;
+    unsigned int last_execute = 0;
+    int self_id;
+
+    pthread_mutex_lock(&t->current_job_lock);
+    self_id = t->current_job++;
+    for (;;) {
+        while (our_job >= t->nb_jobs) {
+            if (t->current_job == nb_threads + t->nb_jobs)
+                pthread_cond_signal(&t->last_job_cond);
+
+            while (last_execute == t->current_execute && !t->done)
+                pthread_cond_wait(&t->current_job_cond, &t->current_job_lock);
+            last_execute = t->current_execute;
+            our_job = self_id;
+
+            if (t->done) {
+                pthread_mutex_unlock(&t->current_job_lock);
+                return NULL;
+            }
+        }
+        pthread_mutex_unlock(&t->current_job_lock);
+
+        scale_band(t, our_job);
+
+        pthread_mutex_lock(&t->current_job_lock);
+        our_job = t->current_job++;
+    }
+}
+
+static void park_workers(SwsThreadContext *t)
+{
+    while (t->current_job != t->nb_threads + t->nb_jobs)
+        pthread_cond_wait(&t->last_job_cond, &t->current_job_lock);
+    pthread_mutex_unlock(&t->current_job_lock);
+}
+
+static void thread_uninit(SwsThreadContext *t)
+{
+    int i;
+
+    pthread_mutex_lock(&t->current_job_lock);
+    t->done = 1;
+    pthread_cond_broadcast(&t->current_job_cond);
+    pthread_mutex_unlock(&t->current_job_lock);
+
+    for (i = 0; i < t->nb_threads; i++)
+        pthread_join(t->workers[i], NULL);
+
+    pthread_mutex_destroy(&t->current_job_lock);
+    pthread_cond_destroy(&t->current_job_cond);
+    pthread_cond_destroy(&t->last_job_cond);
+    av_freep(&t->workers);
+}
+
+static int thread_init(SwsThreadContext *t, int nb_threads)
+{
+    int i, ret;
+
+    t->workers = av_mallocz(sizeof(*t->workers) * nb_threads);
+    if (!t->workers)
+        return AVERROR(ENOMEM);
+
+    t->nb_threads  = nb_threads;
+    t->current_job = 0;
+    t->nb_jobs     = 0;
+    t->done        = 0;
+
+    pthread_cond_init(&t->current_job_cond, NULL);
+    pthread_cond_init(&t->last_job_cond,    NULL);
+
+    pthread_mutex_init(&t->current_job_lock, NULL);
+    pthread_mutex_lock(&t->current_job_lock);
+    for (i = 0; i < nb_threads; i++) {
+        ret = pthread_create(&t->workers[i], NULL, worker, t);
+        if (ret) {
+            pthread_mutex_unlock(&t->current_job_lock);
+            t->nb_threads = i;
+            thread_uninit(t);
+            return AVERROR(ret);
+        }
+    }
+
+    park_workers(t);
+
+    return 0;
+}
+
+static SwsContext *alloc_slice_context(SwsContext *c, SwsFilter *srcFilter,
+                                       SwsFilter *dstFilter)
+{
+    SwsContext *s = sws_alloc_context();
+
+    if (!s)
+        return NULL;
+
+    s->flags         = c->flags;
+    s->srcW          = c->srcW;
+    s->srcH          = c->srcH;
+    s->dstW          = c->dstW;
+    s->dstH          = c->dstH;
+    s->srcFormat     = userSrcFormat(c);
+    s->dstFormat     = userDstFormat(c);
+    s->srcRange      = c->srcRange;
+    s->dstRange      = c->dstRange;
+    s->src0Alpha     = c->src0Alpha;
+    s->dst0Alpha     = c->dst0Alpha;
+    s->param[0]      = c->param[0];
+    s->param[1]      = c->param[1];
+    s->src_h_chr_pos = c->src_h_chr_pos;
+    s->src_v_chr_pos = c->src_v_chr_pos;
+    s->dst_h_chr_pos = c->dst_h_chr_pos;
+    s->dst_v_chr_pos = c->dst_v_chr_pos;
+    s->dither        = c->dither;
+    s->nb_threads    = 1;
+
+    if (sws_init_context(s, srcFilter, dstFilter) < 0 ||
+        s->swscale != c->swscale) {
+        sws_freeContext(s);
+        return NULL;
+    }
+    sws_setColorspaceDetails(s, c->srcColorspaceTable, c->srcRange,
+                             c->dstColorspaceTable, c->dstRange,
+                             c->brightness, c->contrast, c->saturation);
+
+    return s;
+}
+
+int ff_sws_thread_init(SwsContext *c, SwsFilter *srcFilter, SwsFilter *dstFilter)
+{
+    int nb_threads = c->nb_threads;
+    int i, ret;
+
+#if HAVE_W32THREADS
+    w32thread_init();
+#endif
+
+    if (!nb_threads)
+        nb_threads = av_cpu_count();
+    nb_threads = FFMIN(nb_threads, c->dstH / MIN_BAND_HEIGHT);
+
+    /* error diffusion carries state from one line to the next */
+    if (nb_threads <= 1 || c->dither == SWS_DITHER_ED)
+        return 0;
+
+    c->slice_ctx = av_mallocz(nb_threads * sizeof(*c->slice_ctx));
+    if (!c->slice_ctx)
+        return AVERROR(ENOMEM);
+    for (i = 0; i < nb_threads; i++) {
+        c->slice_ctx[i] = alloc_slice_context(c, srcFilter, dstFilter);
+        if (!c->slice_ctx[i]) {
+            ret = AVERROR(ENOMEM);
+            goto fail;
+        }
+        c->nb_slice_ctx++;
+    }
+
+    c->thread = av_mallocz(sizeof(*c->thread));
+    if (!c->thread) {
+        ret = AVERROR(ENOMEM);
+        goto fail;
+    }
+    c->thread->parent = c;
+    av_image_fill_linesizes(c->thread->min_stride, userDstFormat(c),
+                            FFALIGN(c->dstW, MAX_LINE_OVERWRITE << c->chrDstHSubSample));
+    if ((ret = thread_init(c->thread, nb_threads)) < 0) {
+        av_freep(&c->thread);
+        goto fail;
+    }
+
+    return 0;
+fail:
+    ff_sws_thread_free(c);
+    return ret;
+}
+
+void ff_sws_thread_free(SwsContext *c)
+{
+    int i;
+
+    if (c->thread)
+        thread_uninit(c->thread);
+    av_freep(&c->thread);
+
+    for (i = 0; i < c->nb_slice_ctx; i++)
+        sws_freeContext(c->slice_ctx[i]);
+    av_freep(&c->slice_ctx);
+    c->nb_slice_ctx = 0;
+}
+
+int ff_sws_scale_threaded(SwsContext *c, const uint8_t *src[], int srcStride[],
+                          int srcSliceY, int srcSliceH,
+                          uint8_t *dst[], int dstStride[])
+{
+    SwsThreadContext *t = c->thread;
+    int i;
+
+    av_assert1(srcSliceY == 0 && srcSliceH == c->srcH);
+
+    for (i = 0; i < 4; i++)
+        if (dst[i] && FFABS(dstStride[i]) < t->min_stride[i])
+            return c->swscale(c, src, srcStride, srcSliceY, srcSliceH,
+                              dst, dstStride);
+
+    pthread_mutex_lock(&t->current_job_lock);
+
+    memcpy(t->src,       src,       sizeof(t->src));
+    memcpy(t->srcStride, srcStride, sizeof(t->srcStride));
+    memcpy(t->dst,       dst,       sizeof(t->dst));
+    memcpy(t->dstStride, dstStride, sizeof(t->dstStride));
+    t->current_job = t->nb_threads;
+    t->nb_jobs     = c->nb_slice_ctx;
+    t->current_execute++;
+
+    pthread_cond_broadcast(&t->current_job_cond);
+
+    park_workers(t);
+
+    return c->dstH;
+}
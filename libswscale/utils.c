@@ -36,6 +36,9 @@
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
 #endif
+#if HAVE_PTHREADS
+#include <pthread.h>
+#endif
 
 #include "libavutil/attributes.h"
 #include "libavutil/avassert.h"
@@ -298,8 +301,8 @@ static av_cold int initFilter(int16_t **outFilter, int32_t **filterPos,
 
     emms_c(); // FIXME should not be required but IS (even for non-MMX versions)
 
-    // NOTE: the +3 is for the MMX(+1) / SSE(+3) scaler which reads over the end
-    FF_ALLOC_OR_GOTO(NULL, *filterPos, (dstW + 3) * sizeof(**filterPos), fail);
+    // NOTE: the +7 is for the MMX(+1) / SSE(+3) / AVX2(+7) scaler which reads over the end
+    FF_ALLOC_OR_GOTO(NULL, *filterPos, (dstW + 7) * sizeof(**filterPos), fail);
 
     if (FFABS(xInc - 0x10000) < 10 && srcPos == dstPos) { // unscaled
         int i;
@@ -617,10 +620,10 @@ static av_cold int initFilter(int16_t **outFilter, int32_t **filterPos,
         }
     }
 
-    // Note the +1 is for the MMX scaler which reads over the end
+    // Note the +7 is for the MMX/SSE/AVX2 scaler which reads over the end
     /* align at 16 for AltiVec (needed by hScale_altivec_real) */
     FF_ALLOCZ_OR_GOTO(NULL, *outFilter,
-                      *outFilterSize * (dstW + 3) * sizeof(int16_t), fail);
+                      *outFilterSize * (dstW + 7) * sizeof(int16_t), fail);
 
     /* normalize & store in outFilter */
     for (i = 0; i < dstW; i++) {
@@ -644,15 +647,13 @@ static av_cold int initFilter(int16_t **outFilter, int32_t **filterPos,
         }
     }
 
-    (*filterPos)[dstW + 0] =
-    (*filterPos)[dstW + 1] =
-    (*filterPos)[dstW + 2] = (*filterPos)[dstW - 1]; /* the MMX/SSE scaler will
-                                                      * read over the end */
+    /* the MMX/SSE/AVX2 scaler will read over the end */
+    for (i = 0; i < 7; i++)
+        (*filterPos)[dstW + i] = (*filterPos)[dstW - 1];
     for (i = 0; i < *outFilterSize; i++) {
-        int k = (dstW - 1) * (*outFilterSize) + i;
-        (*outFilter)[k + 1 * (*outFilterSize)] =
-        (*outFilter)[k + 2 * (*outFilterSize)] =
-        (*outFilter)[k + 3 * (*outFilterSize)] = (*outFilter)[k];
+        int j, k = (dstW - 1) * (*outFilterSize) + i;
+        for (j = 1; j <= 7; j++)
+            (*outFilter)[k + j * (*outFilterSize)] = (*outFilter)[k];
     }
 
     ret = 0;
@@ -831,6 +832,285 @@ static av_cold int init_hscaler_mmxext(int dstW, int xInc, uint8_t *filterCode,
 }
 #endif /* HAVE_MMXEXT_INLINE */
 
+#define USE_MMAP (HAVE_MMAP && HAVE_MPROTECT && defined MAP_ANONYMOUS)
+
+/* Maximum number of filter plans kept around once no context uses them. */
+#define MAX_CACHED_PLANS 64
+
+typedef struct SwsFilterPlanKey {
+    int mmxext;     ///< 1 for the runtime-generated MMXEXT fast bilinear scaler
+    int xInc, srcW, dstW;
+    int filterAlign, one;
+    int flags, cpu_flags;
+    double param[2];
+    int srcPos, dstPos;
+} SwsFilterPlanKey;
+
+/**
+ * Immutable one-dimensional scaler filter, shared by all contexts which
+ * need the same filter.
+ */
+typedef struct SwsFilterPlan {
+    SwsFilterPlanKey key;
+    int16_t *filter;
+    int32_t *filterPos;
+    int filterSize;
+    uint8_t *code;  ///< runtime-generated MMXEXT scaler code, if any
+    int codeSize;
+
+    int refcount;
+    int cached;     ///< set if the plan is linked into the plan cache
+    struct SwsFilterPlan *next;
+} SwsFilterPlan;
+
+#if HAVE_PTHREADS
+static pthread_mutex_t plan_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static SwsFilterPlan *plan_cache;
+static int nb_cached_plans;
+#endif
+
+static void free_plan(SwsFilterPlan *p)
+{
+    av_free(p->filter);
+    av_free(p->filterPos);
+    if (p->code) {
+#if USE_MMAP
+        munmap(p->code, p->codeSize);
+#elif HAVE_VIRTUALALLOC
+        VirtualFree(p->code, 0, MEM_RELEASE);
+#else
+        av_free(p->code);
+#endif
+    }
+    av_free(p);
+}
+
+#if HAVE_PTHREADS
+/**
+ * Look up a plan in the cache and return a new reference to it,
+ * or NULL if there is none. Must be called with plan_cache_lock held.
+ */
+static SwsFilterPlan *plan_find(const SwsFilterPlanKey *key)
+{
+    SwsFilterPlan *p, **pp;
+
+    for (pp = &plan_cache; *pp; pp = &(*pp)->next) {
+        if (!memcmp(&(*pp)->key, key, sizeof(*key))) {
+            /* move to the front, so the list stays in LRU order */
+            p          = *pp;
+            *pp        = p->next;
+            p->next    = plan_cache;
+            plan_cache = p;
+            p->refcount++;
+            return p;
+        }
+    }
+    return NULL;
+}
+#endif
+
+/**
+ * Look up a plan in the cache and return a new reference to it,
+ * or NULL if there is none.
+ */
+static SwsFilterPlan *plan_ref(const SwsFilterPlanKey *key)
+{
+    SwsFilterPlan *p = NULL;
+#if HAVE_PTHREADS
+    pthread_mutex_lock(&plan_cache_lock);
+    p = plan_find(key);
+    pthread_mutex_unlock(&plan_cache_lock);
+#endif
+    return p;
+}
+
+/**
+ * Insert a freshly built plan into the cache and return a reference to it.
+ * If another thread added an identical plan meanwhile, p is freed and the
+ * existing plan is returned instead. The lookup and the insertion happen
+ * under a single lock hold, so a plan is never cached twice.
+ */
+static SwsFilterPlan *plan_add(SwsFilterPlan *p)
+{
+#if HAVE_PTHREADS
+    SwsFilterPlan *old, **pp, **unused = NULL, *evicted = NULL;
+
+    pthread_mutex_lock(&plan_cache_lock);
+    if ((old = plan_find(&p->key))) {
+        pthread_mutex_unlock(&plan_cache_lock);
+        free_plan(p);
+        return old;
+    }
+
+    p->refcount = 1;
+    p->cached   = 1;
+    p->next     = plan_cache;
+    plan_cache  = p;
+    if (++nb_cached_plans > MAX_CACHED_PLANS) {
+        /* evict the least recently used plan no context refers to */
+        for (pp = &plan_cache; *pp; pp = &(*pp)->next)
+            if (!(*pp)->refcount)
+                unused = pp;
+        if (unused) {
+            evicted = *unused;
+            *unused = evicted->next;
+            nb_cached_plans--;
+        }
+    }
+    pthread_mutex_unlock(&plan_cache_lock);
+
+    if (evicted)
+        free_plan(evicted);
+#else
+    p->refcount = 1;
+#endif
+    return p;
+}
+
+static void plan_unref(SwsFilterPlan **pp)
+{
+    SwsFilterPlan *p = *pp;
+
+    if (!p)
+        return;
+    *pp = NULL;
+#if HAVE_PTHREADS
+    if (p->cached) {
+        /* unreferenced plans stay cached for the next context */
+        pthread_mutex_lock(&plan_cache_lock);
+        p->refcount--;
+        pthread_mutex_unlock(&plan_cache_lock);
+        return;
+    }
+#endif
+    if (!--p->refcount)
+        free_plan(p);
+}
+
+static av_cold int get_filter_plan(SwsFilterPlan **plan, int16_t **outFilter,
+                                   int32_t **filterPos, int *outFilterSize,
+                                   int xInc, int srcW, int dstW,
+                                   int filterAlign, int one, int flags,
+                                   int cpu_flags, SwsVector *srcFilter,
+                                   SwsVector *dstFilter, double param[2],
+                                   int srcPos, int dstPos)
+{
+    /* user-supplied filter vectors are not part of the key */
+    int cacheable = !srcFilter && !dstFilter;
+    SwsFilterPlanKey key;
+    SwsFilterPlan *p = NULL;
+
+    memset(&key, 0, sizeof(key));
+    key.xInc        = xInc;
+    key.srcW        = srcW;
+    key.dstW        = dstW;
+    key.filterAlign = filterAlign;
+    key.one         = one;
+    key.flags       = flags;
+    key.cpu_flags   = cpu_flags;
+    key.param[0]    = param[0];
+    key.param[1]    = param[1];
+    key.srcPos      = srcPos;
+    key.dstPos      = dstPos;
+
+    if (cacheable)
+        p = plan_ref(&key);
+    if (!p) {
+        if (!(p = av_mallocz(sizeof(*p))))
+            return AVERROR(ENOMEM);
+        p->key = key;
+        if (initFilter(&p->filter, &p->filterPos, &p->filterSize, xInc,
+                       srcW, dstW, filterAlign, one, flags, cpu_flags,
+                       srcFilter, dstFilter, param, srcPos, dstPos) < 0) {
+            free_plan(p);
+            return -1;
+        }
+        if (cacheable) {
+            p = plan_add(p);
+        } else {
+            p->refcount = 1;
+        }
+    }
+
+    *plan          = p;
+    *outFilter     = p->filter;
+    *filterPos     = p->filterPos;
+    *outFilterSize = p->filterSize;
+    return 0;
+}
+
+#if HAVE_MMXEXT_INLINE
+static av_cold int init_mmxext_plan(SwsContext *c, SwsFilterPlan *p,
+                                    int dstW, int xInc, int numSplits)
+{
+    p->codeSize = init_hscaler_mmxext(dstW, xInc, NULL, NULL, NULL, numSplits);
+
+#if USE_MMAP
+    p->code = mmap(NULL, p->codeSize, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p->code == MAP_FAILED)
+        p->code = NULL;
+#elif HAVE_VIRTUALALLOC
+    p->code = VirtualAlloc(NULL, p->codeSize, MEM_COMMIT,
+                           PAGE_EXECUTE_READWRITE);
+#else
+    p->code = av_malloc(p->codeSize);
+#endif
+    if (!p->code) {
+        av_log(c, AV_LOG_ERROR, "Failed to allocate MMX2FilterCode\n");
+        return AVERROR(ENOMEM);
+    }
+
+    FF_ALLOCZ_OR_GOTO(c, p->filter,    (dstW     / numSplits + 8) * sizeof(int16_t), fail);
+    FF_ALLOCZ_OR_GOTO(c, p->filterPos, (dstW / 2 / numSplits + 8) * sizeof(int32_t), fail);
+
+    init_hscaler_mmxext(dstW, xInc, p->code, p->filter,
+                        (uint32_t*)p->filterPos, numSplits);
+
+#if USE_MMAP
+    if (mprotect(p->code, p->codeSize, PROT_EXEC | PROT_READ) == -1) {
+        av_log(c, AV_LOG_ERROR, "mprotect failed, cannot use fast bilinear scaler\n");
+        goto fail;
+    }
+#endif
+    return 0;
+fail:
+    return AVERROR(ENOMEM);
+}
+
+/**
+ * Get the runtime-generated MMXEXT fast bilinear scaler for the given
+ * geometry, generating it if it is not cached yet.
+ */
+static av_cold int get_mmxext_plan(SwsContext *c, SwsFilterPlan **plan,
+                                   int dstW, int xInc, int numSplits)
+{
+    SwsFilterPlanKey key;
+    SwsFilterPlan *p;
+    int ret;
+
+    memset(&key, 0, sizeof(key));
+    key.mmxext = 1;
+    key.xInc   = xInc;
+    key.dstW   = dstW;
+    key.one    = numSplits;
+
+    if (!(p = plan_ref(&key))) {
+        if (!(p = av_mallocz(sizeof(*p))))
+            return AVERROR(ENOMEM);
+        p->key = key;
+        if ((ret = init_mmxext_plan(c, p, dstW, xInc, numSplits)) < 0) {
+            free_plan(p);
+            return ret;
+        }
+        p = plan_add(p);
+    }
+
+    *plan = p;
+    return 0;
+}
+#endif /* HAVE_MMXEXT_INLINE */
+
 static void fill_rgb2yuv_table(SwsContext *c, const int table[4], int dstRange)
 {
     int64_t W, V, Z, Cy, Cu, Cv;
@@ -961,22 +1241,131 @@ static void fill_xyztables(struct SwsContext *c)
     }
 }
 
+/**
+ * Return the 16 bit packed RGB format SWS_GAMMA_CORRECT scales format in,
+ * or AV_PIX_FMT_NONE if format is not supported. YUV is supported as input
+ * only, as the YUV output writers cannot be fed by a linear RGB line.
+ */
+static enum AVPixelFormat gamma_format(enum AVPixelFormat format, int input)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(format);
+    const int alpha = desc->flags & AV_PIX_FMT_FLAG_ALPHA;
+
+    if (isPackedRGB(format) && is16BPS(format))
+        return format;
+    if (desc->comp[0].depth_minus1 != 7 || desc->nb_components < 3)
+        return AV_PIX_FMT_NONE;
+
+    if (isPackedRGB(format) && !(desc->flags & AV_PIX_FMT_FLAG_PAL)) {
+        if (desc->comp[0].step_minus1 == 2)
+            return format == AV_PIX_FMT_BGR24 ? AV_PIX_FMT_BGR48 : AV_PIX_FMT_RGB48;
+        if (desc->comp[0].step_minus1 == 3)
+            return alpha ? AV_PIX_FMT_RGBA64 : AV_PIX_FMT_RGB48;
+    } else if (input && isYUV(format) && isPlanar(format) &&
+               desc->comp[1].plane != desc->comp[2].plane) {
+        return alpha ? AV_PIX_FMT_RGBA64 : AV_PIX_FMT_RGB48;
+    }
+    return AV_PIX_FMT_NONE;
+}
+
+static int fill_gammatables(struct SwsContext *c)
+{
+    int i;
+
+    if (c->gammaSrcFormat == AV_PIX_FMT_NONE || !isAnyRGB(c->gammaSrcFormat)) {
+        /* one extra entry as the AVX2 gathers load 32 bits */
+        c->gamma_lin = av_malloc((65536 + 1) * sizeof(*c->gamma_lin));
+        if (!c->gamma_lin)
+            return AVERROR(ENOMEM);
+        for (i = 0; i < 65536; i++)
+            c->gamma_lin[i] = lrint(pow(i / 65535.0, RGB_GAMMA) * 65535.0);
+        c->gamma_lin[65536] = 0;
+    } else {
+        c->gamma_lin8 = av_malloc((256 + 1) * sizeof(*c->gamma_lin8));
+        if (!c->gamma_lin8)
+            return AVERROR(ENOMEM);
+        for (i = 0; i < 256; i++)
+            c->gamma_lin8[i] = lrint(pow(i / 255.0, RGB_GAMMA) * 65535.0);
+        c->gamma_lin8[256] = 0;
+    }
+
+    if (c->gammaDstFormat == AV_PIX_FMT_NONE) {
+        c->gamma_enc = av_malloc((65536 + 1) * sizeof(*c->gamma_enc));
+        if (!c->gamma_enc)
+            return AVERROR(ENOMEM);
+        for (i = 0; i < 65536; i++)
+            c->gamma_enc[i] = lrint(pow(i / 65535.0, 1.0 / RGB_GAMMA) * 65535.0);
+        c->gamma_enc[65536] = 0;
+    } else {
+        c->gamma_enc8 = av_mallocz(65536 + 3);
+        if (!c->gamma_enc8)
+            return AVERROR(ENOMEM);
+        for (i = 0; i < 65536; i++)
+            c->gamma_enc8[i] = lrint(pow(i / 65535.0, 1.0 / RGB_GAMMA) * 255.0);
+    }
+    return 0;
+}
+
+/**
+ * Fill the tables gamma_input() converts 8 bit YUV to 16 bit RGB with,
+ * following ff_yuv2rgb_c_init_tables(). The chroma terms are linear factors
+ * as gamma_input() interpolates chroma to luma positions first.
+ */
+static void fill_gamma_yuv2rgb(SwsContext *c, const int inv_table[4],
+                               int fullRange, int brightness,
+                               int contrast, int saturation)
+{
+    const double scale = 257 * 256;
+    double coef[5] = { 1 << 16, inv_table[0], -inv_table[2],
+                       -inv_table[3], inv_table[1] };
+    double oy = 0;
+    int i, j;
+
+    if (!fullRange) {
+        coef[0] = coef[0] * 255 / 219;
+        oy      = 16 << 16;
+    } else {
+        for (j = 1; j < 5; j++)
+            coef[j] = coef[j] * 224 / 255;
+    }
+    coef[0] *= contrast / 65536.0;
+    for (j = 1; j < 5; j++)
+        coef[j] *= contrast * (double)saturation / (65536.0 * 65536.0);
+    oy -= 256.0 * brightness;
+
+    for (i = 0; i < 256; i++)
+        c->gamma_y2rgb[i] = lrint(coef[0] * (i * 65536.0 - oy) /
+                                  (65536.0 * 65536.0) * scale) + 128;
+    for (j = 1; j < 5; j++)
+        c->gamma_uv2rgb[j - 1] = llrint(coef[j] / 65536.0 * scale * 256);
+}
+
 int sws_setColorspaceDetails(struct SwsContext *c, const int inv_table[4],
                              int srcRange, const int table[4], int dstRange,
                              int brightness, int contrast, int saturation)
 {
     const AVPixFmtDescriptor *desc_dst;
     const AVPixFmtDescriptor *desc_src;
+    enum AVPixelFormat srcFormat, dstFormat;
+    int i;
+
+    for (i = 0; i < c->nb_slice_ctx; i++)
+        sws_setColorspaceDetails(c->slice_ctx[i], inv_table, srcRange,
+                                 table, dstRange,
+                                 brightness, contrast, saturation);
+
     memmove(c->srcColorspaceTable, inv_table, sizeof(int) * 4);
     memmove(c->dstColorspaceTable, table, sizeof(int) * 4);
 
     handle_formats(c);
     desc_dst = av_pix_fmt_desc_get(c->dstFormat);
     desc_src = av_pix_fmt_desc_get(c->srcFormat);
+    srcFormat = userSrcFormat(c);
+    dstFormat = userDstFormat(c);
 
-    if(!isYUV(c->dstFormat) && !isGray(c->dstFormat))
+    if(!isYUV(dstFormat) && !isGray(dstFormat))
         dstRange = 0;
-    if(!isYUV(c->srcFormat) && !isGray(c->srcFormat))
+    if(!isYUV(srcFormat) && !isGray(srcFormat))
         srcRange = 0;
 
     c->brightness = brightness;
@@ -991,7 +1380,15 @@ int sws_setColorspaceDetails(struct SwsContext *c, const int inv_table[4],
     c->dstFormatBpp = av_get_bits_per_pixel(desc_dst);
     c->srcFormatBpp = av_get_bits_per_pixel(desc_src);
 
-    if (!isYUV(c->dstFormat) && !isGray(c->dstFormat)) {
+    if (c->gammaSrcFormat != AV_PIX_FMT_NONE && isYUV(c->gammaSrcFormat)) {
+        /* gamma_input() converts YUV to RGB before linearizing it, so the
+         * internal YUV is made from linear RGB with table and is converted
+         * back with table too. That round trip is not exact, but keeps 16
+         * bit precision and full resolution chroma. */
+        fill_gamma_yuv2rgb(c, inv_table, srcRange, brightness,
+                           contrast, saturation);
+        ff_yuv2rgb_c_init_tables(c, table, 0, 0, 1 << 16, 1 << 16);
+    } else if (!isYUV(c->dstFormat) && !isGray(c->dstFormat)) {
         ff_yuv2rgb_c_init_tables(c, inv_table, srcRange, brightness,
                                  contrast, saturation);
         // FIXME factorize
@@ -1086,6 +1483,8 @@ SwsContext *sws_alloc_context(void)
     if (c) {
         c->av_class = &sws_context_class;
         av_opt_set_defaults(c);
+        c->gammaSrcFormat = AV_PIX_FMT_NONE;
+        c->gammaDstFormat = AV_PIX_FMT_NONE;
     }
 
     return c;
@@ -1148,6 +1547,32 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
     }
     }
 
+    if (flags & SWS_GAMMA_CORRECT) {
+        enum AVPixelFormat gammaSrc = gamma_format(srcFormat, 1);
+        enum AVPixelFormat gammaDst = gamma_format(dstFormat, 0);
+
+        if (gammaSrc == AV_PIX_FMT_NONE || gammaDst == AV_PIX_FMT_NONE) {
+            av_log(c, AV_LOG_WARNING,
+                   "gamma correct scaling from %s to %s is not supported, ignoring\n",
+                   av_get_pix_fmt_name(srcFormat), av_get_pix_fmt_name(dstFormat));
+            c->flags = flags &= ~SWS_GAMMA_CORRECT;
+        } else {
+            if (gammaSrc != srcFormat) {
+                c->gammaSrcFormat = srcFormat;
+                c->srcFormat      = srcFormat = gammaSrc;
+            }
+            if (gammaDst != dstFormat) {
+                c->gammaDstFormat = dstFormat;
+                c->dstFormat      = dstFormat = gammaDst;
+            }
+            desc_src = av_pix_fmt_desc_get(srcFormat);
+            desc_dst = av_pix_fmt_desc_get(dstFormat);
+            sws_setColorspaceDetails(c, c->srcColorspaceTable, c->srcRange,
+                                     c->dstColorspaceTable, c->dstRange,
+                                     c->brightness, c->contrast, c->saturation);
+        }
+    }
+
     i = flags & (SWS_POINT         |
                  SWS_AREA          |
                  SWS_BILINEAR      |
@@ -1206,6 +1631,13 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
     av_pix_fmt_get_chroma_sub_sample(srcFormat, &c->chrSrcHSubSample, &c->chrSrcVSubSample);
     av_pix_fmt_get_chroma_sub_sample(dstFormat, &c->chrDstHSubSample, &c->chrDstVSubSample);
 
+    /* the linear light line is RGB, keep its chroma at full resolution */
+    if (flags & SWS_GAMMA_CORRECT && !(flags & SWS_FULL_CHR_H_INT)) {
+        av_log(c, AV_LOG_DEBUG, "Forcing full internal H chroma due to gamma correct scaling\n");
+        flags |= SWS_FULL_CHR_H_INT;
+        c->flags = flags;
+    }
+
     if (isAnyRGB(dstFormat) && !(flags&SWS_FULL_CHR_H_INT)) {
         if (dstW&1) {
             av_log(c, AV_LOG_DEBUG, "Forcing full internal H chroma due to odd output size\n");
@@ -1274,6 +1706,12 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
         dstFormat != AV_PIX_FMT_ABGR  &&
         dstFormat != AV_PIX_FMT_RGB24 &&
         dstFormat != AV_PIX_FMT_BGR24 &&
+        dstFormat != AV_PIX_FMT_RGB48LE  &&
+        dstFormat != AV_PIX_FMT_RGB48BE  &&
+        dstFormat != AV_PIX_FMT_BGR48LE  &&
+        dstFormat != AV_PIX_FMT_BGR48BE  &&
+        dstFormat != AV_PIX_FMT_RGBA64LE &&
+        dstFormat != AV_PIX_FMT_RGBA64BE &&
         dstFormat != AV_PIX_FMT_BGR4_BYTE &&
         dstFormat != AV_PIX_FMT_RGB4_BYTE &&
         dstFormat != AV_PIX_FMT_BGR8 &&
@@ -1316,8 +1754,18 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
 
     FF_ALLOC_OR_GOTO(c, c->formatConvBuffer, FFALIGN(srcW*2+78, 16) * 2, fail);
 
+    if (flags & SWS_GAMMA_CORRECT) {
+        /* one extra pixel as the chroma input of odd widths reads it */
+        FF_ALLOCZ_OR_GOTO(c, c->gammaConvBuffer, FFALIGN((srcW + 1) * 8, 16) * 2, fail);
+        if (c->gammaDstFormat != AV_PIX_FMT_NONE)
+            FF_ALLOCZ_OR_GOTO(c, c->gammaOutBuffer, FFALIGN((dstW + 1) * 8, 16), fail);
+        if (fill_gammatables(c) < 0)
+            goto fail;
+    }
+
     /* unscaled special cases */
     if (unscaled && !usesHFilter && !usesVFilter &&
+        !(flags & SWS_GAMMA_CORRECT) &&
         (c->srcRange == c->dstRange || isAnyRGB(dstFormat))) {
         ff_get_unscaled_swscale(c);
 
@@ -1379,91 +1827,46 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
         }
     }
 
-#define USE_MMAP (HAVE_MMAP && HAVE_MPROTECT && defined MAP_ANONYMOUS)
-
     /* precalculate horizontal scaler filter coefficients */
     {
 #if HAVE_MMXEXT_INLINE
 // can't downscale !!!
         if (c->canMMXEXTBeUsed && (flags & SWS_FAST_BILINEAR)) {
-            c->lumMmxextFilterCodeSize = init_hscaler_mmxext(dstW, c->lumXInc, NULL,
-                                                             NULL, NULL, 8);
-            c->chrMmxextFilterCodeSize = init_hscaler_mmxext(c->chrDstW, c->chrXInc,
-                                                             NULL, NULL, NULL, 4);
-
-#if USE_MMAP
-            c->lumMmxextFilterCode = mmap(NULL, c->lumMmxextFilterCodeSize,
-                                          PROT_READ | PROT_WRITE,
-                                          MAP_PRIVATE | MAP_ANONYMOUS,
-                                          -1, 0);
-            c->chrMmxextFilterCode = mmap(NULL, c->chrMmxextFilterCodeSize,
-                                          PROT_READ | PROT_WRITE,
-                                          MAP_PRIVATE | MAP_ANONYMOUS,
-                                          -1, 0);
-#elif HAVE_VIRTUALALLOC
-            c->lumMmxextFilterCode = VirtualAlloc(NULL,
-                                                  c->lumMmxextFilterCodeSize,
-                                                  MEM_COMMIT,
-                                                  PAGE_EXECUTE_READWRITE);
-            c->chrMmxextFilterCode = VirtualAlloc(NULL,
-                                                  c->chrMmxextFilterCodeSize,
-                                                  MEM_COMMIT,
-                                                  PAGE_EXECUTE_READWRITE);
-#else
-            c->lumMmxextFilterCode = av_malloc(c->lumMmxextFilterCodeSize);
-            c->chrMmxextFilterCode = av_malloc(c->chrMmxextFilterCodeSize);
-#endif
-
-#ifdef MAP_ANONYMOUS
-            if (c->lumMmxextFilterCode == MAP_FAILED || c->chrMmxextFilterCode == MAP_FAILED)
-#else
-            if (!c->lumMmxextFilterCode || !c->chrMmxextFilterCode)
-#endif
-            {
-                av_log(c, AV_LOG_ERROR, "Failed to allocate MMX2FilterCode\n");
-                return AVERROR(ENOMEM);
-            }
-
-            FF_ALLOCZ_OR_GOTO(c, c->hLumFilter,    (dstW           / 8 + 8) * sizeof(int16_t), fail);
-            FF_ALLOCZ_OR_GOTO(c, c->hChrFilter,    (c->chrDstW     / 4 + 8) * sizeof(int16_t), fail);
-            FF_ALLOCZ_OR_GOTO(c, c->hLumFilterPos, (dstW       / 2 / 8 + 8) * sizeof(int32_t), fail);
-            FF_ALLOCZ_OR_GOTO(c, c->hChrFilterPos, (c->chrDstW / 2 / 4 + 8) * sizeof(int32_t), fail);
-
-            init_hscaler_mmxext(      dstW, c->lumXInc, c->lumMmxextFilterCode,
-                                c->hLumFilter, (uint32_t*)c->hLumFilterPos, 8);
-            init_hscaler_mmxext(c->chrDstW, c->chrXInc, c->chrMmxextFilterCode,
-                                c->hChrFilter, (uint32_t*)c->hChrFilterPos, 4);
-
-#if USE_MMAP
-            if (   mprotect(c->lumMmxextFilterCode, c->lumMmxextFilterCodeSize, PROT_EXEC | PROT_READ) == -1
-                || mprotect(c->chrMmxextFilterCode, c->chrMmxextFilterCodeSize, PROT_EXEC | PROT_READ) == -1) {
-                av_log(c, AV_LOG_ERROR, "mprotect failed, cannot use fast bilinear scaler\n");
+            if (get_mmxext_plan(c, &c->hLumPlan,       dstW, c->lumXInc, 8) < 0 ||
+                get_mmxext_plan(c, &c->hChrPlan, c->chrDstW, c->chrXInc, 4) < 0)
                 goto fail;
-            }
-#endif
+
+            c->lumMmxextFilterCode     = c->hLumPlan->code;
+            c->lumMmxextFilterCodeSize = c->hLumPlan->codeSize;
+            c->hLumFilter              = c->hLumPlan->filter;
+            c->hLumFilterPos           = c->hLumPlan->filterPos;
+            c->chrMmxextFilterCode     = c->hChrPlan->code;
+            c->chrMmxextFilterCodeSize = c->hChrPlan->codeSize;
+            c->hChrFilter              = c->hChrPlan->filter;
+            c->hChrFilterPos           = c->hChrPlan->filterPos;
         } else
 #endif /* HAVE_MMXEXT_INLINE */
         {
             const int filterAlign = X86_MMX(cpu_flags)     ? 4 :
                                     PPC_ALTIVEC(cpu_flags) ? 8 : 1;
 
-            if (initFilter(&c->hLumFilter, &c->hLumFilterPos,
-                           &c->hLumFilterSize, c->lumXInc,
-                           srcW, dstW, filterAlign, 1 << 14,
-                           (flags & SWS_BICUBLIN) ? (flags | SWS_BICUBIC) : flags,
-                           cpu_flags, srcFilter->lumH, dstFilter->lumH,
-                           c->param,
-                           get_local_pos(c, 0, 0, 0),
-                           get_local_pos(c, 0, 0, 0)) < 0)
+            if (get_filter_plan(&c->hLumPlan, &c->hLumFilter, &c->hLumFilterPos,
+                                &c->hLumFilterSize, c->lumXInc,
+                                srcW, dstW, filterAlign, 1 << 14,
+                                (flags & SWS_BICUBLIN) ? (flags | SWS_BICUBIC) : flags,
+                                cpu_flags, srcFilter->lumH, dstFilter->lumH,
+                                c->param,
+                                get_local_pos(c, 0, 0, 0),
+                                get_local_pos(c, 0, 0, 0)) < 0)
                 goto fail;
-            if (initFilter(&c->hChrFilter, &c->hChrFilterPos,
-                           &c->hChrFilterSize, c->chrXInc,
-                           c->chrSrcW, c->chrDstW, filterAlign, 1 << 14,
-                           (flags & SWS_BICUBLIN) ? (flags | SWS_BILINEAR) : flags,
-                           cpu_flags, srcFilter->chrH, dstFilter->chrH,
-                           c->param,
-                           get_local_pos(c, c->chrSrcHSubSample, c->src_h_chr_pos, 0),
-                           get_local_pos(c, c->chrDstHSubSample, c->dst_h_chr_pos, 0)) < 0)
+            if (get_filter_plan(&c->hChrPlan, &c->hChrFilter, &c->hChrFilterPos,
+                                &c->hChrFilterSize, c->chrXInc,
+                                c->chrSrcW, c->chrDstW, filterAlign, 1 << 14,
+                                (flags & SWS_BICUBLIN) ? (flags | SWS_BILINEAR) : flags,
+                                cpu_flags, srcFilter->chrH, dstFilter->chrH,
+                                c->param,
+                                get_local_pos(c, c->chrSrcHSubSample, c->src_h_chr_pos, 0),
+                                get_local_pos(c, c->chrDstHSubSample, c->dst_h_chr_pos, 0)) < 0)
                 goto fail;
         }
     } // initialize horizontal stuff
@@ -1473,22 +1876,23 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
         const int filterAlign = X86_MMX(cpu_flags)     ? 2 :
                                 PPC_ALTIVEC(cpu_flags) ? 8 : 1;
 
-        if (initFilter(&c->vLumFilter, &c->vLumFilterPos, &c->vLumFilterSize,
-                       c->lumYInc, srcH, dstH, filterAlign, (1 << 12),
-                       (flags & SWS_BICUBLIN) ? (flags | SWS_BICUBIC) : flags,
-                       cpu_flags, srcFilter->lumV, dstFilter->lumV,
-                       c->param,
-                       get_local_pos(c, 0, 0, 1),
-                       get_local_pos(c, 0, 0, 1)) < 0)
+        if (get_filter_plan(&c->vLumPlan, &c->vLumFilter, &c->vLumFilterPos,
+                            &c->vLumFilterSize, c->lumYInc, srcH, dstH,
+                            filterAlign, (1 << 12),
+                            (flags & SWS_BICUBLIN) ? (flags | SWS_BICUBIC) : flags,
+                            cpu_flags, srcFilter->lumV, dstFilter->lumV,
+                            c->param,
+                            get_local_pos(c, 0, 0, 1),
+                            get_local_pos(c, 0, 0, 1)) < 0)
             goto fail;
-        if (initFilter(&c->vChrFilter, &c->vChrFilterPos, &c->vChrFilterSize,
-                       c->chrYInc, c->chrSrcH, c->chrDstH,
-                       filterAlign, (1 << 12),
-                       (flags & SWS_BICUBLIN) ? (flags | SWS_BILINEAR) : flags,
-                       cpu_flags, srcFilter->chrV, dstFilter->chrV,
-                       c->param,
-                       get_local_pos(c, c->chrSrcVSubSample, c->src_v_chr_pos, 1),
-                       get_local_pos(c, c->chrDstVSubSample, c->dst_v_chr_pos, 1)) < 0)
+        if (get_filter_plan(&c->vChrPlan, &c->vChrFilter, &c->vChrFilterPos,
+                            &c->vChrFilterSize, c->chrYInc, c->chrSrcH, c->chrDstH,
+                            filterAlign, (1 << 12),
+                            (flags & SWS_BICUBLIN) ? (flags | SWS_BILINEAR) : flags,
+                            cpu_flags, srcFilter->chrV, dstFilter->chrV,
+                            c->param,
+                            get_local_pos(c, c->chrSrcVSubSample, c->src_v_chr_pos, 1),
+                            get_local_pos(c, c->chrDstVSubSample, c->dst_v_chr_pos, 1)) < 0)
 
             goto fail;
 
@@ -1626,6 +2030,22 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
     }
 
     c->swscale = ff_getSwsFunc(c);
+
+    /* fused converters only exist for the default filters */
+    if (!srcFilter->lumH && !srcFilter->lumV && !srcFilter->chrH && !srcFilter->chrV &&
+        !dstFilter->lumH && !dstFilter->lumV && !dstFilter->chrH && !dstFilter->chrV)
+        ff_get_fused_swscale(c);
+    if (c->swscale_generic) {
+        if (flags & SWS_PRINT_INFO)
+            av_log(c, AV_LOG_INFO, "using fused %s -> %s converter\n",
+                   av_get_pix_fmt_name(srcFormat), av_get_pix_fmt_name(dstFormat));
+        return 0;
+    }
+
+    if (HAVE_THREADS && c->nb_threads != 1 &&
+        ff_sws_thread_init(c, srcFilter, dstFilter) < 0)
+        goto fail;
+
     return 0;
 fail: // FIXME replace things by appropriate error codes
     return -1;
@@ -1983,6 +2403,9 @@ void sws_freeContext(SwsContext *c)
     if (!c)
         return;
 
+    if (HAVE_THREADS)
+        ff_sws_thread_free(c);
+
     if (c->lumPixBuf) {
         for (i = 0; i < c->vLumBufSize; i++)
             av_freep(&c->lumPixBuf[i]);
@@ -2005,41 +2428,30 @@ void sws_freeContext(SwsContext *c)
     for (i = 0; i < 4; i++)
         av_freep(&c->dither_error[i]);
 
-    av_freep(&c->vLumFilter);
-    av_freep(&c->vChrFilter);
-    av_freep(&c->hLumFilter);
-    av_freep(&c->hChrFilter);
+    plan_unref(&c->vLumPlan);
+    plan_unref(&c->vChrPlan);
+    plan_unref(&c->hLumPlan);
+    plan_unref(&c->hChrPlan);
+    c->vLumFilter    = c->vChrFilter    = c->hLumFilter    = c->hChrFilter    = NULL;
+    c->vLumFilterPos = c->vChrFilterPos = c->hLumFilterPos = c->hChrFilterPos = NULL;
 #if HAVE_ALTIVEC
     av_freep(&c->vYCoeffsBank);
     av_freep(&c->vCCoeffsBank);
 #endif
 
-    av_freep(&c->vLumFilterPos);
-    av_freep(&c->vChrFilterPos);
-    av_freep(&c->hLumFilterPos);
-    av_freep(&c->hChrFilterPos);
-
 #if HAVE_MMX_INLINE
-#if USE_MMAP
-    if (c->lumMmxextFilterCode)
-        munmap(c->lumMmxextFilterCode, c->lumMmxextFilterCodeSize);
-    if (c->chrMmxextFilterCode)
-        munmap(c->chrMmxextFilterCode, c->chrMmxextFilterCodeSize);
-#elif HAVE_VIRTUALALLOC
-    if (c->lumMmxextFilterCode)
-        VirtualFree(c->lumMmxextFilterCode, 0, MEM_RELEASE);
-    if (c->chrMmxextFilterCode)
-        VirtualFree(c->chrMmxextFilterCode, 0, MEM_RELEASE);
-#else
-    av_free(c->lumMmxextFilterCode);
-    av_free(c->chrMmxextFilterCode);
-#endif
     c->lumMmxextFilterCode = NULL;
     c->chrMmxextFilterCode = NULL;
 #endif /* HAVE_MMX_INLINE */
 
     av_freep(&c->yuvTable);
     av_freep(&c->formatConvBuffer);
+    av_freep(&c->gammaConvBuffer);
+    av_freep(&c->gammaOutBuffer);
+    av_freep(&c->gamma_lin);
+    av_freep(&c->gamma_enc);
+    av_freep(&c->gamma_lin8);
+    av_freep(&c->gamma_enc8);
 
     av_free(c);
 }
@@ -2061,10 +2473,10 @@ struct SwsContext *sws_getCachedContext(struct SwsContext *context, int srcW,
     if (context &&
         (context->srcW      != srcW      ||
          context->srcH      != srcH      ||
-         context->srcFormat != srcFormat ||
+         userSrcFormat(context) != srcFormat ||
          context->dstW      != dstW      ||
          context->dstH      != dstH      ||
-         context->dstFormat != dstFormat ||
+         userDstFormat(context) != dstFormat ||
          context->flags     != flags     ||
          context->param[0]  != param[0]  ||
          context->param[1]  != param[1])) {
@@ -0,0 +1,97 @@
+;******************************************************************************
+;* x86-optimized gamma table lookups for SWS_GAMMA_CORRECT
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA 32
+
+gamma_alpha_mask: dd -1, -1, -1, 0, -1, -1, -1, 0
+gamma_mask16:     times 8 dd 0xffff
+gamma_mask8:      times 8 dd 0xff
+
+SECTION .text
+
+;-----------------------------------------------------------------------------
+; void ff_gamma_lut_<opt>     (uint16_t *dst, const uint16_t *src,
+;                              const uint16_t *table, int n, int alpha);
+; void ff_gamma_lut8to16_<opt>(uint16_t *dst, const uint8_t  *src,
+;                              const uint16_t *table, int n, int alpha);
+; void ff_gamma_lut16to8_<opt>(uint8_t  *dst, const uint16_t *src,
+;                              const uint8_t  *table, int n, int alpha);
+;
+; Map n components through table, 8 per iteration; n must be a multiple of 8.
+; If alpha is set, every fourth component is alpha: its gather lanes are
+; masked off and keep the component converted to the output depth. The
+; gathers load 32 bits per entry, so table must be readable 2 (16 bit
+; entries) or 3 (8 bit entries) bytes past its end.
+;-----------------------------------------------------------------------------
+
+; GAMMA_LUT name, dst_bytes, src_bytes
+%macro GAMMA_LUT 3
+cglobal gamma_%1, 5, 5, 5, dst, src, table, n, alpha
+    movsxdifnidn      nq, nd
+    pcmpeqd           m3, m3
+    test          alphad, alphad
+    jz .noalpha
+    mova              m3, [gamma_alpha_mask]
+.noalpha:
+%if %2 == 2
+    mova              m4, [gamma_mask16]
+%else
+    mova              m4, [gamma_mask8]
+%endif
+    lea             srcq, [srcq+nq*%3]
+    lea             dstq, [dstq+nq*%2]
+    neg               nq
+.loop:
+%if %3 == 1
+    pmovzxbd          m0, [srcq+nq]
+    pslld             m1, m0, 8
+    por               m1, m0                    ; alpha * 257
+%else
+    pmovzxwd          m0, [srcq+nq*2]
+%if %2 == 1
+    psrld             m1, m0, 8                 ; alpha >> 8
+%else
+    mova              m1, m0
+%endif
+%endif
+    mova              m2, m3
+    vpgatherdd        m1, [tableq+m0*%2], m2
+    pand              m1, m4
+    vextracti128     xm2, m1, 1
+    packusdw         xm1, xm2
+%if %2 == 1
+    packuswb         xm1, xm1
+    movq      [dstq+nq], xm1
+%else
+    movu    [dstq+nq*2], xm1
+%endif
+    add               nq, 8
+    jl .loop
+    RET
+%endmacro
+
+%if HAVE_AVX2_EXTERNAL && ARCH_X86_64
+INIT_YMM avx2
+GAMMA_LUT lut,      2, 2
+GAMMA_LUT lut8to16, 2, 1
+GAMMA_LUT lut16to8, 1, 2
+%endif
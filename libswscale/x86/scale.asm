@@ -21,12 +21,12 @@
 
 %include "libavutil/x86/x86util.asm"
 
-SECTION_RODATA
+SECTION_RODATA 32
 
-max_19bit_int: times 4 dd 0x7ffff
+max_19bit_int: times 8 dd 0x7ffff
+minshort:      times 16 dw 0x8000
+unicoeff:      times 8 dd 0x20000000
 max_19bit_flt: times 4 dd 524287.0
-minshort:      times 8 dw 0x8000
-unicoeff:      times 4 dd 0x20000000
 
 SECTION .text
 
@@ -429,3 +429,227 @@ INIT_XMM ssse3
 SCALE_FUNCS2 6, 6, 8
 INIT_XMM sse4
 SCALE_FUNCS2 6, 6, 8
+
+%if HAVE_AVX2_EXTERNAL && ARCH_X86_64
+; SCALE_FUNC_AVX2 source_width, intermediate_nbits, filtersize
+;
+; Same as SCALE_FUNC, but producing 8 output pixels per iteration for the
+; fixed filter sizes (2 per iteration for the generic version, which requires
+; filterSize to be a multiple of 8). initFilter() pads filterPos[] and
+; filter[] by 7 entries so that reading beyond dstW is safe.
+%macro SCALE_FUNC_AVX2 3
+%ifnidn %3, X8
+cglobal hscale%1to%2_%3, 6, 7, 8, pos0, dst, w, src, filter, fltpos, pos1
+%else
+cglobal hscale%1to%2_%3, 7, 10, 8, pos0, dst, w, srcmem, filter, fltpos, fltsize
+%endif
+    movsxd        wq, wd
+%if %2 == 19
+    mova          m2, [max_19bit_int]
+%endif ; %2 == 19
+%if %1 == 16
+    mova          m6, [minshort]
+    mova          m7, [unicoeff]
+%endif ; %1 == 16
+
+%if %1 == 8
+%define srcmul 1
+%else ; %1 == 9-16
+%define srcmul 2
+%endif ; %1 == 8/9-16
+
+%ifnidn %3, X8
+
+    ; setup loop
+%if %3 == 8
+    shl           wq, 1                         ; see SCALE_FUNC
+%define wshr 1
+%else ; %3 == 4
+%define wshr 0
+%endif ; %3 == 8
+    lea      filterq, [filterq+wq*8]
+%if %2 == 15
+    lea         dstq, [dstq+wq*(2>>wshr)]
+%else ; %2 == 19
+    lea         dstq, [dstq+wq*(4>>wshr)]
+%endif ; %2 == 15/19
+    lea      fltposq, [fltposq+wq*(4>>wshr)]
+    neg           wq
+
+.loop:
+%if %3 == 4 ; filterSize == 4 scaling
+    ; m0 = src[filterPos[0,1 | 4,5] + {0,1,2,3}]
+    ; m1 = src[filterPos[2,3 | 6,7] + {0,1,2,3}]
+%assign %%i 0
+%rep 2
+%if %1 == 8
+    movsxd     pos0q, dword [fltposq+wq*4+ 0+%%i*8]
+    movsxd     pos1q, dword [fltposq+wq*4+ 4+%%i*8]
+    movd     xm %+ %%i, [srcq+pos0q]
+    pinsrd   xm %+ %%i, [srcq+pos1q], 1
+    movsxd     pos0q, dword [fltposq+wq*4+16+%%i*8]
+    movsxd     pos1q, dword [fltposq+wq*4+20+%%i*8]
+    pinsrd   xm %+ %%i, [srcq+pos0q], 2
+    pinsrd   xm %+ %%i, [srcq+pos1q], 3
+    pmovzxbw      m %+ %%i, xm %+ %%i
+%else ; %1 > 8
+    movsxd     pos0q, dword [fltposq+wq*4+ 0+%%i*8]
+    movsxd     pos1q, dword [fltposq+wq*4+ 4+%%i*8]
+    movq     xm %+ %%i, [srcq+pos0q*2]
+    movhps   xm %+ %%i, [srcq+pos1q*2]
+    movsxd     pos0q, dword [fltposq+wq*4+16+%%i*8]
+    movsxd     pos1q, dword [fltposq+wq*4+20+%%i*8]
+    movq          xm4, [srcq+pos0q*2]
+    movhps        xm4, [srcq+pos1q*2]
+    vinserti128   m %+ %%i, m %+ %%i, xm4, 1
+%endif ; %1 == 8/9-16
+%assign %%i %%i+1
+%endrep
+
+%if %1 == 16 ; see SCALE_FUNC
+    psubw         m0, m6
+    psubw         m1, m6
+%endif ; %1 == 16
+
+    ; multiply, the filter coefficients of pixels 4-7 go into the high lane
+    movu          xm4, [filterq+wq*8+ 0]
+    vinserti128   m4, m4, [filterq+wq*8+32], 1
+    movu          xm5, [filterq+wq*8+16]
+    vinserti128   m5, m5, [filterq+wq*8+48], 1
+    pmaddwd       m0, m4
+    pmaddwd       m1, m5
+
+    ; add up horizontally (4 srcpix * 4 coefficients -> 1 dstpix)
+    phaddd        m0, m1
+%else ; %3 == 8, i.e. filterSize == 8 scaling
+    ; m0/m1/m4/m5 = src[filterPos[0|4]/[1|5]/[2|6]/[3|7] + {0,1,2,3,4,5,6,7}]
+%assign %%i 0
+%rep 4
+%assign %%r %%i + (%%i / 2) * 2                 ; m0, m1, m4, m5
+    movsxd     pos0q, dword [fltposq+wq*2+ 0+%%i*4]
+    movsxd     pos1q, dword [fltposq+wq*2+16+%%i*4]
+%if %1 == 8
+    movq     xm %+ %%r, [srcq+pos0q]
+    movhps   xm %+ %%r, [srcq+pos1q]
+    pmovzxbw      m %+ %%r, xm %+ %%r
+%else ; %1 > 8
+    movu     xm %+ %%r, [srcq+pos0q*2]
+    vinserti128   m %+ %%r, m %+ %%r, [srcq+pos1q*2], 1
+%endif ; %1 == 8/9-16
+%if %1 == 16 ; see SCALE_FUNC
+    psubw         m %+ %%r, m6
+%endif ; %1 == 16
+    movu          xm3, [filterq+wq*8+ 0+%%i*16]
+    vinserti128   m3, m3, [filterq+wq*8+64+%%i*16], 1
+    pmaddwd       m %+ %%r, m3
+%assign %%i %%i+1
+%endrep
+
+    ; add up horizontally (8 srcpix * 8 coefficients -> 1 dstpix)
+    phaddd        m0, m1
+    phaddd        m4, m5
+    phaddd        m0, m4
+%endif ; %3 == 4/8
+
+%else ; %3 == X8, i.e. any filterSize scaling
+
+%define srcq    r8
+%define pos1q   r7
+%define srcendq r9
+    movsxd  fltsizeq, fltsized                  ; filterSize
+    lea      srcendq, [srcmemq+fltsizeq*srcmul] ; &src[filterSize]
+    lea      fltposq, [fltposq+wq*4]
+%if %2 == 15
+    lea         dstq, [dstq+wq*2]
+%else ; %2 == 19
+    lea         dstq, [dstq+wq*4]
+%endif ; %2 == 15/19
+    neg           wq
+
+.loop:
+    movsxd     pos0q, dword [fltposq+wq*4+0]    ; filterPos[0]
+    movsxd     pos1q, dword [fltposq+wq*4+4]    ; filterPos[1]
+    pxor          m4, m4
+    mov         srcq, srcmemq
+
+.innerloop:
+    ; m0 = src[filterPos[0|1] + {0,1,2,3,4,5,6,7}]
+%if %1 == 8
+    movq          xm0, [srcq+pos0q]
+    movhps        xm0, [srcq+pos1q]
+    pmovzxbw      m0, xm0
+%else ; %1 > 8
+    movu          xm0, [srcq+pos0q*2]
+    vinserti128   m0, m0, [srcq+pos1q*2], 1
+%endif ; %1 == 8/9-16
+%if %1 == 16 ; see SCALE_FUNC
+    psubw         m0, m6
+%endif ; %1 == 16
+    movu          xm1, [filterq]
+    vinserti128   m1, m1, [filterq+fltsizeq*2], 1
+    pmaddwd       m0, m1
+    paddd         m4, m0
+    add      filterq, 16
+    add         srcq, srcmul*8
+    cmp         srcq, srcendq                   ; while (src += 8) < &src[filterSize]
+    jl .innerloop
+
+    lea      filterq, [filterq+fltsizeq*2]
+
+    vextracti128  xm0, m4, 1
+    phaddd        xm4, xm0
+    phaddd        xm4, xm4
+    SWAP           0, 4
+%endif ; %3 ==/!= X8
+
+%if %1 == 16 ; add 0x8000 * sum(coeffs), i.e. back from signed -> unsigned
+    paddd         m0, m7
+%endif ; %1 == 16
+
+    ; clip, store
+    psrad         m0, 14 + %1 - %2
+%ifnidn %3, X8
+%if %2 == 15
+    vextracti128  xm1, m0, 1
+    packssdw      xm0, xm1
+    movu [dstq+wq*(2>>wshr)], xm0
+%else ; %2 == 19
+    pminsd        m0, m2
+    movu [dstq+wq*(4>>wshr)], m0
+%endif ; %2 == 15/19
+    add           wq, 8<<wshr
+%else ; %3 == X8
+%if %2 == 15
+    packssdw      xm0, xm0
+    movd [dstq+wq*2], xm0
+%else ; %2 == 19
+    pminsd        xm0, xm2
+    movq [dstq+wq*4], xm0
+%endif ; %2 == 15/19
+    add           wq, 2
+%endif ; %3 ==/!= X8
+    jl .loop
+    RET
+%endmacro
+
+; SCALE_FUNCS_AVX2 source_width, intermediate_nbits
+%macro SCALE_FUNCS_AVX2 2
+SCALE_FUNC_AVX2 %1, %2, 4
+SCALE_FUNC_AVX2 %1, %2, 8
+SCALE_FUNC_AVX2 %1, %2, X8
+%endmacro
+
+INIT_YMM avx2
+SCALE_FUNCS_AVX2  8, 15
+SCALE_FUNCS_AVX2  9, 15
+SCALE_FUNCS_AVX2 10, 15
+SCALE_FUNCS_AVX2 12, 15
+SCALE_FUNCS_AVX2 14, 15
+SCALE_FUNCS_AVX2 16, 15
+SCALE_FUNCS_AVX2  8, 19
+SCALE_FUNCS_AVX2  9, 19
+SCALE_FUNCS_AVX2 10, 19
+SCALE_FUNCS_AVX2 12, 19
+SCALE_FUNCS_AVX2 14, 19
+SCALE_FUNCS_AVX2 16, 19
+%endif ; HAVE_AVX2_EXTERNAL && ARCH_X86_64
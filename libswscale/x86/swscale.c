@@ -311,6 +311,9 @@ SCALE_FUNCS_MMX(mmx);
 SCALE_FUNCS_SSE(sse2);
 SCALE_FUNCS_SSE(ssse3);
 SCALE_FUNCS_SSE(sse4);
+SCALE_FUNCS(4, avx2);
+SCALE_FUNCS(8, avx2);
+SCALE_FUNCS(X8, avx2);
 
 #define VSCALEX_FUNC(size, opt) \
 void ff_yuv2planeX_ ## size ## _ ## opt(const int16_t *filter, int filterSize, \
@@ -328,6 +331,8 @@ VSCALEX_FUNCS(sse2);
 VSCALEX_FUNCS(sse4);
 VSCALEX_FUNC(16, sse4);
 VSCALEX_FUNCS(avx);
+VSCALEX_FUNCS(avx2);
+VSCALEX_FUNC(16, avx2);
 
 #define VSCALE_FUNC(size, opt) \
 void ff_yuv2plane1_ ## size ## _ ## opt(const int16_t *src, uint8_t *dst, int dstW, \
@@ -344,6 +349,7 @@ VSCALE_FUNCS(mmx, mmxext);
 VSCALE_FUNCS(sse2, sse2);
 VSCALE_FUNC(16, sse4);
 VSCALE_FUNCS(avx, avx);
+VSCALE_FUNCS(avx2, avx2);
 
 #define INPUT_Y_FUNC(fmt, opt) \
 void ff_ ## fmt ## ToY_  ## opt(uint8_t *dst, const uint8_t *src, \
@@ -377,6 +383,23 @@ INPUT_FUNCS(sse2);
 INPUT_FUNCS(ssse3);
 INPUT_FUNCS(avx);
 
+#define GAMMA_FUNC(name, dst_type, src_type, table_type, opt) \
+void ff_gamma_ ## name ## _ ## opt(dst_type *dst, const src_type *src, \
+                                   const table_type *table, int n, int alpha); \
+static void gamma_ ## name ## _ ## opt(dst_type *dst, const src_type *src, \
+                                       const table_type *table, int n, int alpha) \
+{ \
+    int n8 = n & ~7; \
+ \
+    if (n8) \
+        ff_gamma_ ## name ## _ ## opt(dst, src, table, n8, alpha); \
+    ff_gamma_ ## name ## _c(dst + n8, src + n8, table, n - n8, alpha); \
+}
+
+GAMMA_FUNC(lut,      uint16_t, uint16_t, uint16_t, avx2)
+GAMMA_FUNC(lut8to16, uint16_t, uint8_t,  uint16_t, avx2)
+GAMMA_FUNC(lut16to8, uint8_t,  uint16_t, uint8_t,  avx2)
+
 av_cold void ff_sws_init_swscale_x86(SwsContext *c)
 {
     int cpu_flags = av_get_cpu_flags();
@@ -577,4 +600,29 @@ switch(c->dstBpc){ \
             break;
         }
     }
+
+#define ASSIGN_AVX2_SCALE_FUNC(hscalefn, filtersize) \
+    switch (filtersize) { \
+    case 4:  ASSIGN_SCALE_FUNC2(hscalefn, 4, avx2, avx2); break; \
+    case 8:  ASSIGN_SCALE_FUNC2(hscalefn, 8, avx2, avx2); break; \
+    default: if (!(filtersize & 7)) ASSIGN_SCALE_FUNC2(hscalefn, X8, avx2, avx2); \
+             break; \
+    }
+    if (ARCH_X86_64 && EXTERNAL_AVX2(cpu_flags)) {
+        ASSIGN_AVX2_SCALE_FUNC(c->hyScale, c->hLumFilterSize);
+        ASSIGN_AVX2_SCALE_FUNC(c->hcScale, c->hChrFilterSize);
+        ASSIGN_VSCALEX_FUNC(c->yuv2planeX, avx2,
+                            if (!isBE(c->dstFormat)) c->yuv2planeX = ff_yuv2planeX_16_avx2,
+                            1);
+        if (c->dstBpc == 8) {
+            /* bitexact, so it also replaces the approximate inline MMX
+             * vertical scaler and its premultiplied filter layout */
+            c->yuv2planeX      = ff_yuv2planeX_8_avx2;
+            c->use_mmx_vfilter = 0;
+        }
+        ASSIGN_VSCALE_FUNC(c->yuv2plane1, avx2, avx2, 1);
+        c->gamma_lut      = gamma_lut_avx2;
+        c->gamma_lut8to16 = gamma_lut8to16_avx2;
+        c->gamma_lut16to8 = gamma_lut16to8_avx2;
+    }
 }
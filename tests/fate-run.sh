@@ -172,6 +172,20 @@ video_filter(){
         $FLAGS $ENC_OPTS -vf "$filters" -vcodec rawvideo $* -f nut md5:
 }
 
+# filter a stream whose frame size changes every 5 frames
+resize_filter(){
+    filters=$1
+    raw_src="${target_path}/tests/vsynth1/%02d.pgm"
+    pipe_src="${outdir}/${test}.pgm"
+    cleanfiles="$cleanfiles $pipe_src"
+    : >$pipe_src
+    for size in 352x288 176x144 320x240; do
+        ffmpeg $DEC_OPTS -f image2 -vcodec pgmyuv -i $raw_src $FLAGS $ENC_OPTS \
+            -vframes 5 -s $size -vcodec pgmyuv -f image2pipe - >>$pipe_src || return
+    done
+    framecrc -f image2pipe -vcodec pgmyuv -i $(target_path $pipe_src) -vf "$filters"
+}
+
 pixdesc(){
     pix_fmts="$(ffmpeg -pix_fmts list 2>/dev/null | awk 'NR > 8 && /^IO/ { print $2 }' | sort)"
     for pix_fmt in $pix_fmts; do
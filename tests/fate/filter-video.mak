@@ -86,6 +86,12 @@ fate-filter-overlay_yuv422: CMD = framecrc -c:v pgmyuv -i $(SRC) -filter_complex
 FATE_FILTER_VSYNTH-$(call ALLYES, SPLIT_FILTER SCALE_FILTER PAD_FILTER OVERLAY_FILTER) += fate-filter-overlay_yuv444
 fate-filter-overlay_yuv444: CMD = framecrc -c:v pgmyuv -i $(SRC) -filter_complex_script $(SRC_PATH)/tests/filtergraphs/overlay_yuv444
 
+FATE_FILTER_VSYNTH-$(call ALLYES, SPLIT_FILTER SCALE_FILTER FORMAT_FILTER ALPHAMERGE_FILTER PAD_FILTER LUTYUV_FILTER OVERLAY_FILTER) += fate-filter-overlay_yuva420
+fate-filter-overlay_yuva420: CMD = framecrc -c:v pgmyuv -i $(SRC) -filter_complex_script $(SRC_PATH)/tests/filtergraphs/overlay_yuva420
+
+FATE_FILTER_VSYNTH-$(call ALLYES, SPLIT_FILTER SCALE_FILTER FORMAT_FILTER ALPHAMERGE_FILTER OVERLAY_FILTER) += fate-filter-overlay_rgb24
+fate-filter-overlay_rgb24: CMD = framecrc -c:v pgmyuv -i $(SRC) -filter_complex_script $(SRC_PATH)/tests/filtergraphs/overlay_rgb24
+
 FATE_FILTER_VSYNTH-$(CONFIG_PHASE_FILTER) += fate-filter-phase
 fate-filter-phase: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf phase
 
@@ -135,6 +141,9 @@ fate-filter-gradfun-sample: CMD = framecrc -i $(TARGET_SAMPLES)/vmd/12.vmd -filt
 FATE_FILTER-$(call ALLYES, TESTSRC_FILTER SINE_FILTER CONCAT_FILTER) += fate-filter-concat
 fate-filter-concat: CMD = framecrc -filter_complex_script $(SRC_PATH)/tests/filtergraphs/concat
 
+FATE_FILTER-$(call ALLYES, TESTSRC_FILTER COLOR_FILTER SPLIT_FILTER HFLIP_FILTER VFLIP_FILTER NEGATE_FILTER FORMAT_FILTER OVERLAY_FILTER SCALE_FILTER) += fate-filter-mosaic
+fate-filter-mosaic: CMD = framecrc -filter_complex_script $(SRC_PATH)/tests/filtergraphs/mosaic
+
 FATE_FILTER_VSYNTH-$(call ALLYES, FORMAT_FILTER SPLIT_FILTER ALPHAEXTRACT_FILTER ALPHAMERGE_FILTER) += fate-filter-alphaextract_alphamerge_rgb
 fate-filter-alphaextract_alphamerge_rgb: CMD = framecrc -c:v pgmyuv -i $(SRC) -filter_complex_script $(SRC_PATH)/tests/filtergraphs/alphamerge_alphaextract_rgb
 
@@ -162,6 +171,26 @@ fate-filter-scale200: CMD = video_filter "scale=w=200:h=200"
 FATE_FILTER_VSYNTH-$(CONFIG_SCALE_FILTER) += fate-filter-scale500
 fate-filter-scale500: CMD = video_filter "scale=w=500:h=500"
 
+FATE_FILTER_VSYNTH-$(call ALLYES, SCALE_FILTER FORMAT_FILTER) += fate-filter-scale-gamma
+fate-filter-scale-gamma: CMD = video_filter "scale=w=200:h=200:flags=bicubic+gamma_correct,format=rgb24"
+
+FATE_FILTER_VSYNTH-$(call ALLYES, SCALE_FILTER FORMAT_FILTER) += fate-filter-scale-gamma-rgba
+fate-filter-scale-gamma-rgba: CMD = video_filter "format=rgb24,scale=w=200:h=200:flags=bicubic+gamma_correct,format=rgba"
+
+FATE_FILTER_VSYNTH-$(call ALLYES, SCALE_FILTER IMAGE2PIPE_MUXER IMAGE2PIPE_DEMUXER) += fate-filter-scale-resize
+fate-filter-scale-resize: CMD = resize_filter "scale=w=200:h=200"
+
+FATE_FILTER_VSYNTH-$(call ALLYES, YADIF_FILTER IMAGE2PIPE_MUXER IMAGE2PIPE_DEMUXER) += fate-filter-yadif-resize
+fate-filter-yadif-resize: CMD = resize_filter "yadif"
+
+# trim and fps keep their state when relinked, a rebuilt graph would
+# restart counting frames and timestamps at every size change
+FATE_FILTER_VSYNTH-$(call ALLYES, TRIM_FILTER SCALE_FILTER IMAGE2PIPE_MUXER IMAGE2PIPE_DEMUXER) += fate-filter-trim-resize
+fate-filter-trim-resize: CMD = resize_filter "trim=end_frame=12,scale=w=200:h=200"
+
+FATE_FILTER_VSYNTH-$(call ALLYES, FPS_FILTER SCALE_FILTER IMAGE2PIPE_MUXER IMAGE2PIPE_DEMUXER) += fate-filter-fps-resize
+fate-filter-fps-resize: CMD = resize_filter "fps=50,scale=w=200:h=200"
+
 FATE_FILTER_VSYNTH-$(CONFIG_VFLIP_FILTER) += fate-filter-vflip
 fate-filter-vflip: CMD = video_filter "vflip"
 